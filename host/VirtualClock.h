@@ -0,0 +1,16 @@
+#pragma once
+
+#include <atomic>
+#include <cstdint>
+
+// Settable time source for DeviceTracker::setClock(). Host tools advance it
+// to the stream or simulation time before each ingest(), so the tracker's
+// segmentation, expiry and scoring see that time rather than the wall clock.
+class VirtualClock {
+public:
+  static int64_t Now() { return _us.load(std::memory_order_relaxed); }
+  static void SetSeconds(uint32_t s) { _us.store((int64_t)s * 1000000, std::memory_order_relaxed); }
+
+private:
+  static inline std::atomic<int64_t> _us{0};
+};
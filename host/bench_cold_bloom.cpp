@@ -0,0 +1,55 @@
+// Host benchmark: cold-tier Bloom filter false-positive rate and probe cost.
+//
+// Fills the filter the tracker uses (64K bits, K = 3) with random track keys
+// and measures how often never-seen keys still read as "maybe", i.e. how
+// many flash lookups a re-sighting of a fresh MAC wastes. ColdStore itself
+// needs a filesystem and is exercised on the device.
+//
+//   g++ -O2 -std=gnu++2a -I../src bench_cold_bloom.cpp -o bench_cold_bloom
+//   ./bench_cold_bloom
+
+#include "BloomFilter.h"
+#include "MacIndex.h"
+
+#include <chrono>
+#include <cstdio>
+#include <random>
+#include <vector>
+
+static uint64_t random_key(std::mt19937_64& rng) {
+  uint8_t addr[6];
+  const uint64_t r = rng();
+  for (int i = 0; i < 6; ++i) addr[i] = (uint8_t)(r >> (8 * i));
+  return MacIndex::MakeKey(1 + (uint8_t)(r >> 48) % 3, addr);
+}
+
+int main() {
+  static BloomFilter<64 * 1024> bloom;
+  std::mt19937_64 rng(1234);
+  constexpr int PROBES = 1 << 20;
+
+  std::vector<uint64_t> misses(PROBES);
+  for (auto& k : misses) k = random_key(rng);
+
+  for (int n : {1024, 4096, 8192, 16384, 32768}) {
+    bloom.Clear();
+    std::vector<uint64_t> keys(n);
+    for (auto& k : keys) {
+      k = random_key(rng);
+      bloom.Add(k);
+    }
+
+    int lost = 0;
+    for (uint64_t k : keys) lost += !bloom.MayContain(k);
+
+    auto t0 = std::chrono::steady_clock::now();
+    int fp = 0;
+    for (uint64_t k : misses) fp += bloom.MayContain(k);
+    auto t1 = std::chrono::steady_clock::now();
+
+    printf("%6d keys  false positives %6.2f%%  false negatives %d  %5.1f ns/probe\n",
+           n, 100.0 * fp / PROBES, lost,
+           std::chrono::duration<double, std::nano>(t1 - t0).count() / PROBES);
+  }
+  return 0;
+}
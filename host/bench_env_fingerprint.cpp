@@ -0,0 +1,159 @@
+// Host check: environment fingerprint stability, old top-8 vs. MinHash.
+//
+// Simulates a dense street: each location has 150 APs with a mean RSSI
+// between -92 and -45 dBm; every scan hears each AP with a probability that
+// falls with distance and adds +/-6 dB of fading. Two error rates matter for
+// segmentation (threshold 0.5, as in DeviceTracker):
+//   false move  - two scans at the same spot look like different places
+//   missed move - a scan after walking on (20% of APs shared) looks the same
+// "top8" is the previous build_fingerprint/fp_similarity; the others are the
+// bottom-k sketches at several widths. Also times one comparison.
+//
+//   g++ -O2 -std=gnu++2a -I../src bench_env_fingerprint.cpp -o bench_env_fingerprint
+//   ./bench_env_fingerprint
+
+#include "BottomK.h"
+
+#include <algorithm>
+#include <chrono>
+#include <cmath>
+#include <cstdio>
+#include <cstring>
+#include <random>
+#include <vector>
+
+struct Ap { uint8_t addr[6]; float mean; };
+struct Heard { uint8_t addr[6]; int rssi; };
+
+static int rssi_bucket(int rssi) { return rssi >= -65 ? 2 : (rssi >= -80 ? 1 : 0); }
+
+static std::vector<Heard> scan(const std::vector<Ap>& aps, std::mt19937& rng) {
+  std::normal_distribution<float> fade(0.0f, 6.0f);
+  std::uniform_real_distribution<float> unit(0.0f, 1.0f);
+  std::vector<Heard> out;
+  for (const Ap& a : aps) {
+    const float p = 0.35f + 0.6f * std::min(1.0f, std::max(0.0f, (a.mean + 92.0f) / 40.0f));
+    if (unit(rng) > p) continue;
+    Heard h;
+    memcpy(h.addr, a.addr, 6);
+    h.rssi = (int)lroundf(a.mean + fade(rng));
+    out.push_back(h);
+  }
+  return out;
+}
+
+// ---- previous implementation: strongest 8, pairwise memcmp ----
+struct Top8 { Heard items[8]; int count = 0; };
+
+static Top8 top8(std::vector<Heard> heard) {
+  std::sort(heard.begin(), heard.end(), [](const Heard& a, const Heard& b) { return a.rssi > b.rssi; });
+  Top8 fp;
+  fp.count = std::min<int>(8, (int)heard.size());
+  for (int i = 0; i < fp.count; ++i) fp.items[i] = heard[i];
+  return fp;
+}
+
+static float top8_similarity(const Top8& a, const Top8& b) {
+  int uni = a.count, inter = 0;
+  float bonus = 0.0f;
+  for (int j = 0; j < b.count; ++j) {
+    bool found = false;
+    for (int i = 0; i < a.count; ++i) if (memcmp(a.items[i].addr, b.items[j].addr, 6) == 0) { found = true; break; }
+    if (!found) uni++;
+  }
+  if (uni == 0) return 1.0f;
+  for (int i = 0; i < a.count; ++i) {
+    for (int j = 0; j < b.count; ++j) {
+      if (memcmp(a.items[i].addr, b.items[j].addr, 6) != 0) continue;
+      inter++;
+      if (rssi_bucket(a.items[i].rssi) == rssi_bucket(b.items[j].rssi)) bonus += 0.25f;
+      break;
+    }
+  }
+  return std::min(1.0f, (float)inter / uni + bonus / uni);
+}
+
+// ---- MinHash, as in DeviceTracker ----
+struct Sketch { BottomK<64> aps, bands; };
+
+static uint32_t fp_hash(const uint8_t addr[6], uint32_t salt) {
+  uint64_t x = 0;
+  for (int i = 0; i < 6; ++i) x = (x << 8) | addr[i];
+  x ^= (uint64_t)salt << 48;
+  x ^= x >> 30; x *= 0xBF58476D1CE4E5B9ULL;
+  x ^= x >> 27; x *= 0x94D049BB133111EBULL;
+  x ^= x >> 31;
+  return (uint32_t)x;
+}
+
+static Sketch sketch(const std::vector<Heard>& heard, int k) {
+  Sketch s;
+  s.aps.Reset(k);
+  s.bands.Reset(k);
+  for (const Heard& h : heard) {
+    s.aps.Add(fp_hash(h.addr, 0));
+    s.bands.Add(fp_hash(h.addr, 1 + (uint32_t)rssi_bucket(h.rssi)));
+  }
+  return s;
+}
+
+static float sketch_similarity(const Sketch& a, const Sketch& b) {
+  return std::min(1.0f, BottomK<64>::Jaccard(a.aps, b.aps) + 0.25f * BottomK<64>::Jaccard(a.bands, b.bands));
+}
+
+static std::vector<Ap> location(std::mt19937& rng, const std::vector<Ap>* prev, float shared) {
+  std::uniform_real_distribution<float> mean(-92.0f, -45.0f);
+  std::vector<Ap> aps(150);
+  for (size_t i = 0; i < aps.size(); ++i) {
+    if (prev && i < (size_t)(shared * aps.size())) {
+      aps[i] = (*prev)[aps.size() - 1 - i];
+      aps[i].mean = mean(rng);
+    } else {
+      for (auto& b : aps[i].addr) b = (uint8_t)rng();
+      aps[i].mean = mean(rng);
+    }
+  }
+  return aps;
+}
+
+int main() {
+  std::mt19937 rng(1234);
+  constexpr int TRIALS = 2000;
+  constexpr float THRESHOLD = 0.5f;
+
+  int old_false = 0, old_missed = 0;
+  const int widths[] = {16, 32, 64};
+  int new_false[3] = {}, new_missed[3] = {};
+
+  for (int t = 0; t < TRIALS; ++t) {
+    const auto here = location(rng, nullptr, 0.0f);
+    const auto there = location(rng, &here, 0.2f);
+    const auto a = scan(here, rng), b = scan(here, rng), c = scan(there, rng);
+
+    old_false += top8_similarity(top8(a), top8(b)) < THRESHOLD;
+    old_missed += top8_similarity(top8(a), top8(c)) >= THRESHOLD;
+    for (int w = 0; w < 3; ++w) {
+      const Sketch sa = sketch(a, widths[w]);
+      new_false[w] += sketch_similarity(sa, sketch(b, widths[w])) < THRESHOLD;
+      new_missed[w] += sketch_similarity(sa, sketch(c, widths[w])) >= THRESHOLD;
+    }
+  }
+
+  printf("%-8s %11s %12s\n", "", "false move", "missed move");
+  printf("%-8s %10.1f%% %11.1f%%\n", "top8", 100.0 * old_false / TRIALS, 100.0 * old_missed / TRIALS);
+  for (int w = 0; w < 3; ++w) {
+    char name[16];
+    snprintf(name, sizeof(name), "k=%d", widths[w]);
+    printf("%-8s %10.1f%% %11.1f%%\n", name, 100.0 * new_false[w] / TRIALS, 100.0 * new_missed[w] / TRIALS);
+  }
+
+  const auto here = location(rng, nullptr, 0.0f);
+  const Sketch sa = sketch(scan(here, rng), 64), sb = sketch(scan(here, rng), 64);
+  constexpr int N = 1 << 18;
+  volatile float sink = 0.0f;
+  auto t0 = std::chrono::steady_clock::now();
+  for (int i = 0; i < N; ++i) sink = sink + sketch_similarity(sa, sb);
+  auto t1 = std::chrono::steady_clock::now();
+  printf("compare (k=64) %.0f ns\n", std::chrono::duration<double, std::nano>(t1 - t0).count() / N);
+  return 0;
+}
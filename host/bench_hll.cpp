@@ -0,0 +1,65 @@
+// Host check: HyperLogLog crowd estimate vs. the old per-frame counter.
+//
+// For each true crowd size, builds one 10 s window the way the radios see
+// it: every device sends a few frames, plus one chatty AP beaconing at
+// 10 Hz. Prints the old g_window_unique_hits value (frames), the sketch's
+// distinct estimate and its error over many trials, then times Add().
+//
+//   g++ -O2 -std=gnu++2a -I../src bench_hll.cpp -o bench_hll
+//   ./bench_hll
+
+#include "HyperLogLog.h"
+#include "MacIndex.h"
+
+#include <chrono>
+#include <cmath>
+#include <cstdio>
+#include <random>
+
+static uint64_t device_key(std::mt19937_64& rng, uint8_t kind) {
+  uint8_t addr[6];
+  const uint64_t r = rng();
+  for (int i = 0; i < 6; ++i) addr[i] = (uint8_t)(r >> (8 * i));
+  return MacIndex::MakeKey(kind, addr);
+}
+
+int main() {
+  std::mt19937_64 rng(1234);
+  constexpr int TRIALS = 200;
+
+  printf("%6s %10s %10s %9s %9s\n", "true", "frames", "estimate", "mean err", "max err");
+  for (int n : {1, 5, 10, 20, 40, 100, 400, 2000}) {
+    double sum_est = 0.0, sum_err = 0.0, max_err = 0.0;
+    uint64_t frames = 0;
+    for (int t = 0; t < TRIALS; ++t) {
+      HyperLogLog<8> hll;
+      const uint64_t chatty = device_key(rng, 2);
+      for (int f = 0; f < 100; ++f, ++frames) hll.Add(chatty);
+      for (int d = 1; d < n; ++d) {
+        const uint64_t key = device_key(rng, 1 + (uint8_t)(rng() % 4));
+        const int burst = 1 + (int)(rng() % 6);
+        for (int f = 0; f < burst; ++f, ++frames) hll.Add(key);
+      }
+      const double est = hll.Estimate();
+      const double err = std::fabs(est - n) / n;
+      sum_est += est;
+      sum_err += err;
+      if (err > max_err) max_err = err;
+    }
+    printf("%6d %10.0f %10.1f %8.1f%% %8.1f%%\n", n, (double)frames / TRIALS, sum_est / TRIALS,
+           100.0 * sum_err / TRIALS, 100.0 * max_err);
+  }
+
+  HyperLogLog<8> hll;
+  constexpr int ADDS = 1 << 22;
+  volatile uint32_t sink = 0;
+  auto t0 = std::chrono::steady_clock::now();
+  for (int i = 0; i < ADDS; ++i) hll.Add(0x0100000000000000ULL + (uint64_t)(i & 1023));
+  auto t1 = std::chrono::steady_clock::now();
+  for (int i = 0; i < 4096; ++i) sink = sink + hll.Estimate();
+  auto t2 = std::chrono::steady_clock::now();
+  printf("Add %.1f ns  Estimate %.0f ns\n",
+         std::chrono::duration<double, std::nano>(t1 - t0).count() / ADDS,
+         std::chrono::duration<double, std::nano>(t2 - t1).count() / 4096);
+  return 0;
+}
@@ -0,0 +1,179 @@
+// Host check: adaptive channel hopping (HopScheduler.h) vs. the fixed
+// 250 ms round robin.
+//
+// Simulates an hour in 10 ms steps of a sniffer walking through a town:
+//   APs      arrive at --ap-rate per minute and stay in range ~2 min,
+//            beaconing at 10 Hz; 85% sit on channels 1/6/11, the rest are
+//            spread over the others
+//   clients  arrive at --client-rate per minute and stay ~1 min, probing
+//            every ~45 s; 60% of bursts cover only 1/6/11 (30 ms each),
+//            the rest sweep all 11 channels (10 ms each)
+// A frame is heard if the hopper is on its channel (90% capture). Both
+// hoppers see the same world. Prints how many devices each found, how soon
+// after they came in range, and how the adaptive hopper shared its time.
+//
+//   g++ -O2 -std=gnu++2a -I../src bench_hop_scheduler.cpp -o bench_hop_scheduler
+//   ./bench_hop_scheduler [--ap-rate 8] [--client-rate 15] [--minutes 60] [--seed 1]
+
+#include "HopScheduler.h"
+
+#include <algorithm>
+#include <cmath>
+#include <cstdio>
+#include <cstdlib>
+#include <cstring>
+#include <random>
+#include <vector>
+
+static constexpr int CHANNELS = 11;
+static constexpr int TICK_MS = 10;
+
+struct Device {
+  bool ap;
+  int channel;          // AP only, 0-based
+  uint32_t born, dies;  // ticks
+  int phase;            // AP beacon phase
+  uint32_t next_burst;  // client
+  bool focused;         // client's current burst covers 1/6/11 only
+  uint32_t found = 0;   // tick first heard, 0 = not yet
+};
+
+struct Result {
+  int found = 0, total = 0;
+  double latency_s = 0.0;
+  uint32_t new_per_ch[CHANNELS] = {};
+  uint32_t dwell_ms[CHANNELS] = {};
+};
+
+static std::vector<Device> make_world(uint32_t ticks, double ap_rate, double client_rate, uint32_t seed) {
+  std::mt19937 rng(seed);
+  std::exponential_distribution<double> ap_gap(ap_rate / 60000.0 * TICK_MS), client_gap(client_rate / 60000.0 * TICK_MS);
+  std::exponential_distribution<double> ap_stay(1.0 / (120000.0 / TICK_MS)), client_stay(1.0 / (60000.0 / TICK_MS));
+  std::vector<Device> world;
+  for (double t = ap_gap(rng); t < ticks; t += ap_gap(rng)) {
+    Device d{};
+    d.ap = true;
+    const int r = (int)(rng() % 100);
+    static const int OTHERS[] = {1, 2, 3, 4, 6, 7, 8, 9};
+    d.channel = r < 30 ? 0 : r < 60 ? 5 : r < 85 ? 10 : OTHERS[rng() % 8];
+    d.born = (uint32_t)t;
+    d.dies = d.born + 1 + (uint32_t)ap_stay(rng);
+    d.phase = (int)(rng() % 10);
+    world.push_back(d);
+  }
+  for (double t = client_gap(rng); t < ticks; t += client_gap(rng)) {
+    Device d{};
+    d.born = (uint32_t)t;
+    d.dies = d.born + 1 + (uint32_t)client_stay(rng);
+    d.next_burst = d.born + (uint32_t)(rng() % 4500);
+    world.push_back(d);
+  }
+  return world;
+}
+
+// Channel a client's burst is on, k ticks in; -1 once it is over.
+static int burst_channel(bool focused, uint32_t k) {
+  if (focused) {
+    static const int FOCUS[3] = {0, 5, 10};
+    return k < 9 ? FOCUS[k / 3] : -1;
+  }
+  return k < (uint32_t)CHANNELS ? (int)k : -1;
+}
+
+static Result run(std::vector<Device> world, uint32_t ticks, bool adaptive, uint32_t seed) {
+  std::mt19937 rng(seed * 7919 + 1);
+  std::mt19937 burst_rng(seed * 104729 + 3); // same bursts for both hoppers
+  std::uniform_real_distribution<float> u(0.0f, 1.0f);
+  HopScheduler<CHANNELS> sched;
+  Result res;
+
+  uint32_t dwell[CHANNELS], spent[CHANNELS] = {}, frames[CHANNELS] = {}, fresh[CHANNELS] = {};
+  int ch = -1;
+  uint32_t left = 0;
+  auto next_round = [&] {
+    if (adaptive) sched.Plan(dwell);
+    else for (int i = 0; i < CHANNELS; ++i) dwell[i] = 250;
+  };
+  next_round();
+
+  for (uint32_t t = 0; t < ticks; ++t) {
+    if (left == 0) {
+      if (++ch == CHANNELS) {
+        sched.Update(fresh, frames, spent);
+        memset(spent, 0, sizeof(spent));
+        memset(frames, 0, sizeof(frames));
+        memset(fresh, 0, sizeof(fresh));
+        next_round();
+        ch = 0;
+      }
+      left = std::max<uint32_t>(1, dwell[ch] / TICK_MS);
+    }
+    left--;
+    spent[ch] += TICK_MS;
+    res.dwell_ms[ch] += TICK_MS;
+
+    for (Device& d : world) {
+      if (t < d.born || t >= d.dies) continue;
+      int on = -1;
+      if (d.ap) {
+        if ((t + (uint32_t)d.phase) % 10 == 0) on = d.channel;
+      } else {
+        if (t == d.next_burst) d.focused = burst_rng() % 100 < 60;
+        if (t >= d.next_burst) {
+          on = burst_channel(d.focused, t - d.next_burst);
+          if (on < 0) {
+            d.next_burst = t + 1 + (uint32_t)(std::exponential_distribution<double>(1.0 / 4500.0)(burst_rng));
+          }
+        }
+      }
+      if (on != ch || u(rng) > 0.9f) continue;
+      frames[ch]++;
+      if (!d.found) {
+        d.found = t;
+        fresh[ch]++;
+        res.new_per_ch[ch]++;
+      }
+    }
+  }
+
+  for (const Device& d : world) {
+    res.total++;
+    if (d.found) {
+      res.found++;
+      res.latency_s += (d.found - d.born) * TICK_MS / 1000.0;
+    }
+  }
+  if (res.found) res.latency_s /= res.found;
+  return res;
+}
+
+int main(int argc, char** argv) {
+  double ap_rate = 8.0, client_rate = 15.0;
+  int minutes = 60;
+  uint32_t seed = 1;
+  for (int i = 1; i + 1 < argc; i += 2) {
+    if (strcmp(argv[i], "--ap-rate") == 0) ap_rate = atof(argv[i + 1]);
+    else if (strcmp(argv[i], "--client-rate") == 0) client_rate = atof(argv[i + 1]);
+    else if (strcmp(argv[i], "--minutes") == 0) minutes = atoi(argv[i + 1]);
+    else if (strcmp(argv[i], "--seed") == 0) seed = (uint32_t)strtoul(argv[i + 1], nullptr, 10);
+  }
+
+  const uint32_t ticks = (uint32_t)minutes * 60000 / TICK_MS;
+  const std::vector<Device> world = make_world(ticks, ap_rate, client_rate, seed);
+
+  const Result fixed = run(world, ticks, false, seed);
+  const Result adapt = run(world, ticks, true, seed);
+
+  printf("%d devices in %d min (%.0f APs/min, %.0f clients/min)\n", fixed.total, minutes, ap_rate, client_rate);
+  printf("%-9s %7s %8s %12s\n", "hopper", "found", "share", "mean delay");
+  for (const auto& [name, r] : {std::pair{"fixed", &fixed}, std::pair{"adaptive", &adapt}}) {
+    printf("%-9s %7d %7.1f%% %10.1f s\n", name, r->found, 100.0 * r->found / std::max(1, r->total), r->latency_s);
+  }
+
+  printf("\nch   dwell fixed/adaptive   new fixed/adaptive\n");
+  for (int i = 0; i < CHANNELS; ++i) {
+    printf("%2d  %8.1f%% %8.1f%%   %8u %8u\n", i + 1, 100.0 * fixed.dwell_ms[i] / (ticks * TICK_MS),
+           100.0 * adapt.dwell_ms[i] / (ticks * TICK_MS), fixed.new_per_ch[i], adapt.new_per_ch[i]);
+  }
+  return 0;
+}
@@ -0,0 +1,86 @@
+// Host benchmark: (kind, MAC) lookup cost vs. table capacity.
+//
+// Compares the old linear memcmp scan over a slot array with MacIndex at a
+// fixed 50% load factor. The linear scan grows with capacity; the hash index
+// should stay flat.
+//
+//   g++ -O2 -std=gnu++2a -I../src bench_mac_index.cpp -o bench_mac_index
+//   ./bench_mac_index
+
+#include "MacIndex.h"
+
+#include <chrono>
+#include <cstdio>
+#include <cstring>
+#include <random>
+#include <vector>
+
+struct Slot {
+  bool    in_use = false;
+  uint8_t kind = 0;
+  uint8_t addr[6]{};
+};
+
+static constexpr int LOOKUPS = 1 << 20;
+
+template <int SLOTS>
+static void run(std::mt19937& rng) {
+  static Slot slots[SLOTS];
+  Arena arena;
+  arena.Reserve((size_t)SLOTS * 2 * (sizeof(uint64_t) + sizeof(uint16_t)), false);
+  MacIndex index;
+  index.Init(arena, SLOTS * 2);
+
+  for (int i = 0; i < SLOTS; ++i) {
+    slots[i].in_use = true;
+    slots[i].kind = 1 + (rng() % 2);
+    for (auto& b : slots[i].addr) b = (uint8_t)rng();
+    index.Insert(MacIndex::MakeKey(slots[i].kind, slots[i].addr), i);
+  }
+
+  // Half hits, half misses (fresh randomized MACs), like a busy venue.
+  std::vector<Slot> probes(4096);
+  for (size_t i = 0; i < probes.size(); ++i) {
+    if (i & 1) {
+      probes[i] = slots[rng() % SLOTS];
+    } else {
+      probes[i].kind = 1 + (rng() % 2);
+      for (auto& b : probes[i].addr) b = (uint8_t)rng();
+    }
+  }
+
+  using clock = std::chrono::steady_clock;
+  volatile int sink = 0;
+
+  auto t0 = clock::now();
+  for (int n = 0; n < LOOKUPS; ++n) {
+    const Slot& p = probes[n & 4095];
+    int found = -1;
+    for (int i = 0; i < SLOTS; ++i) {
+      if (slots[i].in_use && slots[i].kind == p.kind && memcmp(slots[i].addr, p.addr, 6) == 0) { found = i; break; }
+    }
+    sink = sink + found;
+  }
+  auto t1 = clock::now();
+  for (int n = 0; n < LOOKUPS; ++n) {
+    const Slot& p = probes[n & 4095];
+    sink = sink + index.Find(MacIndex::MakeKey(p.kind, p.addr));
+  }
+  auto t2 = clock::now();
+
+  const double linear_ns = std::chrono::duration<double, std::nano>(t1 - t0).count() / LOOKUPS;
+  const double hashed_ns = std::chrono::duration<double, std::nano>(t2 - t1).count() / LOOKUPS;
+  printf("%6d slots  linear %9.1f ns/lookup  hashed %6.1f ns/lookup\n", SLOTS, linear_ns, hashed_ns);
+}
+
+int main() {
+  std::mt19937 rng(1234);
+  run<64>(rng);
+  run<128>(rng);
+  run<256>(rng);
+  run<512>(rng);
+  run<1024>(rng);
+  run<4096>(rng);
+  run<16384>(rng);
+  return 0;
+}
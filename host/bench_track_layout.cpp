@@ -0,0 +1,163 @@
+// Host benchmark: hot/cold table layout vs. the old monolithic structs.
+//
+// "Legacy" reproduces the previous Track/Anchor (doubles for geo, classifier
+// fields inline). "Split" is the current Track + TrackInfo / Anchor +
+// AnchorInfo from Track.h. Two workloads, each over the whole table:
+//   scan   - what ranking/eviction/fingerprinting read: in-use, flags,
+//            recency and score inputs (tracks), or recency + RSSI (anchors)
+//   update - the per-observation hot-path write to a random slot
+// The hot arrays are smaller, so more slots fit per cache line; the gap
+// widens once the table no longer fits in L1 (on the ESP32-S3 the data
+// cache is far smaller than a desktop L1+L2).
+//
+//   g++ -O2 -std=gnu++2a -I../src bench_track_layout.cpp -o bench_track_layout
+//   ./bench_track_layout
+
+#include "Track.h"
+
+#include <chrono>
+#include <cstdio>
+#include <random>
+#include <vector>
+
+struct LegacyTrack {
+  bool      in_use = false;
+  TrackKind kind{};
+  uint8_t   addr[6]{};
+  Vendor    vendor = Vendor::Unknown;
+  EntityFlags flags = EntityFlags::None;
+  uint32_t  handle = 0;
+  uint32_t  first_seen_s = 0;
+  uint32_t  last_seen_s  = 0;
+  uint32_t  last_window  = 0;
+  uint32_t  seen_windows = 0;
+  uint32_t  near_windows = 0;
+  float     ema_rssi     = -100.0f;
+  float     ema_abs_dev  = 0.0f;
+  uint32_t  last_segment_id = 0;
+  uint32_t  env_hits        = 0;
+  float     crowd_ema = 0.0f;
+  uint32_t  last_geo_s = 0;
+  double    last_lat = 0.0;
+  double    last_lon = 0.0;
+  TrackerType tracker_type = TrackerType::Unknown;
+  GoogleFmnManufacturer tracker_google_mfr = GoogleFmnManufacturer::Unknown;
+  SamsungTrackerSubtype tracker_samsung_subtype = SamsungTrackerSubtype::Unknown;
+  uint8_t tracker_confidence = 0;
+  GlassesType glasses_type = GlassesType::Unknown;
+  uint8_t glasses_confidence = 0;
+  FlockType flock_type = FlockType::Unknown;
+  uint8_t flock_confidence = 0;
+};
+
+struct LegacyAnchor {
+  bool     in_use = false;
+  uint8_t  addr[6]{};
+  Vendor   vendor = Vendor::Unknown;
+  EntityFlags flags = EntityFlags::None;
+  uint8_t  ssid[32]{};
+  uint8_t  ssid_len = 0;
+  uint32_t handle = 0;
+  int      last_rssi = -100;
+  uint32_t last_seen_s = 0;
+  uint32_t last_geo_s = 0;
+  double   last_lat = 0.0;
+  double   last_lon = 0.0;
+  int      best_rssi = -127;
+  double   best_lat = 0.0;
+  double   best_lon = 0.0;
+  double   w_sum = 0.0;
+  double   w_lat = 0.0;
+  double   w_lon = 0.0;
+};
+
+static constexpr int PASSES = 64;
+using bench_clock = std::chrono::steady_clock;
+
+template <typename T>
+static float track_scan(const T* t, int n, uint32_t now) {
+  float acc = 0.0f;
+  for (int i = 0; i < n; ++i) {
+    if (!t[i].in_use || HasFlag(t[i].flags, EntityFlags::Watching)) continue;
+    if (now - t[i].last_seen_s > 600) continue;
+    const float f = t[i].seen_windows ? (float)t[i].near_windows / (float)t[i].seen_windows : 0.0f;
+    acc += f + t[i].ema_abs_dev + (float)t[i].env_hits - t[i].crowd_ema + t[i].ema_rssi;
+  }
+  return acc;
+}
+
+template <typename T>
+static int anchor_scan(const T* a, int n, uint32_t now) {
+  int acc = 0;
+  for (int i = 0; i < n; ++i) {
+    if (!a[i].in_use || now - a[i].last_seen_s > 60) continue;
+    acc += a[i].last_rssi + a[i].addr[5];
+  }
+  return acc;
+}
+
+template <typename T>
+static void track_update(T& t, int rssi, uint32_t ts) {
+  t.last_seen_s = ts;
+  const uint32_t window = ts / 60;
+  if (t.last_window != window) {
+    t.last_window = window;
+    t.seen_windows++;
+    if (rssi >= -60) t.near_windows++;
+  }
+  const float prev = t.ema_rssi;
+  t.ema_rssi = 0.8f * t.ema_rssi + 0.2f * (float)rssi;
+  t.ema_abs_dev = 0.8f * t.ema_abs_dev + 0.2f * (prev > (float)rssi ? prev - (float)rssi : (float)rssi - prev);
+}
+
+template <typename TrackT, typename AnchorT>
+static void run_layout(const char* name, int n, std::mt19937& rng, const std::vector<int>& slots) {
+  std::vector<TrackT> tracks(n);
+  std::vector<AnchorT> anchors(n);
+  for (int i = 0; i < n; ++i) {
+    tracks[i].in_use = (rng() % 8) != 0;
+    tracks[i].last_seen_s = 1000 + rng() % 600;
+    tracks[i].seen_windows = 1 + rng() % 50;
+    tracks[i].near_windows = rng() % (tracks[i].seen_windows + 1);
+    anchors[i].in_use = (rng() % 8) != 0;
+    anchors[i].last_seen_s = 1500 + rng() % 120;
+  }
+
+  volatile float fsink = 0.0f;
+  volatile int isink = 0;
+
+  auto t0 = bench_clock::now();
+  for (int p = 0; p < PASSES; ++p) fsink = fsink + track_scan(tracks.data(), n, 1600);
+  auto t1 = bench_clock::now();
+  for (int p = 0; p < PASSES; ++p) isink = isink + anchor_scan(anchors.data(), n, 1600);
+  auto t2 = bench_clock::now();
+  const int updates = PASSES * n;
+  for (int u = 0; u < updates; ++u) {
+    const int i = slots[u & (slots.size() - 1)] % n;
+    track_update(tracks[i], -40 - (u & 63), 1600 + (uint32_t)(u >> 10));
+  }
+  auto t3 = bench_clock::now();
+
+  const double per = (double)PASSES * n;
+  printf("  %-6s %3zu+%-3zu B  track scan %6.2f ns/slot  anchor scan %6.2f ns/slot  update %6.2f ns\n",
+         name, sizeof(TrackT), sizeof(AnchorT),
+         std::chrono::duration<double, std::nano>(t1 - t0).count() / per,
+         std::chrono::duration<double, std::nano>(t2 - t1).count() / per,
+         std::chrono::duration<double, std::nano>(t3 - t2).count() / per);
+}
+
+int main() {
+  std::mt19937 rng(1234);
+  std::vector<int> slots(1 << 16);
+  for (auto& s : slots) s = (int)(rng() & 0x7FFFFFFF);
+
+  printf("hot Track %zu B (+%zu B TrackInfo), hot Anchor %zu B (+%zu B AnchorInfo)\n",
+         sizeof(Track), sizeof(TrackInfo), sizeof(Anchor), sizeof(AnchorInfo));
+
+  for (int n : {256, 1024, 4096, 16384, 65536}) {
+    printf("%d slots\n", n);
+    run_layout<LegacyTrack, LegacyAnchor>("legacy", n, rng, slots);
+    run_layout<Track, Anchor>("split", n, rng, slots);
+  }
+  return 0;
+}
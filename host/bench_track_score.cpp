@@ -0,0 +1,86 @@
+// Host benchmark + tolerance check: fixed-point TrackScore vs. the float
+// formula it replaced.
+//
+// Sweeps random track states (ages past the persistence cap, every near/seen
+// ratio, RSSI deviation and crowd levels beyond both ends of their ranges)
+// and reports the worst absolute difference in points, then times:
+//   float  - the old per-frame score_track() (Reference)
+//   base   - recomputing the cached per-track part (after an observation)
+//   cached - what a frame pays with a fresh cache: Coverage + Combine
+// Exits non-zero if the difference exceeds the documented 0.1 point.
+//
+//   g++ -O2 -std=gnu++2a -I../src bench_track_score.cpp -o bench_track_score
+//   ./bench_track_score
+
+#include "TrackScore.h"
+
+#include <chrono>
+#include <cmath>
+#include <cstdio>
+#include <random>
+#include <vector>
+
+struct Input {
+  uint32_t age_s, seen, near, env_hits, move_segments;
+  float    dev, crowd, stationary;
+};
+
+int main() {
+  std::mt19937 rng(1234);
+  std::uniform_real_distribution<float> unit(0.0f, 1.0f);
+
+  std::vector<Input> in(1 << 16);
+  for (auto& x : in) {
+    x.age_s = rng() % 2400;
+    x.seen = rng() % 200;
+    x.near = x.seen ? rng() % (x.seen + 1) : 0;
+    x.move_segments = rng() % 64;
+    x.env_hits = rng() % 80;
+    x.dev = 14.0f * unit(rng);
+    x.crowd = 50.0f * unit(rng);
+    x.stationary = 1.2f * unit(rng) - 0.1f;
+  }
+
+  double worst = 0.0;
+  for (const auto& x : in) {
+    const float ref = TrackScore::Reference(x.age_s, x.seen, x.near, x.dev, x.crowd, x.env_hits,
+                                            x.move_segments, x.stationary);
+    const int32_t q = TrackScore::Combine(TrackScore::Base(x.age_s, x.seen, x.near, x.dev, x.crowd),
+                                          TrackScore::Coverage(x.env_hits, x.move_segments),
+                                          TrackScore::Stationary(x.stationary));
+    worst = std::max(worst, (double)std::fabs(TrackScore::ToFloat(q) - ref));
+  }
+  printf("max |fixed - float| = %.4f points over %zu states\n", worst, in.size());
+
+  using clock = std::chrono::steady_clock;
+  constexpr int PASSES = 64;
+  const double per = (double)PASSES * in.size();
+  volatile float fsink = 0.0f;
+  volatile int32_t isink = 0;
+
+  std::vector<int32_t> base(in.size());
+  for (size_t i = 0; i < in.size(); ++i)
+    base[i] = TrackScore::Base(in[i].age_s, in[i].seen, in[i].near, in[i].dev, in[i].crowd);
+  const int32_t stat = TrackScore::Stationary(0.25f);
+
+  auto t0 = clock::now();
+  for (int p = 0; p < PASSES; ++p)
+    for (const auto& x : in)
+      fsink = fsink + TrackScore::Reference(x.age_s, x.seen, x.near, x.dev, x.crowd, x.env_hits, x.move_segments, 0.25f);
+  auto t1 = clock::now();
+  for (int p = 0; p < PASSES; ++p)
+    for (const auto& x : in)
+      isink = isink + TrackScore::Base(x.age_s, x.seen, x.near, x.dev, x.crowd);
+  auto t2 = clock::now();
+  for (int p = 0; p < PASSES; ++p)
+    for (size_t i = 0; i < in.size(); ++i)
+      isink = isink + TrackScore::Combine(base[i], TrackScore::Coverage(in[i].env_hits, in[i].move_segments), stat);
+  auto t3 = clock::now();
+
+  printf("float %6.2f ns/track  base %6.2f ns/track  cached %6.2f ns/track\n",
+         std::chrono::duration<double, std::nano>(t1 - t0).count() / per,
+         std::chrono::duration<double, std::nano>(t2 - t1).count() / per,
+         std::chrono::duration<double, std::nano>(t3 - t2).count() / per);
+
+  return worst <= 0.1 ? 0 : 1;
+}
@@ -0,0 +1,416 @@
+// Host tool: run pcap/pcapng captures through the sniffer's 802.11 parser
+// (Ieee80211.h) and into the tracker core.
+//
+// Reads classic pcap (µs or ns timestamps, either byte order) and pcapng
+// (any number of sections and interfaces, EPB and SPB), link types
+// IEEE802_11 (105) and IEEE802_11_RADIOTAP (127); everything else, such as
+// the BLE interface of a Pigtail capture, is counted and skipped. RSSI comes
+// from the radiotap dBm antenna signal, else --rssi. Frames the radiotap
+// flags mark as carrying an FCS have it stripped; frames with a bad FCS are
+// dropped.
+//
+// First every file is read and its frames are collected, then
+// parse_mgmt_frame() runs over all of them --repeat times and its throughput
+// is reported on its own. The parsed observations are then applied to the
+// tracker one pass per second of capture time on a virtual clock, as the
+// processing task would have seen them. Several files replay as one
+// timeline in the order given; a file that starts earlier than the previous
+// one ended continues from where it ended. On the way in, repeat sightings
+// go through the sniffer's coalescing cache (Coalescer.h) with a --coalesce
+// window in ms (default the device's 1000; 0 turns it off), so the tracker
+// throughput in frames per second shows what coalescing buys.
+//
+//   cmake -S host -B build-host && cmake --build build-host -j
+//   build-host/ingest_pcap capture.pcapng [more.pcap ...] [--top 20] [--capacity 1024,512]
+//                          [--repeat 10] [--rssi -70] [--coalesce 1000] [--parse-only]
+
+#include "Coalescer.h"
+#include "DeviceTracker.h"
+#include "Ieee80211.h"
+#include "Journal.h"
+#include "VirtualClock.h"
+
+#include <chrono>
+#include <cstdio>
+#include <cstdlib>
+#include <cstring>
+#include <set>
+#include <vector>
+
+static constexpr uint32_t LINKTYPE_IEEE802_11 = 105;
+static constexpr uint32_t LINKTYPE_IEEE802_11_RADIOTAP = 127;
+
+// One captured 802.11 frame, pointing into its file's buffer.
+struct Frame {
+  const uint8_t* data;
+  uint32_t len;
+  uint64_t ts_us;
+  int8_t rssi;
+};
+
+struct Counts {
+  uint32_t packets = 0;
+  uint32_t other_link = 0;
+  uint32_t bad_radiotap = 0;
+  uint32_t bad_fcs = 0;
+  uint32_t no_signal = 0;
+};
+
+// Byte-order-aware reads for pcap and pcapng headers.
+struct Reader {
+  bool swap = false;
+  uint16_t U16(const uint8_t* p) const { return swap ? (uint16_t)(p[0] << 8 | p[1]) : (uint16_t)(p[0] | p[1] << 8); }
+  uint32_t U32(const uint8_t* p) const {
+    return swap ? (uint32_t)p[0] << 24 | (uint32_t)p[1] << 16 | (uint32_t)p[2] << 8 | p[3]
+                : (uint32_t)p[0] | (uint32_t)p[1] << 8 | (uint32_t)p[2] << 16 | (uint32_t)p[3] << 24;
+  }
+};
+
+static uint16_t le16(const uint8_t* p) { return (uint16_t)(p[0] | p[1] << 8); }
+static uint32_t le32(const uint8_t* p) { return (uint32_t)p[0] | (uint32_t)p[1] << 8 | (uint32_t)p[2] << 16 | (uint32_t)p[3] << 24; }
+
+enum class Radiotap { Ok, Malformed, BadFcs };
+
+// Strips the radiotap header (always little-endian), taking the dBm
+// antenna signal and the flags. Only fields up to the antenna signal are
+// walked; anything after it does not move its offset.
+static Radiotap strip_radiotap(const uint8_t*& p, uint32_t& len, int8_t& rssi, bool& have_rssi) {
+  if (len < 8 || p[0] != 0) return Radiotap::Malformed;
+  const uint16_t rt_len = le16(p + 2);
+  if (rt_len < 8 || rt_len > len) return Radiotap::Malformed;
+
+  uint32_t present = le32(p + 4);
+  uint32_t off = 8;
+  for (uint32_t word = present; word & 0x80000000u; off += 4) { // extended bitmaps
+    if (off + 4 > rt_len) return Radiotap::Malformed;
+    word = le32(p + off);
+  }
+
+  // Alignment and size of fields 0..5: TSFT, Flags, Rate, Channel, FHSS,
+  // dBm Antenna Signal.
+  static const uint8_t ALIGN[6] = {8, 1, 1, 2, 2, 1};
+  static const uint8_t SIZE[6] = {8, 1, 1, 4, 2, 1};
+  uint8_t flags = 0;
+  have_rssi = false;
+  for (int bit = 0; bit < 6; ++bit) {
+    if (!(present & (1u << bit))) continue;
+    off = (off + ALIGN[bit] - 1) & ~(uint32_t)(ALIGN[bit] - 1);
+    if (off + SIZE[bit] > rt_len) return Radiotap::Malformed;
+    if (bit == 1) flags = p[off];
+    if (bit == 5) {
+      rssi = (int8_t)p[off];
+      have_rssi = true;
+    }
+    off += SIZE[bit];
+  }
+
+  if (flags & 0x40) return Radiotap::BadFcs;
+  p += rt_len;
+  len -= rt_len;
+  if (flags & 0x10) { // FCS at end
+    if (len < 4) return Radiotap::Malformed;
+    len -= 4;
+  }
+  return Radiotap::Ok;
+}
+
+static void add_frame(std::vector<Frame>& out, uint32_t linktype, const uint8_t* p, uint32_t len, uint64_t ts_us,
+                      int8_t default_rssi, Counts& c) {
+  c.packets++;
+  int8_t rssi = default_rssi;
+  if (linktype == LINKTYPE_IEEE802_11_RADIOTAP) {
+    bool have = false;
+    switch (strip_radiotap(p, len, rssi, have)) {
+      case Radiotap::Ok: break;
+      case Radiotap::Malformed: c.bad_radiotap++; return;
+      case Radiotap::BadFcs: c.bad_fcs++; return;
+    }
+    if (!have) {
+      rssi = default_rssi;
+      c.no_signal++;
+    }
+  } else if (linktype == LINKTYPE_IEEE802_11) {
+    c.no_signal++;
+  } else {
+    c.other_link++;
+    return;
+  }
+  out.push_back({p, len, ts_us, rssi});
+}
+
+static bool read_pcap(const std::vector<uint8_t>& d, std::vector<Frame>& out, int8_t rssi, Counts& c) {
+  if (d.size() < 24) return false;
+  const uint32_t magic = le32(d.data());
+  Reader r;
+  bool nanos = false;
+  if (magic == 0xA1B2C3D4u) {
+  } else if (magic == 0xD4C3B2A1u) {
+    r.swap = true;
+  } else if (magic == 0xA1B23C4Du) {
+    nanos = true;
+  } else if (magic == 0x4D3CB2A1u) {
+    r.swap = nanos = true;
+  } else {
+    return false;
+  }
+  const uint32_t linktype = r.U32(d.data() + 20) & 0x0FFFFFFF;
+  for (size_t pos = 24; pos + 16 <= d.size();) {
+    const uint8_t* h = d.data() + pos;
+    const uint32_t caplen = r.U32(h + 8);
+    if (pos + 16 + caplen > d.size()) break; // torn tail
+    const uint64_t ts_us = (uint64_t)r.U32(h) * 1000000 + (nanos ? r.U32(h + 4) / 1000 : r.U32(h + 4));
+    add_frame(out, linktype, h + 16, caplen, ts_us, rssi, c);
+    pos += 16 + caplen;
+  }
+  return true;
+}
+
+struct Interface {
+  uint32_t linktype;
+  uint64_t ts_scale; // microseconds = ts * ts_scale if ts_mul, else ts / ts_scale
+  bool ts_mul;
+};
+
+static bool read_pcapng(const std::vector<uint8_t>& d, std::vector<Frame>& out, int8_t rssi, Counts& c) {
+  Reader r;
+  std::vector<Interface> ifs;
+  uint64_t last_ts_us = 0;
+  size_t pos = 0;
+  while (pos + 12 <= d.size()) {
+    const uint8_t* b = d.data() + pos;
+    if (le32(b) == 0x0A0D0D0Au) { // SHB: byte order may change per section
+      const uint32_t bom = le32(b + 8);
+      if (bom == 0x1A2B3C4Du) r.swap = false;
+      else if (bom == 0x4D3C2B1Au) r.swap = true;
+      else return pos > 0;
+      ifs.clear();
+    }
+    const uint32_t type = r.U32(b);
+    const uint32_t blen = r.U32(b + 4);
+    if (blen < 12 || (blen & 3) || pos + blen > d.size()) break;
+
+    if (type == 1 && blen >= 20) { // IDB
+      Interface itf{r.U16(b + 8), 1, false};
+      for (size_t o = 16; o + 4 <= blen - 4;) { // options
+        const uint16_t code = r.U16(b + o), olen = r.U16(b + o + 2);
+        if (code == 0) break;
+        if (code == 9 && olen >= 1) { // if_tsresol
+          const uint8_t v = b[o + 4];
+          uint64_t units = 1;
+          if (v & 0x80) for (int i = 0; i < (v & 0x7F) && i < 63; ++i) units *= 2;
+          else for (int i = 0; i < v && i < 19; ++i) units *= 10;
+          itf.ts_mul = units < 1000000;
+          itf.ts_scale = itf.ts_mul ? 1000000 / units : units / 1000000;
+        }
+        o += 4 + ((olen + 3u) & ~3u);
+      }
+      ifs.push_back(itf);
+    } else if (type == 6 && blen >= 32) { // EPB
+      const uint32_t iface = r.U32(b + 8);
+      const uint64_t ts = (uint64_t)r.U32(b + 12) << 32 | r.U32(b + 16);
+      const uint32_t caplen = r.U32(b + 20);
+      if (iface < ifs.size() && 28 + caplen <= blen - 4) {
+        const Interface& itf = ifs[iface];
+        last_ts_us = itf.ts_mul ? ts * itf.ts_scale : ts / itf.ts_scale;
+        add_frame(out, itf.linktype, b + 28, caplen, last_ts_us, rssi, c);
+      }
+    } else if (type == 3 && blen >= 16 && !ifs.empty()) { // SPB: interface 0, no timestamp
+      const uint32_t len = std::min(r.U32(b + 8), blen - 16);
+      add_frame(out, ifs[0].linktype, b + 12, len, last_ts_us, rssi, c);
+    }
+    pos += blen;
+  }
+  return true;
+}
+
+static bool load(const char* path, std::vector<uint8_t>& data) {
+  FILE* f = fopen(path, "rb");
+  if (!f) {
+    perror(path);
+    return false;
+  }
+  uint8_t chunk[65536];
+  for (size_t n; (n = fread(chunk, 1, sizeof(chunk), f)) > 0;) data.insert(data.end(), chunk, chunk + n);
+  fclose(f);
+  return true;
+}
+
+static const char* entity_kind_name(EntityKind k) {
+  switch (k) {
+    case EntityKind::WifiClient: return "wifi";
+    case EntityKind::BleAdv: return "ble";
+    case EntityKind::WifiAp: return "ap";
+  }
+  return "?";
+}
+
+int main(int argc, char** argv) {
+  std::vector<const char*> paths;
+  bool parse_only = false;
+  int top = 10, tracks = 0, anchors = 0, repeat = 5, rssi = -70, coalesce_ms = 1000;
+  for (int i = 1; i < argc; ++i) {
+    if (strcmp(argv[i], "--parse-only") == 0) parse_only = true;
+    else if (strcmp(argv[i], "--top") == 0 && i + 1 < argc) top = atoi(argv[++i]);
+    else if (strcmp(argv[i], "--capacity") == 0 && i + 1 < argc) sscanf(argv[++i], "%d,%d", &tracks, &anchors);
+    else if (strcmp(argv[i], "--repeat") == 0 && i + 1 < argc) repeat = std::max(1, atoi(argv[++i]));
+    else if (strcmp(argv[i], "--rssi") == 0 && i + 1 < argc) rssi = atoi(argv[++i]);
+    else if (strcmp(argv[i], "--coalesce") == 0 && i + 1 < argc) coalesce_ms = std::max(0, atoi(argv[++i]));
+    else paths.push_back(argv[i]);
+  }
+  if (paths.empty()) {
+    fprintf(stderr, "usage: %s <capture.pcap|.pcapng>... [--top N] [--capacity TRACKS,ANCHORS] [--repeat N]\n"
+                    "          [--rssi DBM] [--coalesce MS] [--parse-only]\n", argv[0]);
+    return 2;
+  }
+
+  // Files stay in memory; frames point into them.
+  std::vector<std::vector<uint8_t>> files(paths.size());
+  std::vector<Frame> frames;
+  Counts counts;
+  size_t bytes = 0;
+  for (size_t i = 0; i < paths.size(); ++i) {
+    if (!load(paths[i], files[i])) return 1;
+    bytes += files[i].size();
+    const std::vector<uint8_t>& d = files[i];
+    const size_t before = frames.size();
+    const bool ok = d.size() >= 4 && le32(d.data()) == 0x0A0D0D0Au
+                        ? read_pcapng(d, frames, (int8_t)rssi, counts)
+                        : read_pcap(d, frames, (int8_t)rssi, counts);
+    if (!ok) {
+      fprintf(stderr, "%s: not a pcap or pcapng file\n", paths[i]);
+      return 1;
+    }
+    printf("%s: %zu bytes, %zu 802.11 frames\n", paths[i], d.size(), frames.size() - before);
+  }
+  printf("%u packets: %zu 802.11, %u other link types, %u bad radiotap, %u bad FCS, %u without signal (used %d dBm)\n",
+         counts.packets, frames.size(), counts.other_link, counts.bad_radiotap, counts.bad_fcs, counts.no_signal, rssi);
+
+  // Parser throughput, on its own.
+  uint32_t by_kind[4] = {}, with_ssid = 0;
+  volatile uint32_t sink = 0;
+  const auto p0 = std::chrono::steady_clock::now();
+  for (int rep = 0; rep < repeat; ++rep) {
+    for (const Frame& f : frames) {
+      MgmtFrame m;
+      if (parse_mgmt_frame(f.data, (int)f.len, m)) sink = sink + m.ssid_len + m.addr[5];
+      if (rep == 0) {
+        by_kind[(int)m.kind]++;
+        if (m.ssid_len) with_ssid++;
+      }
+    }
+  }
+  const double parse_s = std::chrono::duration<double>(std::chrono::steady_clock::now() - p0).count();
+  const double parsed = (double)frames.size() * repeat;
+  printf("parser: %u probe_req, %u beacon, %u probe_resp, %u other; %u with SSID\n", by_kind[1], by_kind[2],
+         by_kind[3], by_kind[0], with_ssid);
+  printf("  %.0f frames in %.1f ms over %d passes = %.2f M frames/s (%.0f ns/frame)\n", parsed, parse_s * 1e3, repeat,
+         parse_s > 0 ? parsed / parse_s / 1e6 : 0.0, parsed > 0 ? parse_s * 1e9 / parsed : 0.0);
+  if (parse_only) return 0;
+
+  static DeviceTracker tracker;
+  if (tracks > 0 && anchors > 0) tracker.setCapacity(tracks, anchors);
+  tracker.setClock(VirtualClock::Now);
+  if (!tracker.beginCore()) return 1;
+
+  // Capture time onto one virtual timeline starting at 1 s.
+  // Coalescing as in wifi_promisc_cb, on capture time; the device's tag
+  // also has the channel, which a capture may not record.
+  using Coalesce = Coalescer<JournalObservation, 64>;
+  static Coalesce coalesce((uint32_t)coalesce_ms);
+  std::vector<JournalObservation> batch;
+  std::set<uint64_t> addrs;
+  uint32_t t = 0, batch_t = 0, passes = 0, now_ms = 0, sweep_ms = 0;
+  uint64_t prev_us = 0, observations = 0;
+  bool first = true;
+  auto emit = [&](const Coalesce::Run& r) {
+    batch.push_back(r.rec);
+    JournalObservation& o = batch.back();
+    o.rssi_dbm = r.rssi_mean;
+    o.count = r.count;
+    o.rssi_min = r.rssi_min;
+    o.rssi_max = r.rssi_max;
+    observations++;
+  };
+  auto expire = [&](uint32_t ms) {
+    Coalesce::Run runs[16];
+    int k;
+    do {
+      k = coalesce.Expire(ms, runs, 16);
+      for (int i = 0; i < k; ++i) emit(runs[i]);
+    } while (k == 16);
+  };
+  auto flush = [&] {
+    if (batch.empty()) return;
+    VirtualClock::SetSeconds(batch_t);
+    tracker.ingest(batch.data(), (int)batch.size());
+    batch.clear();
+    passes++;
+  };
+
+  const auto i0 = std::chrono::steady_clock::now();
+  for (const Frame& f : frames) {
+    if (first) t = 1;
+    else if (f.ts_us > prev_us) {
+      t += (uint32_t)(f.ts_us / 1000000 - prev_us / 1000000);
+      now_ms += (uint32_t)(f.ts_us / 1000 - prev_us / 1000);
+    }
+    prev_us = std::max(prev_us, f.ts_us);
+    first = false;
+
+    if (!batch.empty() && t != batch_t) flush();
+    batch_t = t;
+    if (now_ms - sweep_ms >= 250) {
+      sweep_ms = now_ms;
+      expire(now_ms);
+    }
+
+    MgmtFrame m;
+    if (!parse_mgmt_frame(f.data, (int)f.len, m)) continue;
+    JournalObservation o;
+    o.kind = (uint8_t)m.kind;
+    o.rssi_dbm = f.rssi;
+    memcpy(o.addr, m.addr, 6);
+    o.ts_s = t;
+    o.ssid_len = m.ssid_len;
+    memcpy(o.ssid, m.ssid, m.ssid_len);
+    uint32_t tag = 0;
+    if (m.kind != MgmtKind::ProbeReq) {
+      tag = 2166136261u;
+      for (int i = 0; i < m.ssid_len; ++i) tag = (tag ^ m.ssid[i]) * 16777619u;
+    }
+    Coalesce::Run done;
+    if (coalesce.Add(o.kind, o.addr, tag, o.rssi_dbm, o, now_ms, done)) emit(done);
+    uint64_t k = (uint64_t)m.kind << 48;
+    for (int i = 0; i < 6; ++i) k |= (uint64_t)m.addr[i] << (40 - 8 * i);
+    addrs.insert(k);
+  }
+  expire(now_ms + (uint32_t)coalesce_ms);
+  flush();
+  const double ingest_s = std::chrono::duration<double>(std::chrono::steady_clock::now() - i0).count();
+
+  const IngestStats in = tracker.ingestStats();
+  const TableStats ts = tracker.tableStats();
+  printf("tracker: %u s of capture in %u passes, %zu distinct addresses, %.1f ms (%.2f M frames/s)\n", t, passes,
+         addrs.size(), ingest_s * 1e3, ingest_s > 0 ? frames.size() / ingest_s / 1e6 : 0.0);
+  printf("  %d tracks + %d anchors, max pass %u us, evictions %u/%u, expiries %u/%u\n", tracker.trackCapacity(),
+         tracker.anchorCapacity(), in.max_batch_us, ts.track_evictions, ts.anchor_evictions, ts.track_expiries,
+         ts.anchor_expiries);
+  printf("  coalescing %d ms: %u sightings in %llu observations (%.2f per observation)\n", coalesce_ms,
+         in.sightings, (unsigned long long)observations, observations ? (double)in.sightings / observations : 0.0);
+
+  tracker.publishSnapshot();
+  std::vector<EntityView> views((size_t)(top > 0 ? top : 0));
+  int total = 0;
+  const int n = top > 0 ? tracker.topK(views.data(), 0, top, &total) : 0;
+  printf("  segment %u, %u moves, %d ranked (%.1f MB of captures)\n", tracker.segmentId(), tracker.moveSegments(),
+         total, bytes / 1e6);
+  for (int r = 0; r < n; ++r) {
+    const EntityView& v = views[(size_t)r];
+    printf("  %3d  %-4s %02x:%02x:%02x:%02x:%02x:%02x  score %5.1f  rssi %4d  age %5u s  windows %u/%u  env %u  \"%.*s\"\n",
+           r + 1, entity_kind_name(v.kind), v.addr[0], v.addr[1], v.addr[2], v.addr[3], v.addr[4], v.addr[5],
+           v.score, v.rssi, v.age_s, v.near_windows, v.seen_windows, v.env_hits, (int)v.ssid_len,
+           (const char*)v.ssid);
+  }
+  (void)sink;
+  return 0;
+}
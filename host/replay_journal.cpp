@@ -0,0 +1,223 @@
+// Host tool: replay an observation journal (pt_journal.bin, Journal.h)
+// through the tracker core.
+//
+// Decodes every record at full speed and feeds it to DeviceTracker::ingest()
+// exactly as the processing task would have applied it: observations of the
+// same second go in as one pass at that second, GPS fixes go to setGpsFix()
+// in order, and a Session record from a new boot resets the tracker (one that
+// only restarted recording leaves it alone; the clock ran on). Prints
+// what the capture holds, any corrupt stretches (skipped a byte at a time
+// until a record's CRC checks out), throughput, and the final ranking. With
+// --dump it prints each record; --decode-only skips the tracker.
+//
+// The cold store lives in host_fs/spiffs under the working directory.
+//
+//   cmake -S host -B build-host && cmake --build build-host -j
+//   build-host/replay_journal pt_journal.bin [--top 20] [--capacity 1024,512] [--dump]
+
+#include "DeviceTracker.h"
+#include "Journal.h"
+#include "VirtualClock.h"
+
+#include <chrono>
+#include <cstdio>
+#include <cstdlib>
+#include <cstring>
+#include <set>
+#include <vector>
+
+static const char* kind_name(uint8_t kind) {
+  switch (kind) {
+    case 1: return "probe_req";
+    case 2: return "beacon";
+    case 3: return "probe_resp";
+    case 4: return "ble_adv";
+    default: return "unknown";
+  }
+}
+
+static uint64_t addr_key(const uint8_t* a) {
+  uint64_t k = 0;
+  for (int i = 0; i < 6; ++i) k = (k << 8) | a[i];
+  return k;
+}
+
+static const char* entity_kind_name(EntityKind k) {
+  switch (k) {
+    case EntityKind::WifiClient: return "wifi";
+    case EntityKind::BleAdv: return "ble";
+    case EntityKind::WifiAp: return "ap";
+  }
+  return "?";
+}
+
+// Observations of one second, applied as one processing pass.
+struct Replay {
+  DeviceTracker* tracker = nullptr;
+  std::vector<JournalObservation> batch;
+  uint32_t batch_ts = 0;
+  uint32_t passes = 0;
+
+  void Flush() {
+    if (!tracker || batch.empty()) return;
+    VirtualClock::SetSeconds(batch_ts);
+    tracker->ingest(batch.data(), (int)batch.size());
+    batch.clear();
+    passes++;
+  }
+
+  void Add(const JournalObservation& o) {
+    if (!tracker) return;
+    if (!batch.empty() && o.ts_s != batch_ts) Flush();
+    batch_ts = o.ts_s;
+    batch.push_back(o);
+  }
+};
+
+int main(int argc, char** argv) {
+  const char* path = nullptr;
+  bool dump = false, decode_only = false;
+  int top = 10, tracks = 0, anchors = 0;
+  for (int i = 1; i < argc; ++i) {
+    if (strcmp(argv[i], "--dump") == 0) dump = true;
+    else if (strcmp(argv[i], "--decode-only") == 0) decode_only = true;
+    else if (strcmp(argv[i], "--top") == 0 && i + 1 < argc) top = atoi(argv[++i]);
+    else if (strcmp(argv[i], "--capacity") == 0 && i + 1 < argc) sscanf(argv[++i], "%d,%d", &tracks, &anchors);
+    else path = argv[i];
+  }
+  if (!path) {
+    fprintf(stderr, "usage: %s <journal> [--top N] [--capacity TRACKS,ANCHORS] [--dump] [--decode-only]\n", argv[0]);
+    return 2;
+  }
+
+  FILE* f = fopen(path, "rb");
+  if (!f) {
+    perror(path);
+    return 1;
+  }
+  std::vector<uint8_t> data;
+  uint8_t chunk[65536];
+  for (size_t n; (n = fread(chunk, 1, sizeof(chunk), f)) > 0;) data.insert(data.end(), chunk, chunk + n);
+  fclose(f);
+
+  if (!Journal::CheckHeader(data.data(), data.size())) {
+    fprintf(stderr, "%s: not a journal (bad header)\n", path);
+    return 1;
+  }
+
+  static DeviceTracker tracker;
+  Replay replay;
+  if (!decode_only) {
+    if (tracks > 0 && anchors > 0) tracker.setCapacity(tracks, anchors);
+    tracker.setClock(VirtualClock::Now);
+    if (!tracker.beginCore()) return 1;
+    replay.tracker = &tracker;
+  }
+
+  uint32_t sessions = 0, boots = 0, boot_id = 0, fixes = 0, fixes_valid = 0, obs_total = 0, obs_by_kind[5] = {}, sightings = 0;
+  uint32_t classified = 0, corrupt_runs = 0, corrupt_bytes = 0;
+  uint32_t first_ts = 0, last_ts = 0;
+  bool have_ts = false, in_corrupt = false;
+  std::set<uint64_t> addrs;
+
+  const auto t0 = std::chrono::steady_clock::now();
+  size_t pos = Journal::HEADER_SIZE;
+  while (pos < data.size()) {
+    JournalEntry e;
+    size_t used = 0;
+    const Journal::Status st = Journal::Decode(data.data() + pos, data.size() - pos, e, used);
+    if (st == Journal::Status::NeedMore) break; // torn tail
+    if (st == Journal::Status::Corrupt) {
+      if (!in_corrupt) corrupt_runs++;
+      in_corrupt = true;
+      corrupt_bytes++;
+      pos++;
+      continue;
+    }
+    in_corrupt = false;
+    pos += used;
+
+    switch (e.type) {
+      case JournalType::Session: {
+        // After a reboot the device's clock went back, so start over as the
+        // device did. Files without boot ids treat every session as a boot.
+        replay.Flush();
+        const bool reboot = sessions == 0 || e.boot_id == 0 || e.boot_id != boot_id;
+        if (reboot && sessions > 0 && replay.tracker) tracker.reset();
+        if (reboot) boots++;
+        boot_id = e.boot_id;
+        sessions++;
+        if (dump) printf("session  t=%u boot=%08x\n", e.session_ts_s, e.boot_id);
+      } break;
+
+      case JournalType::GnssFix:
+        replay.Flush();
+        if (replay.tracker) tracker.setGpsFix(e.fix.valid, e.fix.lat_e6 / 1e6, e.fix.lon_e6 / 1e6);
+        fixes++;
+        if (e.fix.valid) fixes_valid++;
+        if (dump) {
+          printf("fix      t=%u %s %.6f %.6f\n", e.fix.ts_s, e.fix.valid ? "valid" : "none",
+                 e.fix.lat_e6 / 1e6, e.fix.lon_e6 / 1e6);
+        }
+        break;
+
+      case JournalType::Observation: {
+        const JournalObservation& o = e.obs;
+        replay.Add(o);
+        obs_total++;
+        sightings += o.count;
+        obs_by_kind[o.kind < 5 ? o.kind : 0]++;
+        if (o.tracker_type != TrackerType::Unknown || o.glasses_type != GlassesType::Unknown ||
+            o.flock_type != FlockType::Unknown) {
+          classified++;
+        }
+        addrs.insert(((uint64_t)o.kind << 48) | addr_key(o.addr));
+        if (!have_ts || o.ts_s < first_ts) first_ts = o.ts_s;
+        if (!have_ts || o.ts_s > last_ts) last_ts = o.ts_s;
+        have_ts = true;
+        if (dump) {
+          printf("obs      t=%u %-10s %02x:%02x:%02x:%02x:%02x:%02x %4d dBm \"%.*s\"\n", o.ts_s,
+                 kind_name(o.kind), o.addr[0], o.addr[1], o.addr[2], o.addr[3], o.addr[4], o.addr[5],
+                 o.rssi_dbm, (int)o.ssid_len, (const char*)o.ssid);
+        }
+      } break;
+    }
+  }
+  replay.Flush();
+  const double secs = std::chrono::duration<double>(std::chrono::steady_clock::now() - t0).count();
+
+  printf("%s: %zu bytes, %u sessions over %u boots\n", path, data.size(), sessions, boots);
+  printf("  observations %u (probe_req %u, beacon %u, probe_resp %u, ble_adv %u, unknown %u), %u classified\n",
+         obs_total, obs_by_kind[1], obs_by_kind[2], obs_by_kind[3], obs_by_kind[4], obs_by_kind[0], classified);
+  printf("  sightings %u (repeats coalesced on the device)\n", sightings);
+  printf("  distinct addresses %zu\n", addrs.size());
+  printf("  gps fixes %u (%u valid)\n", fixes, fixes_valid);
+  if (have_ts) printf("  observation time %u..%u s (%u s)\n", first_ts, last_ts, last_ts - first_ts);
+  printf("  corrupt %u bytes in %u runs, %zu trailing bytes\n", corrupt_bytes, corrupt_runs, data.size() - pos);
+  printf("  %s in %.1f ms (%.2f M records/s)\n", decode_only ? "decoded" : "replayed", secs * 1e3,
+         secs > 0 ? (sessions + fixes + obs_total) / secs / 1e6 : 0.0);
+  if (decode_only) return 0;
+
+  const IngestStats in = tracker.ingestStats();
+  const ColdStats cold = tracker.coldStats();
+  const CrowdStats crowd = tracker.crowdStats();
+  printf("tracker: %d tracks + %d anchors, %u passes, max pass %u us\n", tracker.trackCapacity(),
+         tracker.anchorCapacity(), in.batches, in.max_batch_us);
+  printf("  cold: spilled %u, rehydrated %u, false hits %u, dropped %u\n", cold.spilled, cold.rehydrated,
+         cold.false_hits, cold.dropped);
+  printf("  last crowd window: %u wifi + %u ble\n", crowd.wifi, crowd.ble);
+
+  tracker.publishSnapshot();
+  std::vector<EntityView> views((size_t)(top > 0 ? top : 0));
+  int total = 0;
+  const int n = top > 0 ? tracker.topK(views.data(), 0, top, &total) : 0;
+  printf("  segment %u, %u moves, %d ranked\n", tracker.segmentId(), tracker.moveSegments(), total);
+  for (int r = 0; r < n; ++r) {
+    const EntityView& v = views[(size_t)r];
+    printf("  %3d  %-4s %02x:%02x:%02x:%02x:%02x:%02x  score %5.1f  rssi %4d  age %5u s  windows %u/%u  env %u  \"%.*s\"\n",
+           r + 1, entity_kind_name(v.kind), v.addr[0], v.addr[1], v.addr[2], v.addr[3], v.addr[4], v.addr[5],
+           v.score, v.rssi, v.age_s, v.near_windows, v.seen_windows, v.env_hits, (int)v.ssid_len,
+           (const char*)v.ssid);
+  }
+  return 0;
+}
@@ -0,0 +1,98 @@
+#pragma once
+
+// Host stand-in for the parts of the Arduino-ESP32 core the tracker uses:
+// Print/Stream, Serial on stdout, String, millis()/delay() and
+// esp_timer_get_time(). Implemented in HostHal.cpp.
+
+#include <algorithm>
+#include <cmath>
+#include <cstdarg>
+#include <cstddef>
+#include <cstdint>
+#include <cstdio>
+#include <cstring>
+#include <string>
+
+#include "freertos/FreeRTOS.h"
+
+#define IRAM_ATTR
+
+using std::max;
+using std::min;
+
+class Print {
+public:
+  virtual ~Print() = default;
+  virtual size_t write(uint8_t c) = 0;
+  virtual size_t write(const uint8_t* buf, size_t n) {
+    size_t done = 0;
+    while (done < n && write(buf[done])) ++done;
+    return done;
+  }
+
+  size_t write(const char* s) { return write((const uint8_t*)s, strlen(s)); }
+  size_t print(const char* s) { return write(s); }
+  size_t print(const std::string& s) { return write((const uint8_t*)s.data(), s.size()); }
+  size_t print(char c) { return write((uint8_t)c); }
+  size_t print(int v) { return printf("%d", v); }
+  size_t print(unsigned v) { return printf("%u", v); }
+  size_t print(long v) { return printf("%ld", v); }
+  size_t print(unsigned long v) { return printf("%lu", v); }
+  size_t print(double v, int digits = 2) { return printf("%.*f", digits, v); }
+  template <typename T>
+  size_t println(const T& v) { return print(v) + println(); }
+  size_t println() { return write((const uint8_t*)"\r\n", 2); }
+
+  size_t printf(const char* fmt, ...) __attribute__((format(printf, 2, 3))) {
+    char small[256];
+    va_list ap;
+    va_start(ap, fmt);
+    const int n = vsnprintf(small, sizeof(small), fmt, ap);
+    va_end(ap);
+    if (n < 0) return 0;
+    if ((size_t)n < sizeof(small)) return write((const uint8_t*)small, (size_t)n);
+
+    std::string big((size_t)n + 1, '\0');
+    va_start(ap, fmt);
+    vsnprintf(&big[0], big.size(), fmt, ap);
+    va_end(ap);
+    return write((const uint8_t*)big.data(), (size_t)n);
+  }
+};
+
+class Stream : public Print {
+public:
+  virtual int available() = 0;
+  virtual int read() = 0;
+  virtual int peek() = 0;
+  size_t readBytes(char* buf, size_t n) {
+    size_t done = 0;
+    for (int c; done < n && (c = read()) >= 0;) buf[done++] = (char)c;
+    return done;
+  }
+  size_t readBytes(uint8_t* buf, size_t n) { return readBytes((char*)buf, n); }
+};
+
+class HostSerial : public Stream {
+public:
+  void begin(unsigned long) {}
+  size_t write(uint8_t c) override { return fputc(c, stdout) == EOF ? 0 : 1; }
+  size_t write(const uint8_t* buf, size_t n) override { return fwrite(buf, 1, n, stdout); }
+  int available() override { return 0; }
+  int read() override { return -1; }
+  int peek() override { return -1; }
+  using Print::write;
+};
+extern HostSerial Serial;
+
+class String : public std::string {
+public:
+  String() = default;
+  String(const char* s) : std::string(s ? s : "") {}
+  String(const std::string& s) : std::string(s) {}
+};
+
+uint32_t millis();
+void delay(uint32_t ms);
+int64_t esp_timer_get_time();
+uint32_t esp_random();
@@ -0,0 +1,91 @@
+#pragma once
+
+// Host stand-in for the Arduino-ESP32 file system API: each fs::FS is a
+// directory on the workstation (see HostFS), each File a stdio stream.
+
+#include <memory>
+#include <string>
+
+#include "Arduino.h"
+
+#define FILE_READ   "r"
+#define FILE_WRITE  "w"
+#define FILE_APPEND "a"
+
+namespace fs {
+
+class File : public Stream {
+public:
+  File() = default;
+  explicit File(FILE* f) : _f(f, fclose) {}
+
+  explicit operator bool() const { return (bool)_f; }
+
+  size_t write(uint8_t c) override { return _f && fputc(c, _f.get()) != EOF ? 1 : 0; }
+  size_t write(const uint8_t* buf, size_t n) override { return _f ? fwrite(buf, 1, n, _f.get()) : 0; }
+  using Print::write;
+
+  int available() override {
+    if (!_f) return 0;
+    const long left = (long)size() - ftell(_f.get());
+    return left > 0 ? (int)left : 0;
+  }
+  int read() override { return _f ? fgetc(_f.get()) : -1; }
+  int peek() override {
+    if (!_f) return -1;
+    const int c = fgetc(_f.get());
+    if (c != EOF) ungetc(c, _f.get());
+    return c;
+  }
+  size_t read(uint8_t* buf, size_t n) { return _f ? fread(buf, 1, n, _f.get()) : 0; }
+
+  bool seek(uint32_t pos) { return _f && fseek(_f.get(), (long)pos, SEEK_SET) == 0; }
+  size_t position() const { return _f ? (size_t)ftell(_f.get()) : 0; }
+  size_t size() const {
+    if (!_f) return 0;
+    const long pos = ftell(_f.get());
+    fseek(_f.get(), 0, SEEK_END);
+    const long end = ftell(_f.get());
+    fseek(_f.get(), pos, SEEK_SET);
+    return end > 0 ? (size_t)end : 0;
+  }
+  void flush() { if (_f) fflush(_f.get()); }
+  void close() { _f.reset(); }
+
+private:
+  std::shared_ptr<FILE> _f;
+};
+
+class FS {
+public:
+  virtual ~FS() = default;
+  virtual File open(const char* path, const char* mode = FILE_READ, bool create = false) = 0;
+  virtual bool exists(const char* path) = 0;
+  virtual bool remove(const char* path) = 0;
+  virtual bool mkdir(const char* path) = 0;
+};
+
+} // namespace fs
+
+using fs::File;
+
+// A mount point backed by a host directory, created on first use. Tools
+// point it elsewhere with setRoot() before the tracker touches it.
+class HostFS : public fs::FS {
+public:
+  explicit HostFS(const char* root) : _root(root) {}
+
+  bool begin(...) { return true; }
+  void end() {}
+  void setRoot(const std::string& root) { _root = root; }
+  const std::string& root() const { return _root; }
+
+  fs::File open(const char* path, const char* mode = FILE_READ, bool create = false) override;
+  bool exists(const char* path) override;
+  bool remove(const char* path) override;
+  bool mkdir(const char* path) override;
+
+private:
+  std::string Path(const char* path);
+  std::string _root;
+};
@@ -0,0 +1,132 @@
+// Implementations behind the host shim headers.
+
+#include "Arduino.h"
+#include "FS.h"
+#include "SD.h"
+#include "SPIFFS.h"
+#include "WiFi.h"
+#include "NimBLEDevice.h"
+#include "freertos/task.h"
+
+#include <chrono>
+#include <condition_variable>
+#include <filesystem>
+#include <random>
+#include <thread>
+
+// ----------------------------- Arduino core -----------------------------
+
+HostSerial Serial;
+HostWiFi WiFi;
+
+static const auto g_boot = std::chrono::steady_clock::now();
+
+int64_t esp_timer_get_time() {
+  return std::chrono::duration_cast<std::chrono::microseconds>(std::chrono::steady_clock::now() - g_boot).count();
+}
+
+uint32_t millis() {
+  return (uint32_t)(esp_timer_get_time() / 1000);
+}
+
+uint32_t esp_random() {
+  static std::random_device rd;
+  return rd();
+}
+
+void delay(uint32_t ms) {
+  std::this_thread::sleep_for(std::chrono::milliseconds(ms));
+}
+
+// ----------------------------- File systems -----------------------------
+
+HostFS SD("host_fs/sd");
+HostFS SPIFFS("host_fs/spiffs");
+
+std::string HostFS::Path(const char* path) {
+  std::filesystem::create_directories(_root);
+  return _root + (path[0] == '/' ? "" : "/") + path;
+}
+
+fs::File HostFS::open(const char* path, const char* mode, bool) {
+  // Arduino's "r" / "w" / "a" / "r+" / "w+" map straight onto stdio.
+  std::string m = mode;
+  if (m.find('b') == std::string::npos) m += 'b';
+  FILE* f = fopen(Path(path).c_str(), m.c_str());
+  return f ? fs::File(f) : fs::File();
+}
+
+bool HostFS::exists(const char* path) {
+  return std::filesystem::exists(Path(path));
+}
+
+bool HostFS::remove(const char* path) {
+  return std::filesystem::remove(Path(path));
+}
+
+bool HostFS::mkdir(const char* path) {
+  std::error_code ec;
+  std::filesystem::create_directories(Path(path), ec);
+  return !ec;
+}
+
+// ----------------------------- FreeRTOS -----------------------------
+
+struct HostTask {
+  std::mutex m;
+  std::condition_variable cv;
+  uint32_t notify = 0;
+};
+
+static thread_local HostTask* t_current = nullptr;
+
+TaskHandle_t xTaskCreateStaticPinnedToCore(TaskFunction_t fn, const char*, uint32_t, void* arg,
+                                           UBaseType_t, StackType_t*, StaticTask_t*, BaseType_t) {
+  HostTask* task = new HostTask(); // lives as long as the thread, i.e. forever
+  std::thread([task, fn, arg] {
+    t_current = task;
+    fn(arg);
+  }).detach();
+  return task;
+}
+
+void vTaskDelay(TickType_t ticks) {
+  std::this_thread::sleep_for(std::chrono::milliseconds(ticks));
+}
+
+TickType_t xTaskGetTickCount() {
+  return (TickType_t)millis();
+}
+
+uint32_t ulTaskNotifyTake(BaseType_t clear_on_exit, TickType_t ticks) {
+  HostTask* task = t_current;
+  if (!task) {
+    vTaskDelay(ticks);
+    return 0;
+  }
+  std::unique_lock<std::mutex> lk(task->m);
+  task->cv.wait_for(lk, std::chrono::milliseconds(ticks), [task] { return task->notify > 0; });
+  const uint32_t v = task->notify;
+  if (v > 0) task->notify = clear_on_exit ? 0 : v - 1;
+  return v;
+}
+
+void xTaskNotifyGive(TaskHandle_t task) {
+  {
+    std::lock_guard<std::mutex> lk(task->m);
+    task->notify++;
+  }
+  task->cv.notify_one();
+}
+
+void vTaskNotifyGiveFromISR(TaskHandle_t task, BaseType_t* woken) {
+  xTaskNotifyGive(task);
+  if (woken) *woken = pdFALSE;
+}
+
+// ----------------------------- NimBLE -----------------------------
+
+NimBLEScan* NimBLEDevice::getScan() {
+  static NimBLEScan scan;
+  return &scan;
+}
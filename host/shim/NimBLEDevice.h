@@ -0,0 +1,79 @@
+#pragma once
+
+// Host stand-in for NimBLE-Arduino. NimBLEAdvertisedDevice holds an address,
+// RSSI and raw advertising payload; the classifiers parse that payload
+// themselves (BleAdvert.h), so they run unchanged on captured or synthetic
+// adverts. The scanner itself never reports anything.
+
+#include <cstdint>
+#include <string>
+#include <vector>
+
+#include "Arduino.h"
+
+#define ESP_PWR_LVL_P9 9
+
+typedef struct {
+  uint8_t type;
+  uint8_t val[6]; // little-endian, as on air
+} ble_addr_t;
+
+class NimBLEAddress {
+public:
+  NimBLEAddress() = default;
+  explicit NimBLEAddress(const ble_addr_t& a) : _a(a) {}
+  const ble_addr_t* getBase() const { return &_a; }
+
+private:
+  ble_addr_t _a{};
+};
+
+class NimBLEAdvertisedDevice {
+public:
+  NimBLEAdvertisedDevice() = default;
+  NimBLEAdvertisedDevice(const ble_addr_t& addr, int rssi, const uint8_t* payload, size_t len, uint8_t adv_type = 0)
+      : _addr(addr), _rssi(rssi), _adv_type(adv_type), _payload(payload, payload + len) {}
+
+  NimBLEAddress getAddress() const { return _addr; }
+  int getRSSI() const { return _rssi; }
+  uint8_t getAdvType() const { return _adv_type; } // HCI report event type, 0 = ADV_IND
+  const std::vector<uint8_t>& getPayload() const { return _payload; }
+
+private:
+  NimBLEAddress _addr;
+  int _rssi = 0;
+  uint8_t _adv_type = 0;
+  std::vector<uint8_t> _payload;
+};
+
+class NimBLEScanCallbacks {
+public:
+  virtual ~NimBLEScanCallbacks() = default;
+  virtual void onResult(const NimBLEAdvertisedDevice* dev) { (void)dev; }
+};
+
+class NimBLEScan {
+public:
+  void setScanCallbacks(NimBLEScanCallbacks* cb, bool = false) { _cb = cb; }
+  void setActiveScan(bool) {}
+  void setInterval(uint16_t) {}
+  void setWindow(uint16_t) {}
+  void setMaxResults(uint8_t) {}
+  void setDuplicateFilter(uint8_t) {}
+  bool start(uint32_t, bool = false, bool = true) { return true; }
+  bool stop() { return true; }
+
+  // Host only: delivers dev to the registered callbacks as a scan would.
+  void inject(const NimBLEAdvertisedDevice& dev) { if (_cb) _cb->onResult(&dev); }
+
+private:
+  NimBLEScanCallbacks* _cb = nullptr;
+};
+
+class NimBLEDevice {
+public:
+  static bool init(const std::string&) { return true; }
+  static bool deinit(bool = false) { return true; }
+  static bool setPower(int) { return true; }
+  static NimBLEScan* getScan();
+};
@@ -0,0 +1,5 @@
+#pragma once
+
+#include "FS.h"
+
+extern HostFS SD; // ./host_fs/sd unless setRoot() says otherwise
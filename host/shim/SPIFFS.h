@@ -0,0 +1,5 @@
+#pragma once
+
+#include "FS.h"
+
+extern HostFS SPIFFS; // ./host_fs/spiffs unless setRoot() says otherwise
@@ -0,0 +1,25 @@
+#pragma once
+
+// Host stand-in for the Arduino WiFi scanner: there is no radio, so a scan
+// never finds anything.
+
+#include "Arduino.h"
+#include "esp_wifi.h"
+
+typedef int WiFiEvent_t;
+typedef struct { int unused; } WiFiEventInfo_t;
+#define ARDUINO_EVENT_WIFI_SCAN_DONE 1
+
+class HostWiFi {
+public:
+  int16_t scanNetworks(bool = false, bool = false) { return 0; }
+  int16_t scanComplete() { return 0; }
+  void scanDelete() {}
+  String SSID(int) { return String(); }
+  String BSSIDstr(int) { return String("00:00:00:00:00:00"); }
+  const uint8_t* BSSID(int) { static const uint8_t zero[6] = {}; return zero; }
+  int32_t RSSI(int) { return 0; }
+  int32_t channel(int) { return 0; }
+  void onEvent(void (*)(WiFiEvent_t, WiFiEventInfo_t)) {}
+};
+extern HostWiFi WiFi;
@@ -0,0 +1,62 @@
+#pragma once
+
+// Host stand-in for the ESP-IDF Wi-Fi driver: the promiscuous-mode types the
+// sniffer callback reads, and driver calls that do nothing. A host tool can
+// build a wifi_promiscuous_pkt_t around a captured frame.
+
+#include <cstdint>
+
+typedef int esp_err_t;
+#define ESP_OK 0
+
+typedef enum {
+  WIFI_PKT_MGMT,
+  WIFI_PKT_CTRL,
+  WIFI_PKT_DATA,
+  WIFI_PKT_MISC,
+} wifi_promiscuous_pkt_type_t;
+
+typedef struct {
+  signed   rssi : 8;
+  unsigned rate : 5;
+  unsigned : 1;
+  unsigned sig_mode : 2;
+  unsigned : 16;
+  unsigned channel : 4;
+  unsigned : 12;
+  unsigned sig_len : 12;
+  unsigned : 20;
+  uint32_t timestamp;
+} wifi_pkt_rx_ctrl_t;
+
+typedef struct {
+  wifi_pkt_rx_ctrl_t rx_ctrl;
+  uint8_t payload[0];
+} wifi_promiscuous_pkt_t;
+
+typedef struct {
+  uint32_t filter_mask;
+} wifi_promiscuous_filter_t;
+
+#define WIFI_PROMIS_FILTER_MASK_MGMT (1 << 0)
+
+typedef struct { int unused; } wifi_init_config_t;
+#define WIFI_INIT_CONFIG_DEFAULT() {0}
+
+typedef enum { WIFI_MODE_NULL, WIFI_MODE_STA, WIFI_MODE_AP, WIFI_MODE_APSTA } wifi_mode_t;
+typedef enum { WIFI_PS_NONE, WIFI_PS_MIN_MODEM, WIFI_PS_MAX_MODEM } wifi_ps_type_t;
+typedef enum { WIFI_SECOND_CHAN_NONE, WIFI_SECOND_CHAN_ABOVE, WIFI_SECOND_CHAN_BELOW } wifi_second_chan_t;
+
+typedef void (*wifi_promiscuous_cb_t)(void* buf, wifi_promiscuous_pkt_type_t type);
+
+inline esp_err_t esp_netif_init() { return ESP_OK; }
+inline esp_err_t esp_event_loop_create_default() { return ESP_OK; }
+inline void*     esp_netif_create_default_wifi_sta() { return nullptr; }
+inline esp_err_t esp_wifi_init(const wifi_init_config_t*) { return ESP_OK; }
+inline esp_err_t esp_wifi_set_mode(wifi_mode_t) { return ESP_OK; }
+inline esp_err_t esp_wifi_start() { return ESP_OK; }
+inline esp_err_t esp_wifi_set_ps(wifi_ps_type_t) { return ESP_OK; }
+inline esp_err_t esp_wifi_set_promiscuous_filter(const wifi_promiscuous_filter_t*) { return ESP_OK; }
+inline esp_err_t esp_wifi_set_promiscuous_rx_cb(wifi_promiscuous_cb_t) { return ESP_OK; }
+inline esp_err_t esp_wifi_set_promiscuous(bool) { return ESP_OK; }
+inline esp_err_t esp_wifi_set_channel(uint8_t, wifi_second_chan_t) { return ESP_OK; }
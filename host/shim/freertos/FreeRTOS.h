@@ -0,0 +1,35 @@
+#pragma once
+
+// Host stand-in for the FreeRTOS/ESP-IDF primitives the tracker uses.
+// portMUX critical sections become a recursive mutex (no interrupts to mask
+// on a workstation); tasks are std::threads with a notification counter.
+// Ticks are milliseconds. Implemented in HostHal.cpp.
+
+#include <cstdint>
+#include <mutex>
+
+typedef int32_t  BaseType_t;
+typedef uint32_t UBaseType_t;
+typedef uint32_t TickType_t;
+typedef uint8_t  StackType_t;
+typedef struct { int unused; } StaticTask_t;
+typedef struct HostTask* TaskHandle_t;
+
+#define pdTRUE  1
+#define pdFALSE 0
+#define pdPASS  1
+#define pdMS_TO_TICKS(ms) ((TickType_t)(ms))
+#define portMAX_DELAY     ((TickType_t)0xFFFFFFFFu)
+#define portTICK_PERIOD_MS 1
+
+struct portMUX_TYPE {
+  std::recursive_mutex m;
+};
+#define portMUX_INITIALIZER_UNLOCKED {}
+
+inline void portENTER_CRITICAL(portMUX_TYPE* mux) { mux->m.lock(); }
+inline void portEXIT_CRITICAL(portMUX_TYPE* mux) { mux->m.unlock(); }
+#define portENTER_CRITICAL_ISR(mux)  portENTER_CRITICAL(mux)
+#define portEXIT_CRITICAL_ISR(mux)   portEXIT_CRITICAL(mux)
+#define portENTER_CRITICAL_SAFE(mux) portENTER_CRITICAL(mux)
+#define portEXIT_CRITICAL_SAFE(mux)  portEXIT_CRITICAL(mux)
@@ -0,0 +1,18 @@
+#pragma once
+
+#include "FreeRTOS.h"
+
+typedef void (*TaskFunction_t)(void*);
+
+// Runs fn on a detached std::thread; the stack, priority and core are ignored.
+TaskHandle_t xTaskCreateStaticPinnedToCore(TaskFunction_t fn, const char* name, uint32_t stack_depth,
+                                           void* arg, UBaseType_t priority, StackType_t* stack,
+                                           StaticTask_t* tcb, BaseType_t core);
+
+void       vTaskDelay(TickType_t ticks);
+TickType_t xTaskGetTickCount();
+
+uint32_t ulTaskNotifyTake(BaseType_t clear_on_exit, TickType_t ticks);
+void     xTaskNotifyGive(TaskHandle_t task);
+void     vTaskNotifyGiveFromISR(TaskHandle_t task, BaseType_t* woken);
+#define portYIELD_FROM_ISR(...) ((void)0)
@@ -0,0 +1,427 @@
+// Host tool: a working day in virtual time, for ranking regression checks.
+//
+// Segment advancement, idle expiry and score persistence only play out over
+// hours. This drives the tracker core through an 8-hour commute (home, walk,
+// platform, train, office, lunch, office, the way back) on a virtual clock
+// (DeviceTracker::setClock), so the whole day runs in seconds, and every
+// --tick seconds takes the ranked snapshot.
+//
+// Each scene has its own radio surroundings:
+//   APs        --aps in range; fixed for a place, turning over while moving
+//   crowd      passers-by with rotating Wi-Fi/BLE addresses who stay in
+//              range for the scene's dwell time
+//   fixtures   BLE devices with fixed addresses that belong to a place
+//              (TVs, speakers, desk phones); the office's are there again
+//              after lunch
+//   followers  --followers trackers that travel with the carrier all day
+// RSSI, probe rate and scan duty match sim_crowd.
+//
+// The run is deterministic for a given seed and build. --record writes the
+// top --top of every tick as CSV; --check replays and compares against such
+// a file (same kind and address at each rank, score within --tolerance) and
+// exits 1 on any difference, so a change to scoring or expiry shows up as
+// a diff against a recorded day.
+//
+//   cmake -S host -B build-host && cmake --build build-host -j
+//   build-host/sim_commute [--tick 60] [--top 10] [--followers 1] [--capacity 256,128]
+//                          [--seed 1] [--record day.csv | --check day.csv [--tolerance 0.5]]
+
+#include "DeviceTracker.h"
+#include "Journal.h"
+#include "VirtualClock.h"
+
+#include <array>
+#include <chrono>
+#include <cmath>
+#include <cstdio>
+#include <cstdlib>
+#include <cstring>
+#include <map>
+#include <random>
+#include <string>
+#include <vector>
+
+static constexpr float PATH_LOSS_N = 2.7f;
+static constexpr float SHADOW_DB = 5.0f;
+static constexpr float TX_AP_DBM = -35.0f;    // at 1 m
+static constexpr float TX_PHONE_DBM = -42.0f;
+static constexpr float TX_BLE_DBM = -59.0f;
+static constexpr int   WIFI_FLOOR_DBM = -95;
+static constexpr int   BLE_FLOOR_DBM = -98;
+
+static constexpr float HOP_DUTY = 1.0f / 11.0f;
+static constexpr float BLE_DUTY = 15.0f / 45.0f;
+static constexpr float PROBE_MEAN_S = 45.0f;
+static constexpr uint32_t ROTATE_S = 900;
+
+static constexpr double LAT0 = 52.5200, LON0 = 13.4050;
+
+// place: scenes with the same place share APs and fixtures; -1 is nowhere
+// in particular (the street, the train), where APs turn over.
+struct Scene {
+  const char* name;
+  int   minutes;
+  float move_m;      // eastward displacement over the scene
+  int   place;
+  int   aps;
+  int   ap_dwell_s;  // 0: fixed
+  int   crowd;
+  int   crowd_dwell_s;
+  int   fixtures;
+  float radius_m;    // how far away the crowd and APs are
+};
+
+static const Scene DAY[] = {
+  {"home",      45,      0, 0, 14,  0,  2, 3600,  6, 25},
+  {"walk",      12,   1000,-1, 20, 45, 15,   60,  0, 60},
+  {"platform",   8,      0, 1,  6,  0, 50,  300,  0, 40},
+  {"train",     35,  29000,-1,  3, 20, 70,  900,  0, 30},
+  {"walk",      10,    800,-1, 20, 45, 15,   60,  0, 60},
+  {"office",   150,      0, 2, 30,  0, 25, 5400, 12, 40},
+  {"walk",       8,    600,-1, 20, 45, 15,   60,  0, 60},
+  {"cafe",      30,      0, 3, 10,  0, 20, 1200,  3, 20},
+  {"walk",       8,   -600,-1, 20, 45, 15,   60,  0, 60},
+  {"office",   120,      0, 2, 30,  0, 25, 5400, 12, 40},
+  {"walk",      10,   -800,-1, 20, 45, 15,   60,  0, 60},
+  {"platform",   6,      0, 4,  6,  0, 50,  300,  0, 40},
+  {"train",     35, -29000,-1,  3, 20, 70,  900,  0, 30},
+  {"walk",       3,   -500,-1, 20, 45, 15,   60,  0, 60},
+};
+
+struct Config {
+  uint32_t tick_s = 60;
+  int top = 10;
+  int followers = 1;
+  int tracks = 256, anchors = 128;
+  uint32_t seed = 1;
+  const char* record = nullptr;
+  const char* check = nullptr;
+  float tolerance = 0.5f;
+};
+
+struct Radio {
+  float d;           // metres from the carrier
+  uint8_t addr[6];
+  uint8_t ble[6];
+  uint8_t ssid[32];
+  uint8_t ssid_len;
+  uint32_t next_rotate, next_probe;
+};
+
+struct Place {
+  std::vector<Radio> aps, fixtures;
+};
+
+class Commute {
+public:
+  Commute(const Config& cfg) : _rng(cfg.seed) {
+    _followers.resize((size_t)cfg.followers);
+    for (auto& f : _followers) RandomMac(f.data(), 0xC0);
+  }
+
+  const std::vector<std::array<uint8_t, 6>>& Followers() const { return _followers; }
+
+  // Sets up the surroundings for s, starting at t.
+  void Enter(const Scene& s, uint32_t t) {
+    _scene = &s;
+    _start_x = _x;
+    _start_t = t;
+    _crowd.resize((size_t)s.crowd);
+    for (Radio& p : _crowd) Spawn(p, t);
+    if (s.place < 0) {
+      _aps.resize((size_t)s.aps);
+      for (Radio& a : _aps) NewAp(a);
+      _fixtures.clear();
+      return;
+    }
+    Place& pl = _places[s.place];
+    if (pl.aps.empty()) {
+      pl.aps.resize((size_t)s.aps);
+      for (Radio& a : pl.aps) NewAp(a);
+      pl.fixtures.resize((size_t)s.fixtures);
+      for (Radio& f : pl.fixtures) {
+        f.d = Distance(s.radius_m);
+        RandomMac(f.ble, 0xC0);
+      }
+    }
+    _aps = pl.aps;
+    _fixtures = pl.fixtures;
+  }
+
+  void Fix(uint32_t t, double& lat, double& lon) {
+    const float span = (float)_scene->minutes * 60.0f;
+    _x = _start_x + _scene->move_m * std::min(1.0f, (float)(t - _start_t) / span);
+    lat = LAT0;
+    lon = LON0 + _x / (111320.0 * cos(LAT0 * M_PI / 180.0));
+  }
+
+  // Everything heard during second t.
+  void Step(uint32_t t, std::vector<JournalObservation>& out) {
+    const Scene& s = *_scene;
+    out.clear();
+
+    for (Radio& a : _aps) {
+      if (s.ap_dwell_s > 0 && Chance(1.0f / (float)s.ap_dwell_s)) NewAp(a);
+      for (int k = Binomial(10, HOP_DUTY); k > 0; --k) {
+        const int rssi = Rssi(TX_AP_DBM, a.d);
+        if (rssi < WIFI_FLOOR_DBM) continue;
+        JournalObservation& o = Emit(out, 2 /* beacon */, a.addr, rssi, t);
+        o.ssid_len = a.ssid_len;
+        memcpy(o.ssid, a.ssid, a.ssid_len);
+      }
+    }
+
+    for (Radio& p : _crowd) {
+      if (Chance(1.0f / (float)s.crowd_dwell_s)) Spawn(p, t);
+      if (t >= p.next_rotate) {
+        RandomMac(p.addr, 0x02);
+        RandomMac(p.ble, 0x40);
+        p.next_rotate = t + ROTATE_S;
+      }
+      if (t >= p.next_probe) {
+        const int rssi = Rssi(TX_PHONE_DBM, p.d);
+        if (rssi >= WIFI_FLOOR_DBM) Emit(out, 1 /* probe_req */, p.addr, rssi, t);
+        p.next_probe = t + 1 + (uint32_t)Exp(PROBE_MEAN_S);
+      }
+      for (int k = Binomial(2, BLE_DUTY); k > 0; --k) {
+        const int rssi = Rssi(TX_BLE_DBM, p.d);
+        if (rssi >= BLE_FLOOR_DBM) Emit(out, 4 /* ble_adv */, p.ble, rssi, t);
+      }
+    }
+
+    for (const Radio& f : _fixtures) {
+      if (!Binomial(1, BLE_DUTY)) continue;
+      const int rssi = Rssi(TX_BLE_DBM, f.d);
+      if (rssi >= BLE_FLOOR_DBM) Emit(out, 4, f.ble, rssi, t);
+    }
+
+    for (const auto& f : _followers) {
+      if (!Binomial(1, 0.5f * BLE_DUTY)) continue;
+      const int rssi = Rssi(TX_BLE_DBM, 1.5f); // in a bag or pocket
+      if (rssi >= BLE_FLOOR_DBM) {
+        JournalObservation& o = Emit(out, 4, f.data(), rssi, t);
+        o.tracker_type = TrackerType::AppleAirTag;
+        o.tracker_confidence = 90;
+      }
+    }
+  }
+
+private:
+  void Spawn(Radio& p, uint32_t t) {
+    p.d = Distance(_scene->radius_m);
+    RandomMac(p.addr, 0x02);
+    RandomMac(p.ble, 0x40);
+    p.next_rotate = t + 1 + (uint32_t)(_rng() % ROTATE_S);
+    p.next_probe = t + (uint32_t)Exp(PROBE_MEAN_S);
+  }
+
+  void NewAp(Radio& a) {
+    a.d = Distance(_scene->radius_m * 2.0f);
+    RandomMac(a.addr, 0x00);
+    a.ssid_len = (uint8_t)snprintf((char*)a.ssid, sizeof(a.ssid), "net-%05u", _next_ssid++);
+  }
+
+  // Uniform over a disc of radius r.
+  float Distance(float r) { return std::max(1.0f, r * sqrtf(std::uniform_real_distribution<float>(0, 1)(_rng))); }
+
+  void RandomMac(uint8_t* out, uint8_t prefix) {
+    for (int i = 0; i < 6; ++i) out[i] = (uint8_t)_rng();
+    if (prefix == 0x00) out[0] &= 0xFC;
+    else if (prefix == 0x02) out[0] = (uint8_t)((out[0] & 0xFC) | 0x02);
+    else out[0] = (uint8_t)((out[0] & 0x3F) | prefix);
+  }
+
+  int Rssi(float tx, float d) {
+    std::normal_distribution<float> shadow(0.0f, SHADOW_DB);
+    return (int)lroundf(tx - 10.0f * PATH_LOSS_N * log10f(std::max(1.0f, d)) + shadow(_rng));
+  }
+
+  bool Chance(float p) { return std::uniform_real_distribution<float>(0, 1)(_rng) < p; }
+  int Binomial(int n, float p) { return std::binomial_distribution<int>(n, p)(_rng); }
+  float Exp(float mean) { return std::exponential_distribution<float>(1.0f / mean)(_rng); }
+
+  static JournalObservation& Emit(std::vector<JournalObservation>& out, uint8_t kind, const uint8_t* addr,
+                                  int rssi, uint32_t t) {
+    out.emplace_back();
+    JournalObservation& o = out.back();
+    o.kind = kind;
+    o.rssi_dbm = (int8_t)std::max(-128, std::min(rssi, 0));
+    memcpy(o.addr, addr, 6);
+    o.ts_s = t;
+    return o;
+  }
+
+  std::mt19937 _rng;
+  const Scene* _scene = nullptr;
+  float _x = 0.0f, _start_x = 0.0f;
+  uint32_t _start_t = 0;
+  unsigned _next_ssid = 0;
+  std::map<int, Place> _places;
+  std::vector<Radio> _aps, _crowd, _fixtures;
+  std::vector<std::array<uint8_t, 6>> _followers;
+};
+
+// One row of a per-tick ranking.
+struct Row {
+  uint32_t t;
+  int rank;
+  std::string kind, addr;
+  float score;
+};
+
+static const char* entity_kind_name(EntityKind k) {
+  switch (k) {
+    case EntityKind::WifiClient: return "wifi";
+    case EntityKind::BleAdv: return "ble";
+    case EntityKind::WifiAp: return "ap";
+  }
+  return "?";
+}
+
+static std::string mac_str(const uint8_t* a) {
+  char s[18];
+  snprintf(s, sizeof(s), "%02x:%02x:%02x:%02x:%02x:%02x", a[0], a[1], a[2], a[3], a[4], a[5]);
+  return s;
+}
+
+static bool load_rows(const char* path, std::vector<Row>& rows) {
+  FILE* f = fopen(path, "r");
+  if (!f) {
+    perror(path);
+    return false;
+  }
+  char line[256], scene[32], kind[8], addr[18];
+  while (fgets(line, sizeof(line), f)) {
+    Row r;
+    if (sscanf(line, "%u,%31[^,],%d,%7[^,],%17[^,],%f", &r.t, scene, &r.rank, kind, addr, &r.score) != 6) continue;
+    r.kind = kind;
+    r.addr = addr;
+    rows.push_back(r);
+  }
+  fclose(f);
+  return true;
+}
+
+static bool parse_args(int argc, char** argv, Config& cfg) {
+  for (int i = 1; i < argc; ++i) {
+    const char* a = argv[i];
+    const char* v = (i + 1 < argc) ? argv[i + 1] : nullptr;
+    if (!v) return false;
+    if (strcmp(a, "--tick") == 0) cfg.tick_s = (uint32_t)atoi(v);
+    else if (strcmp(a, "--top") == 0) cfg.top = atoi(v);
+    else if (strcmp(a, "--followers") == 0) cfg.followers = atoi(v);
+    else if (strcmp(a, "--capacity") == 0) sscanf(v, "%d,%d", &cfg.tracks, &cfg.anchors);
+    else if (strcmp(a, "--seed") == 0) cfg.seed = (uint32_t)strtoul(v, nullptr, 10);
+    else if (strcmp(a, "--record") == 0) cfg.record = v;
+    else if (strcmp(a, "--check") == 0) cfg.check = v;
+    else if (strcmp(a, "--tolerance") == 0) cfg.tolerance = (float)atof(v);
+    else return false;
+    ++i;
+  }
+  return cfg.tick_s > 0 && cfg.top > 0 && !(cfg.record && cfg.check);
+}
+
+int main(int argc, char** argv) {
+  Config cfg;
+  if (!parse_args(argc, argv, cfg)) {
+    fprintf(stderr, "usage: %s [--tick S] [--top N] [--followers N] [--capacity TRACKS,ANCHORS] [--seed N]\n"
+                    "          [--record FILE | --check FILE [--tolerance SCORE]]\n", argv[0]);
+    return 2;
+  }
+
+  std::vector<Row> golden;
+  if (cfg.check && !load_rows(cfg.check, golden)) return 1;
+  FILE* rec = nullptr;
+  if (cfg.record && !(rec = fopen(cfg.record, "w"))) {
+    perror(cfg.record);
+    return 1;
+  }
+  if (rec) fprintf(rec, "t_s,scene,rank,kind,addr,score,seen_windows,near_windows,env_hits\n");
+
+  static DeviceTracker tracker;
+  tracker.setCapacity(cfg.tracks, cfg.anchors);
+  tracker.setClock(VirtualClock::Now);
+  if (!tracker.beginCore()) return 1;
+
+  Commute day(cfg);
+  std::vector<JournalObservation> batch;
+  std::vector<EntityView> views((size_t)cfg.top);
+  std::vector<Row> rows;
+  uint64_t obs = 0;
+  const auto t0 = std::chrono::steady_clock::now();
+
+  // Rank of each follower at the last tick of every scene.
+  printf("%-9s %5s %7s %5s %6s  follower ranks\n", "scene", "end", "segment", "moves", "ranked");
+
+  uint32_t t = 0;
+  for (const Scene& s : DAY) {
+    day.Enter(s, t + 1);
+    const uint32_t end = t + (uint32_t)s.minutes * 60;
+    while (t < end) {
+      ++t;
+      double lat, lon;
+      day.Fix(t, lat, lon);
+      day.Step(t, batch);
+      VirtualClock::SetSeconds(t);
+      tracker.setGpsFix(true, lat, lon);
+      tracker.ingest(batch.data(), (int)batch.size());
+      obs += batch.size();
+      if (t % cfg.tick_s != 0 && t != end) continue;
+
+      tracker.publishSnapshot();
+      int total = 0;
+      const int n = tracker.topK(views.data(), 0, cfg.top, &total);
+      for (int r = 0; r < n; ++r) {
+        const EntityView& v = views[(size_t)r];
+        rows.push_back({t, r + 1, entity_kind_name(v.kind), mac_str(v.addr), v.score});
+        if (rec) {
+          fprintf(rec, "%u,%s,%d,%s,%s,%.2f,%u,%u,%u\n", t, s.name, r + 1, entity_kind_name(v.kind),
+                  mac_str(v.addr).c_str(), v.score, v.seen_windows, v.near_windows, v.env_hits);
+        }
+      }
+
+      if (t == end) {
+        printf("%-9s %5.1fh %7u %5u %6d ", s.name, t / 3600.0, tracker.segmentId(), tracker.moveSegments(), total);
+        for (const auto& f : day.Followers()) {
+          int rank = 0;
+          for (int r = 0; r < n && !rank; ++r) {
+            if (memcmp(views[(size_t)r].addr, f.data(), 6) == 0) rank = r + 1;
+          }
+          if (rank) printf(" %d", rank);
+          else printf(" >%d", cfg.top);
+        }
+        printf("\n");
+      }
+    }
+  }
+  if (rec) fclose(rec);
+
+  const double secs = std::chrono::duration<double>(std::chrono::steady_clock::now() - t0).count();
+  const TableStats ts = tracker.tableStats();
+  printf("%.1f h in %.2f s (%.0fx), %llu observations; evictions %u/%u, expiries %u/%u\n", t / 3600.0, secs,
+         secs > 0 ? t / secs : 0.0, (unsigned long long)obs, ts.track_evictions, ts.anchor_evictions,
+         ts.track_expiries, ts.anchor_expiries);
+  if (rec) printf("recorded %zu rows to %s\n", rows.size(), cfg.record);
+  if (!cfg.check) return 0;
+
+  // Compare tick by tick, rank by rank.
+  size_t diffs = 0;
+  const size_t n = std::min(rows.size(), golden.size());
+  for (size_t i = 0; i < n; ++i) {
+    const Row& a = golden[i];
+    const Row& b = rows[i];
+    const bool same = a.t == b.t && a.rank == b.rank && a.kind == b.kind && a.addr == b.addr &&
+                      fabsf(a.score - b.score) <= cfg.tolerance;
+    if (same) continue;
+    if (diffs++ < 10) {
+      printf("  t=%u rank %d: expected %s %s %.2f, got t=%u rank %d %s %s %.2f\n", a.t, a.rank, a.kind.c_str(),
+             a.addr.c_str(), a.score, b.t, b.rank, b.kind.c_str(), b.addr.c_str(), b.score);
+    }
+  }
+  if (rows.size() != golden.size()) {
+    printf("  %zu rows, expected %zu\n", rows.size(), golden.size());
+    diffs++;
+  }
+  printf("check against %s: %s (%zu differences)\n", cfg.check, diffs ? "FAILED" : "ok", diffs);
+  return diffs ? 1 : 0;
+}
@@ -0,0 +1,363 @@
+// Host tool: synthetic crowd driving the tracker core.
+//
+// Generates the observation stream a Pigtail would see while its carrier
+// walks a straight street, alternating MOVE_S of walking with DWELL_S
+// standing still, and feeds it to DeviceTracker::ingest() one pass per
+// virtual second, with a GPS fix each second.
+//
+//   APs        fixed along the street (--aps per 300x300 m), 10 beacons/s,
+//              heard on 1 channel of 11
+//   phones     --phones pedestrians kept within 150 m of the carrier; each
+//              walks at its own pace, probes every ~45 s and advertises BLE
+//              at 2/s; Wi-Fi and BLE addresses rotate every --rotate s. A
+//              pedestrian who drops out of range is replaced by a new one.
+//   trackers   --trackers of the pedestrians also carry a BLE tracker
+//              (fixed address, one advert per 2 s)
+//   followers  --followers trackers that travel with the carrier; what
+//              Pigtail is meant to surface
+// RSSI is log-distance path loss (exponent 2.7) plus 5 dB of shadowing;
+// the BLE scan hears a third of adverts (window 15 of 45).
+//
+// Runs as fast as it can, or at --speed times real time. A second whose
+// pass overran its wall-clock budget counts as an overrun; on the device
+// those observations would back up in the producer rings and be dropped.
+// Reports table churn every --report minutes, then throughput, drops,
+// evictions, the score distribution of ranked tracks and where the
+// followers ranked.
+//
+//   cmake -S host -B build-host && cmake --build build-host -j
+//   build-host/sim_crowd [--minutes 60] [--aps 40] [--phones 120] [--trackers 6]
+//                        [--followers 2] [--rotate 900] [--capacity 256,128]
+//                        [--speed 0] [--report 10] [--seed 1]
+
+#include "DeviceTracker.h"
+#include "Journal.h"
+#include "VirtualClock.h"
+
+#include <array>
+#include <chrono>
+#include <cmath>
+#include <cstdio>
+#include <cstdlib>
+#include <cstring>
+#include <random>
+#include <thread>
+#include <vector>
+
+static constexpr float BOX_M = 150.0f;   // pedestrians live within this of the carrier
+static constexpr float WALK_MPS = 1.4f;
+static constexpr uint32_t MOVE_S = 10 * 60;
+static constexpr uint32_t DWELL_S = 5 * 60;
+
+static constexpr float PATH_LOSS_N = 2.7f;
+static constexpr float SHADOW_DB = 5.0f;
+static constexpr float TX_AP_DBM = -35.0f;    // at 1 m
+static constexpr float TX_PHONE_DBM = -42.0f;
+static constexpr float TX_BLE_DBM = -59.0f;
+static constexpr int   WIFI_FLOOR_DBM = -95;
+static constexpr int   BLE_FLOOR_DBM = -98;
+
+static constexpr float HOP_DUTY = 1.0f / 11.0f; // sniffer sits on one channel of 11
+static constexpr float BLE_DUTY = 15.0f / 45.0f;
+static constexpr float PROBE_MEAN_S = 45.0f;
+
+static constexpr double LAT0 = 52.5200, LON0 = 13.4050;
+
+struct Config {
+  int minutes = 60;
+  int aps = 40;
+  int phones = 120;
+  int trackers = 6;
+  int followers = 2;
+  int rotate_s = 900;
+  int tracks = 256, anchors = 128;
+  float speed = 0.0f;
+  int report_min = 10;
+  uint32_t seed = 1;
+};
+
+struct Ap {
+  float x, y;
+  uint8_t addr[6];
+  uint8_t ssid[32];
+  uint8_t ssid_len;
+};
+
+struct Pedestrian {
+  float x, y, vx, vy;
+  uint8_t wifi[6], ble[6], tag[6];
+  uint32_t next_rotate, next_probe;
+  bool has_tag;
+};
+
+class World {
+public:
+  World(const Config& cfg) : _cfg(cfg), _rng(cfg.seed) {
+    // APs along the whole route, at the requested density.
+    const float route_m = WALK_MPS * (float)cfg.minutes * 60.0f;
+    const float area = (route_m + 2 * BOX_M) * (2 * BOX_M);
+    const int n = (int)lroundf((float)cfg.aps * area / (2 * BOX_M * 2 * BOX_M));
+    std::uniform_real_distribution<float> ux(-BOX_M, route_m + BOX_M), uy(-BOX_M, BOX_M);
+    _aps.resize((size_t)n);
+    for (size_t i = 0; i < _aps.size(); ++i) {
+      Ap& a = _aps[i];
+      a.x = ux(_rng);
+      a.y = uy(_rng);
+      RandomMac(a.addr, 0x00);
+      a.ssid_len = (uint8_t)snprintf((char*)a.ssid, sizeof(a.ssid), "net-%04zu", i);
+    }
+
+    _peds.resize((size_t)cfg.phones);
+    for (size_t i = 0; i < _peds.size(); ++i) Spawn(_peds[i], (int)i < cfg.trackers, 0, false);
+
+    _followers.resize((size_t)cfg.followers);
+    for (auto& f : _followers) RandomMac(f.data(), 0xC0);
+  }
+
+  size_t ApCount() const { return _aps.size(); }
+  const std::vector<std::array<uint8_t, 6>>& Followers() const { return _followers; }
+
+  // Carrier position at t: walks MOVE_S, stands DWELL_S, repeat.
+  float CarrierX(uint32_t t) const {
+    const uint32_t cycle = MOVE_S + DWELL_S;
+    const uint32_t moving = (t / cycle) * MOVE_S + std::min(t % cycle, MOVE_S);
+    return WALK_MPS * (float)moving;
+  }
+
+  void Fix(uint32_t t, double& lat, double& lon) const {
+    lat = LAT0;
+    lon = LON0 + CarrierX(t) / (111320.0 * cos(LAT0 * M_PI / 180.0));
+  }
+
+  // Everything heard during second t.
+  void Step(uint32_t t, std::vector<JournalObservation>& out) {
+    out.clear();
+    const float cx = CarrierX(t);
+
+    for (const Ap& a : _aps) {
+      if (fabsf(a.x - cx) > 2 * BOX_M) continue;
+      const int heard = Binomial(10, HOP_DUTY);
+      for (int k = 0; k < heard; ++k) {
+        const int rssi = Rssi(TX_AP_DBM, a.x - cx, a.y);
+        if (rssi < WIFI_FLOOR_DBM) continue;
+        JournalObservation& o = Emit(out, 2 /* beacon */, a.addr, rssi, t);
+        o.ssid_len = a.ssid_len;
+        memcpy(o.ssid, a.ssid, a.ssid_len);
+      }
+    }
+
+    for (Pedestrian& p : _peds) {
+      p.x += p.vx;
+      p.y += p.vy;
+      if (fabsf(p.x - cx) > BOX_M || fabsf(p.y) > BOX_M) {
+        Spawn(p, p.has_tag, t, true);
+        continue;
+      }
+      if (t >= p.next_rotate) {
+        RandomMac(p.wifi, 0x02);
+        RandomMac(p.ble, 0x40);
+        p.next_rotate = t + (uint32_t)_cfg.rotate_s;
+      }
+
+      if (t >= p.next_probe) {
+        // A burst sweeps every channel; the sniffer catches one or two frames.
+        const int heard = 1 + Binomial(1, 0.5f);
+        for (int k = 0; k < heard; ++k) {
+          const int rssi = Rssi(TX_PHONE_DBM, p.x - cx, p.y);
+          if (rssi >= WIFI_FLOOR_DBM) Emit(out, 1 /* probe_req */, p.wifi, rssi, t);
+        }
+        p.next_probe = t + 1 + (uint32_t)Exp(PROBE_MEAN_S);
+      }
+
+      for (int k = Binomial(2, BLE_DUTY); k > 0; --k) {
+        const int rssi = Rssi(TX_BLE_DBM, p.x - cx, p.y);
+        if (rssi >= BLE_FLOOR_DBM) Emit(out, 4 /* ble_adv */, p.ble, rssi, t);
+      }
+      if (p.has_tag && Binomial(1, 0.5f * BLE_DUTY)) {
+        const int rssi = Rssi(TX_BLE_DBM, p.x - cx, p.y);
+        if (rssi >= BLE_FLOOR_DBM) Tag(Emit(out, 4, p.tag, rssi, t));
+      }
+    }
+
+    for (const auto& f : _followers) {
+      if (!Binomial(1, 0.5f * BLE_DUTY)) continue;
+      const int rssi = Rssi(TX_BLE_DBM, 0.5f, 1.5f); // in a bag or pocket
+      if (rssi >= BLE_FLOOR_DBM) Tag(Emit(out, 4, f.data(), rssi, t));
+    }
+  }
+
+private:
+  void Spawn(Pedestrian& p, bool tag, uint32_t t, bool at_edge) {
+    std::uniform_real_distribution<float> u(-BOX_M, BOX_M), pace(0.0f, WALK_MPS), dir(0.0f, 2.0f * (float)M_PI);
+    const float cx = CarrierX(t);
+    p.x = cx + u(_rng);
+    p.y = u(_rng);
+    if (at_edge) p.x = cx + (Binomial(1, 0.5f) ? BOX_M : -BOX_M) * 0.99f;
+    const float v = pace(_rng), a = dir(_rng);
+    p.vx = v * cosf(a);
+    p.vy = v * sinf(a);
+    RandomMac(p.wifi, 0x02);
+    RandomMac(p.ble, 0x40);
+    RandomMac(p.tag, 0xC0);
+    p.has_tag = tag;
+    // Random phase, so rotations do not all happen together.
+    p.next_rotate = t + 1 + (uint32_t)(_rng() % (uint32_t)std::max(1, _cfg.rotate_s));
+    p.next_probe = t + (uint32_t)Exp(PROBE_MEAN_S);
+  }
+
+  // prefix 0x00: global unicast; 0x02: locally administered (randomized
+  // Wi-Fi); 0x40 / 0xC0: BLE resolvable private / random static.
+  void RandomMac(uint8_t* out, uint8_t prefix) {
+    for (int i = 0; i < 6; ++i) out[i] = (uint8_t)_rng();
+    if (prefix == 0x00) out[0] &= 0xFC;
+    else if (prefix == 0x02) out[0] = (uint8_t)((out[0] & 0xFC) | 0x02);
+    else out[0] = (uint8_t)((out[0] & 0x3F) | prefix);
+  }
+
+  int Rssi(float tx, float dx, float dy) {
+    std::normal_distribution<float> shadow(0.0f, SHADOW_DB);
+    const float d = std::max(1.0f, sqrtf(dx * dx + dy * dy));
+    return (int)lroundf(tx - 10.0f * PATH_LOSS_N * log10f(d) + shadow(_rng));
+  }
+
+  int Binomial(int n, float p) { return std::binomial_distribution<int>(n, p)(_rng); }
+  float Exp(float mean) { return std::exponential_distribution<float>(1.0f / mean)(_rng); }
+
+  static JournalObservation& Emit(std::vector<JournalObservation>& out, uint8_t kind, const uint8_t* addr,
+                                  int rssi, uint32_t t) {
+    out.emplace_back();
+    JournalObservation& o = out.back();
+    o.kind = kind;
+    o.rssi_dbm = (int8_t)std::max(-128, std::min(rssi, 0));
+    memcpy(o.addr, addr, 6);
+    o.ts_s = t;
+    return o;
+  }
+
+  static void Tag(JournalObservation& o) {
+    o.tracker_type = TrackerType::AppleAirTag;
+    o.tracker_confidence = 90;
+  }
+
+  Config _cfg;
+  std::mt19937 _rng;
+  std::vector<Ap> _aps;
+  std::vector<Pedestrian> _peds;
+  std::vector<std::array<uint8_t, 6>> _followers;
+};
+
+static bool parse_args(int argc, char** argv, Config& cfg) {
+  for (int i = 1; i < argc; ++i) {
+    const char* a = argv[i];
+    const char* v = (i + 1 < argc) ? argv[i + 1] : nullptr;
+    if (!v) return false;
+    if (strcmp(a, "--minutes") == 0) cfg.minutes = atoi(v);
+    else if (strcmp(a, "--aps") == 0) cfg.aps = atoi(v);
+    else if (strcmp(a, "--phones") == 0) cfg.phones = atoi(v);
+    else if (strcmp(a, "--trackers") == 0) cfg.trackers = atoi(v);
+    else if (strcmp(a, "--followers") == 0) cfg.followers = atoi(v);
+    else if (strcmp(a, "--rotate") == 0) cfg.rotate_s = atoi(v);
+    else if (strcmp(a, "--capacity") == 0) sscanf(v, "%d,%d", &cfg.tracks, &cfg.anchors);
+    else if (strcmp(a, "--speed") == 0) cfg.speed = (float)atof(v);
+    else if (strcmp(a, "--report") == 0) cfg.report_min = atoi(v);
+    else if (strcmp(a, "--seed") == 0) cfg.seed = (uint32_t)strtoul(v, nullptr, 10);
+    else return false;
+    ++i;
+  }
+  return cfg.minutes > 0 && cfg.rotate_s > 0 && cfg.report_min > 0;
+}
+
+static void report(const char* label, uint32_t t, const TableStats& ts, uint64_t obs, double wall_s) {
+  printf("%-6s t=%5u s  tracks %4u anchors %4u  evict %6u/%-5u expire %6u/%-5u  %.0f obs/s (%.0fx)\n", label, t,
+         ts.tracks, ts.anchors, ts.track_evictions, ts.anchor_evictions, ts.track_expiries, ts.anchor_expiries,
+         wall_s > 0 ? obs / wall_s : 0.0, wall_s > 0 ? t / wall_s : 0.0);
+}
+
+int main(int argc, char** argv) {
+  Config cfg;
+  if (!parse_args(argc, argv, cfg)) {
+    fprintf(stderr, "usage: %s [--minutes N] [--aps N] [--phones N] [--trackers N] [--followers N] [--rotate S]\n"
+                    "          [--capacity TRACKS,ANCHORS] [--speed X] [--report MIN] [--seed N]\n", argv[0]);
+    return 2;
+  }
+
+  static DeviceTracker tracker;
+  tracker.setCapacity(cfg.tracks, cfg.anchors);
+  tracker.setClock(VirtualClock::Now);
+  if (!tracker.beginCore()) return 1;
+
+  World world(cfg);
+  printf("world: %zu APs on the route, %d pedestrians (%d with trackers), %d followers, rotate %d s\n",
+         world.ApCount(), cfg.phones, std::min(cfg.trackers, cfg.phones), cfg.followers, cfg.rotate_s);
+
+  std::vector<JournalObservation> batch;
+  uint64_t obs = 0;
+  uint32_t overruns = 0;
+  double max_pass_ms = 0;
+  const uint32_t end_s = (uint32_t)cfg.minutes * 60;
+  const auto t0 = std::chrono::steady_clock::now();
+  auto wall = [&] { return std::chrono::duration<double>(std::chrono::steady_clock::now() - t0).count(); };
+
+  for (uint32_t t = 1; t <= end_s; ++t) {
+    world.Step(t, batch);
+    double lat, lon;
+    world.Fix(t, lat, lon);
+
+    const double p0 = wall();
+    VirtualClock::SetSeconds(t);
+    tracker.setGpsFix(true, lat, lon);
+    tracker.ingest(batch.data(), (int)batch.size());
+    const double pass_s = wall() - p0;
+    obs += batch.size();
+    max_pass_ms = std::max(max_pass_ms, pass_s * 1e3);
+
+    if (cfg.speed > 0) {
+      if (pass_s > 1.0 / cfg.speed) overruns++;
+      const double due = (double)t / cfg.speed;
+      const double now = wall();
+      if (due > now) std::this_thread::sleep_for(std::chrono::duration<double>(due - now));
+    }
+
+    if (t % ((uint32_t)cfg.report_min * 60) == 0) report("", t, tracker.tableStats(), obs, wall());
+  }
+
+  const double secs = wall();
+  const TableStats ts = tracker.tableStats();
+  const IngestStats in = tracker.ingestStats();
+  const ColdStats cold = tracker.coldStats();
+  report("end", end_s, ts, obs, secs);
+  printf("throughput: %llu observations in %.2f s wall = %.0f obs/s, %.0fx real time; max pass %.2f ms (%u us in core)\n",
+         (unsigned long long)obs, secs, obs / secs, end_s / secs, max_pass_ms, in.max_batch_us);
+  printf("drops: %u overruns at %.0fx, %u rejected sightings, %u cold-tier queue drops\n", overruns, cfg.speed,
+         ts.rejected, cold.dropped);
+  printf("cold tier: spilled %u, rehydrated %u, false hits %u\n", cold.spilled, cold.rehydrated, cold.false_hits);
+
+  tracker.publishSnapshot();
+  int total = 0;
+  tracker.topK(nullptr, 0, 0, &total);
+  std::vector<EntityView> views((size_t)total);
+  const int n = tracker.topK(views.data(), 0, total, &total);
+
+  int hist[10] = {}, ranked_tracks = 0;
+  for (int r = 0; r < n; ++r) {
+    if (views[(size_t)r].kind == EntityKind::WifiAp) continue;
+    hist[std::min(9, std::max(0, (int)(views[(size_t)r].score / 10.0f)))]++;
+    ranked_tracks++;
+  }
+  printf("scores of %d ranked tracks:\n", ranked_tracks);
+  for (int b = 9; b >= 0; --b) printf("  %3d-%-3d %5d\n", b * 10, b * 10 + 10, hist[b]);
+
+  for (const auto& f : world.Followers()) {
+    int rank = -1;
+    for (int r = 0; r < n && rank < 0; ++r) {
+      if (views[(size_t)r].kind == EntityKind::BleAdv && memcmp(views[(size_t)r].addr, f.data(), 6) == 0) rank = r;
+    }
+    if (rank >= 0) {
+      printf("follower %02x:%02x:%02x:%02x:%02x:%02x  rank %d of %d, score %.1f\n", f[0], f[1], f[2], f[3], f[4],
+             f[5], rank + 1, n, views[(size_t)rank].score);
+    } else {
+      printf("follower %02x:%02x:%02x:%02x:%02x:%02x  not ranked\n", f[0], f[1], f[2], f[3], f[4], f[5]);
+    }
+  }
+  return 0;
+}
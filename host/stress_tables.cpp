@@ -0,0 +1,171 @@
+// Host stress test: tracker table path at large runtime capacities.
+//
+// Lays the tables out from one Arena the way DeviceTracker::begin() does
+// (hot/cold track arrays, MacIndex, RecencyList, TimerWheel) and drives them
+// with 45 virtual minutes of a crowd that does not fit:
+//   residents  - cap/2 devices that stay all session
+//   transients - randomized MACs that each live a few minutes; the live
+//                transient window is 2x cap, so the table runs full and has
+//                to evict. The crowd leaves after 20 minutes, so the
+//                transients still held then expire through the wheel.
+// Reports arena size, per-observation cost, hit rate, evictions, expiries
+// and final occupancy for each capacity. Exits non-zero if the index, LRU
+// and in_use flags ever disagree.
+//
+//   g++ -O2 -std=gnu++2a -I../src stress_tables.cpp -o stress_tables
+//   ./stress_tables
+
+#include "Arena.h"
+#include "MacIndex.h"
+#include "RecencyList.h"
+#include "TimerWheel.h"
+#include "Track.h"
+
+#include <chrono>
+#include <cmath>
+#include <cstdio>
+#include <cstring>
+#include <random>
+
+static constexpr uint32_t IDLE_S = 15 * 60;
+static constexpr uint32_t CROWD_S = 20 * 60;
+static constexpr uint32_t RUN_S = 45 * 60;
+
+struct Tables {
+  Track*      tracks = nullptr;
+  TrackInfo*  info = nullptr;
+  uint16_t*   gen = nullptr;
+  MacIndex    index;
+  RecencyList lru;
+  TimerWheel  expiry;
+
+  bool Layout(Arena& arena, int cap) {
+    tracks = arena.Alloc<Track>((size_t)cap);
+    info = arena.Alloc<TrackInfo>((size_t)cap);
+    gen = arena.Alloc<uint16_t>((size_t)cap);
+    bool ok = index.Init(arena, MacIndex::BucketsFor(cap));
+    ok = lru.Init(arena, cap) && ok;
+    ok = expiry.Init(arena, cap) && ok;
+    return ok && !arena.Sizing() && arena.Fits();
+  }
+};
+
+struct Counters {
+  uint64_t obs = 0, hits = 0, inserts = 0, evictions = 0, expiries = 0;
+};
+
+static void mac_for(uint32_t id, uint8_t out[6]) {
+  // Locally administered, like a randomized client MAC.
+  out[0] = 0x02;
+  out[1] = (uint8_t)(id >> 24);
+  out[2] = (uint8_t)(id >> 16);
+  out[3] = (uint8_t)(id >> 8);
+  out[4] = (uint8_t)id;
+  out[5] = (uint8_t)(id * 0x9E);
+}
+
+static void release(Tables& t, int i) {
+  t.index.Erase(MacIndex::MakeKey((uint8_t)t.tracks[i].kind, t.tracks[i].addr));
+  t.lru.Release(i);
+  t.expiry.Cancel(i);
+  t.tracks[i] = Track{};
+  t.info[i] = TrackInfo{};
+}
+
+static void observe(Tables& t, Counters& c, uint32_t id, int rssi, uint32_t now) {
+  uint8_t addr[6];
+  mac_for(id, addr);
+  const uint64_t key = MacIndex::MakeKey((uint8_t)TrackKind::WifiClient, addr);
+  c.obs++;
+
+  int i = t.index.Find(key);
+  if (i >= 0) {
+    c.hits++;
+    t.lru.Touch(i);
+  } else {
+    i = t.lru.Claim();
+    if (i == RecencyList::NIL) {
+      release(t, t.lru.Oldest());
+      c.evictions++;
+      i = t.lru.Claim();
+    }
+    Track& n = t.tracks[i];
+    n.in_use = true;
+    n.kind = TrackKind::WifiClient;
+    memcpy(n.addr, addr, 6);
+    t.gen[i] = (uint16_t)(t.gen[i] + 1);
+    n.handle = ((uint32_t)t.gen[i] << 16) | (uint32_t)i;
+    n.first_seen_s = now;
+    t.index.Insert(key, i);
+    c.inserts++;
+  }
+
+  Track& tr = t.tracks[i];
+  tr.last_seen_s = now;
+  const float prev = tr.ema_rssi;
+  tr.ema_rssi = 0.8f * tr.ema_rssi + 0.2f * (float)rssi;
+  tr.ema_abs_dev = 0.8f * tr.ema_abs_dev + 0.2f * std::fabs(prev - (float)rssi);
+  tr.score_stale = true;
+  t.expiry.Schedule(i, now + IDLE_S);
+}
+
+static bool consistent(const Tables& t, int cap) {
+  int in_use = 0;
+  for (int i = 0; i < cap; ++i) {
+    if (!t.tracks[i].in_use) continue;
+    in_use++;
+    if (t.index.Find(MacIndex::MakeKey((uint8_t)t.tracks[i].kind, t.tracks[i].addr)) != i) return false;
+  }
+  return in_use == t.lru.Count() && in_use == t.index.Count();
+}
+
+static bool run(int cap) {
+  Arena sizing;
+  Tables t;
+  t.Layout(sizing, cap);
+  Arena arena;
+  if (!arena.Reserve(sizing.Used(), false) || !t.Layout(arena, cap)) {
+    printf("%6d slots: allocation failed\n", cap);
+    return false;
+  }
+
+  std::mt19937 rng(1234);
+  Counters c;
+  const uint32_t residents = (uint32_t)cap / 2;
+  const uint32_t window = (uint32_t)cap * 2;
+  const uint32_t per_s = (uint32_t)cap / 8;
+  const uint32_t t0 = 1000;
+  bool ok = true;
+
+  using clock = std::chrono::steady_clock;
+  auto start = clock::now();
+  for (uint32_t s = 0; s < RUN_S; ++s) {
+    const uint32_t now = t0 + s;
+    // Transient ids slide forward so each is in the window for a few minutes.
+    const uint32_t base = residents + s * (per_s / 10 + 1);
+    const bool crowd = s < CROWD_S;
+    for (uint32_t k = 0; k < per_s; ++k) {
+      const uint32_t id = (!crowd || rng() % 10 < 6) ? rng() % residents : base + rng() % window;
+      observe(t, c, id, -40 - (int)(rng() % 50), now);
+    }
+    t.expiry.Advance(now, [&](int i) {
+      release(t, i);
+      c.expiries++;
+    });
+    if ((s % 300) == 299) ok = consistent(t, cap) && ok;
+  }
+  const double ns = std::chrono::duration<double, std::nano>(clock::now() - start).count();
+
+  printf("%6d slots: arena %7zu KB  %8llu obs  %6.1f ns/obs  hit %5.1f%%  evict %7llu  expire %6llu  live %d%s\n",
+         cap, arena.Used() / 1024, (unsigned long long)c.obs, ns / (double)c.obs,
+         100.0 * (double)c.hits / (double)c.obs, (unsigned long long)c.evictions,
+         (unsigned long long)c.expiries, t.lru.Count(), ok ? "" : "  INCONSISTENT");
+  return ok;
+}
+
+int main() {
+  printf("Track %zu B + TrackInfo %zu B per slot\n", sizeof(Track), sizeof(TrackInfo));
+  bool ok = true;
+  for (int cap : {256, 4096, 16384}) ok = run(cap) && ok;
+  return ok ? 0 : 1;
+}
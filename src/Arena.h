@@ -0,0 +1,94 @@
+#pragma once
+
+#include <cstddef>
+#include <cstdint>
+#include <cstdlib>
+#include <cstring>
+#include <new>
+
+#if defined(ESP_PLATFORM)
+#include <esp_heap_caps.h>
+#endif
+
+// Bump allocator over one block, for tables that are sized once at startup
+// and never freed piecemeal.
+//
+// Sizing is two-pass: an Arena with no block only counts what Alloc() would
+// hand out (and returns nullptr), so the same layout code can be run once to
+// measure and once more after Reserve() to carve the real arrays. Memory from
+// a reserved block is zeroed and value-initialized.
+class Arena {
+public:
+  Arena() = default;
+  // Carves from a caller-owned buffer (fixed storage, host tests).
+  Arena(void* buf, size_t bytes) : _base((uint8_t*)buf), _size(bytes) {}
+  ~Arena() { Release(); }
+
+  Arena(const Arena&) = delete;
+  Arena& operator=(const Arena&) = delete;
+
+  // Allocates the block. With prefer_psram the block goes to external RAM
+  // when the board has enough of it free, otherwise to the internal heap.
+  bool Reserve(size_t bytes, bool prefer_psram) {
+    Release();
+    void* p = nullptr;
+#if defined(ESP_PLATFORM)
+    if (prefer_psram && heap_caps_get_free_size(MALLOC_CAP_SPIRAM) >= bytes) {
+      p = heap_caps_malloc(bytes, MALLOC_CAP_SPIRAM | MALLOC_CAP_8BIT);
+      _psram = p != nullptr;
+    }
+    if (!p) p = heap_caps_malloc(bytes, MALLOC_CAP_INTERNAL | MALLOC_CAP_8BIT);
+#else
+    (void)prefer_psram;
+    p = malloc(bytes);
+#endif
+    if (!p) return false;
+    memset(p, 0, bytes);
+    _base = (uint8_t*)p;
+    _size = bytes;
+    _used = 0;
+    _owned = true;
+    return true;
+  }
+
+  void Release() {
+    if (_owned) {
+#if defined(ESP_PLATFORM)
+      heap_caps_free(_base);
+#else
+      free(_base);
+#endif
+    }
+    _base = nullptr;
+    _size = _used = 0;
+    _owned = _psram = false;
+  }
+
+  // n value-initialized Ts, or nullptr while sizing / when out of space
+  // (Used() still advances, so Fits() reports the shortfall).
+  template <typename T>
+  T* Alloc(size_t n) {
+    const size_t at = (_used + alignof(T) - 1) & ~(alignof(T) - 1);
+    _used = at + n * sizeof(T);
+    if (!_base || _used > _size) return nullptr;
+    T* p = (T*)(_base + at);
+    for (size_t i = 0; i < n; ++i) new (p + i) T();
+    return p;
+  }
+
+  // Rewinds to the start of the block (or restarts a sizing pass).
+  void Rewind() { _used = 0; }
+
+  bool   Sizing() const { return _base == nullptr; }
+  bool   Fits() const { return _used <= _size; }
+  size_t Used() const { return _used; }
+  size_t Size() const { return _size; }
+  bool   InPsram() const { return _psram; }
+
+private:
+  uint8_t* _base = nullptr;
+  size_t   _size = 0;
+  size_t   _used = 0;
+  bool     _owned = false;
+  bool     _psram = false;
+};
@@ -0,0 +1,137 @@
+#pragma once
+
+#include <cstddef>
+#include <cstdint>
+#include <cstring>
+
+// Single-pass parser for BLE advertising data. ScanCB::onResult parses each
+// advert once and hands the view to every classifier. Before, each
+// classifier asked NimBLE again: getManufacturerData() copied into a
+// std::string, and every service check built a NimBLEUUID and searched the
+// UUID lists. Plain C++ with no NimBLE types and no allocation. The view
+// points into the payload, so it is only valid while the payload is.
+
+// 16-bit service UUIDs the classifiers look for, as bits of
+// BleAdvert::services.
+enum class BleService : uint8_t {
+  FE33,   // Apple/Chipolo offline finding
+  FEAA,   // Google Find My Network
+  FD5A,   // Samsung SmartTag
+  FD69,   // Samsung Find My Mobile
+  FA25,   // PebbleBee
+  FEED,   // Tile
+  Raven1, // 0x3100..0x3500: Raven (Flock) proprietary services
+  Raven2,
+  Raven3,
+  Raven4,
+  Raven5,
+  Count,
+};
+
+static constexpr uint16_t BLE_SERVICE_UUIDS[(int)BleService::Count] = {
+  0xFE33, 0xFEAA, 0xFD5A, 0xFD69, 0xFA25, 0xFEED, 0x3100, 0x3200, 0x3300, 0x3400, 0x3500,
+};
+
+struct BleAdvert {
+  uint8_t        addr[6];           // canonical order, OUI first
+  uint8_t        name_len = 0;      // first complete or shortened local name
+  uint8_t        name[32];
+  const uint8_t* mfg = nullptr;     // first manufacturer data, after the company ID; null if none
+  uint8_t        mfg_len = 0;
+  uint16_t       company_id = 0;
+  uint16_t       services = 0;      // BleService bits, from the 16-, 32- and 128-bit UUID lists
+  const uint8_t* svc_data = nullptr; // first 16-bit service data, after the UUID; null if none
+  uint8_t        svc_data_len = 0;
+  uint16_t       svc_data_uuid = 0;
+
+  bool HasCompany(uint16_t id) const { return mfg && company_id == id; }
+  bool HasService(BleService s) const { return services & (1u << (int)s); }
+};
+
+static_assert((int)BleService::Count <= 16, "BleAdvert::services is 16 bits");
+
+// Bit for a 16-bit UUID, 0 if it is not one the classifiers look for.
+static inline uint16_t ble_service_bit(uint16_t uuid16) {
+  for (int i = 0; i < (int)BleService::Count; ++i) {
+    if (BLE_SERVICE_UUIDS[i] == uuid16) return (uint16_t)(1u << i);
+  }
+  return 0;
+}
+
+// addr in canonical order; payload[0..len) is the advertising data (plus
+// scan response) as NimBLE reports it. A malformed AD structure ends the
+// parse; what came before it is kept.
+static inline void parse_ble_advert(const uint8_t addr[6], const uint8_t* payload, size_t len, BleAdvert& out) {
+  // Bluetooth Base UUID, little-endian, with the 16-bit UUID at bytes 12..13.
+  static constexpr uint8_t BASE_UUID_LE[16] = {
+    0xFB, 0x34, 0x9B, 0x5F, 0x80, 0x00, 0x00, 0x80, 0x00, 0x10, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00,
+  };
+
+  out = BleAdvert{};
+  memcpy(out.addr, addr, 6);
+  if (!payload) return;
+
+  bool have_name = false, have_mfg = false;
+  size_t i = 0;
+  while (i < len) {
+    const uint8_t ad_len = payload[i];
+    if (ad_len == 0) break;
+    if (i + 1 + ad_len > len) break; // malformed AD structure
+
+    const uint8_t type = payload[i + 1];
+    const uint8_t* d = payload + i + 2;
+    const uint8_t n = (uint8_t)(ad_len - 1);
+
+    switch (type) {
+      case 0x02: // incomplete / complete list of 16-bit UUIDs
+      case 0x03:
+        for (uint8_t k = 0; k + 2 <= n; k += 2) out.services |= ble_service_bit((uint16_t)(d[k] | d[k + 1] << 8));
+        break;
+
+      case 0x04: // 32-bit UUIDs: 16-bit ones with zero upper half
+      case 0x05:
+        for (uint8_t k = 0; k + 4 <= n; k += 4) {
+          if (d[k + 2] == 0 && d[k + 3] == 0) out.services |= ble_service_bit((uint16_t)(d[k] | d[k + 1] << 8));
+        }
+        break;
+
+      case 0x06: // 128-bit UUIDs: 16-bit ones on the base UUID
+      case 0x07:
+        for (uint8_t k = 0; k + 16 <= n; k += 16) {
+          if (memcmp(d + k, BASE_UUID_LE, 12) == 0 && d[k + 14] == 0 && d[k + 15] == 0) {
+            out.services |= ble_service_bit((uint16_t)(d[k + 12] | d[k + 13] << 8));
+          }
+        }
+        break;
+
+      case 0x08: // shortened / complete local name
+      case 0x09:
+        if (!have_name) {
+          have_name = true;
+          out.name_len = n < 32 ? n : 32;
+          if (out.name_len) memcpy(out.name, d, out.name_len);
+        }
+        break;
+
+      case 0x16: // service data, 16-bit UUID
+        if (!out.svc_data && n >= 2) {
+          out.svc_data_uuid = (uint16_t)(d[0] | d[1] << 8);
+          out.svc_data = d + 2;
+          out.svc_data_len = (uint8_t)(n - 2);
+        }
+        break;
+
+      case 0xFF: // manufacturer specific; only the first counts, as with NimBLE
+        if (!have_mfg) {
+          have_mfg = true;
+          if (n >= 2) {
+            out.company_id = (uint16_t)(d[0] | d[1] << 8);
+            out.mfg = d + 2;
+            out.mfg_len = (uint8_t)(n - 2);
+          }
+        }
+        break;
+    }
+    i += 1 + ad_len;
+  }
+}
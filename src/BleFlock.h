@@ -1,15 +1,14 @@
 #pragma once
 
 #include <cstdint>
-#include <NimBLEDevice.h>
 
+#include "BleAdvert.h"
 #include "Track.h"
 
 class BleFlock {
 public:
-  // Pure classification from an advertisement.
-  FlockInfo Inspect(const NimBLEAdvertisedDevice& dev,
-                    const uint8_t* name, uint8_t name_len) const;
+  // Pure classification from a parsed advertisement.
+  FlockInfo Inspect(const BleAdvert& adv) const;
 
   static const char* FlockTypeName(FlockType t);
   static bool ParseFlockType(const char* s, FlockType& out);
@@ -33,39 +33,36 @@ static bool ieq_g(const char* a, const char* b) {
   return *a == 0 && *b == 0;
 }
 
-GlassesInfo BleGlasses::Inspect(const NimBLEAdvertisedDevice& dev,
-                                const uint8_t* name, uint8_t name_len) const {
+GlassesInfo BleGlasses::Inspect(const BleAdvert& adv) const {
   GlassesInfo out{};
+  const uint8_t* name = adv.name;
+  const uint8_t name_len = adv.name_len;
 
   // 1) Check manufacturer data for known company IDs
-  if (dev.haveManufacturerData()) {
-    const std::string mfg = dev.getManufacturerData();
-    if (mfg.size() >= 2) {
-      const auto* b = reinterpret_cast<const uint8_t*>(mfg.data());
-      const uint16_t company = (uint16_t)b[0] | (uint16_t(b[1]) << 8);
-
-      if (company == META_COMPANY_ID1 || company == META_COMPANY_ID2) {
-        out.type = GlassesType::MetaRayBan;
-        out.confidence = 85;
-        return out;
-      }
-
-      if (company == ESSILOR_COMPANY_ID) {
-        out.type = GlassesType::EssilorLuxottica;
-        out.confidence = 80;
-        return out;
-      }
-
-      if (company == SNAP_COMPANY_ID) {
-        out.type = GlassesType::SnapSpectacles;
-        out.confidence = 85;
-        return out;
-      }
+  if (adv.mfg) {
+    const uint16_t company = adv.company_id;
+
+    if (company == META_COMPANY_ID1 || company == META_COMPANY_ID2) {
+      out.type = GlassesType::MetaRayBan;
+      out.confidence = 85;
+      return out;
+    }
+
+    if (company == ESSILOR_COMPANY_ID) {
+      out.type = GlassesType::EssilorLuxottica;
+      out.confidence = 80;
+      return out;
+    }
+
+    if (company == SNAP_COMPANY_ID) {
+      out.type = GlassesType::SnapSpectacles;
+      out.confidence = 85;
+      return out;
     }
   }
 
   // 2) Check device name for Ray-Ban variants
-  if (name && name_len > 0) {
+  if (name_len > 0) {
     if (ContainsG(name, name_len, "rayban") ||
         ContainsG(name, name_len, "ray-ban") ||
         ContainsG(name, name_len, "ray ban")) {
@@ -1,15 +1,14 @@
 #pragma once
 
 #include <cstdint>
-#include <NimBLEDevice.h>
 
+#include "BleAdvert.h"
 #include "Track.h"
 
 class BleGlasses {
 public:
-  // Pure classification from an advertisement.
-  GlassesInfo Inspect(const NimBLEAdvertisedDevice& dev,
-                      const uint8_t* name, uint8_t name_len) const;
+  // Pure classification from a parsed advertisement.
+  GlassesInfo Inspect(const BleAdvert& adv) const;
 
   static const char* GlassesTypeName(GlassesType t);
   static bool ParseGlassesType(const char* s, GlassesType& out);
@@ -1,17 +1,12 @@
 #include "BleTracker.h"
 
-#include <algorithm>
 #include <cctype>
+#include <cstring>
 
 static constexpr uint16_t BT_COMPANY_ID_APPLE = 0x004C;
 
-// BLE “offline finding” service UUIDs (from AirGuard)
-static constexpr const char* UUID_FE33 = "0000FE33-0000-1000-8000-00805F9B34FB"; // Apple/Chipolo offline finding
-static constexpr const char* UUID_FEAA = "0000FEAA-0000-1000-8000-00805F9B34FB"; // Google Find My Network
-static constexpr const char* UUID_FD5A = "0000FD5A-0000-1000-8000-00805F9B34FB"; // Samsung SmartTag
-static constexpr const char* UUID_FD69 = "0000FD69-0000-1000-8000-00805F9B34FB"; // Samsung Find My Mobile
-static constexpr const char* UUID_FA25 = "0000FA25-0000-1000-8000-00805F9B34FB"; // PebbleBee
-static constexpr const char* UUID_FEED = "0000FEED-0000-1000-8000-00805F9B34FB"; // Tile
+// BLE “offline finding” service UUIDs (from AirGuard) are BleService::FE33,
+// FEAA, FD5A, FD69, FA25 and FEED; see BleAdvert.h.
 
 static inline bool memcmpi(const uint8_t* a, const uint8_t* b, size_t n) {
   for (size_t i = 0; i < n; ++i) {
@@ -31,32 +26,6 @@ static inline bool Contains(const uint8_t* name, uint8_t name_len, const char* n
   return false;
 }
 
-bool BleTracker::HasService(const NimBLEAdvertisedDevice& dev, const char* uuid_str) {
-  // NimBLE-Arduino supports isAdvertisingService() on most builds.
-  // If your build differs, replace with dev.haveServiceUUID() + iterate.
-  NimBLEUUID uuid(uuid_str);
-  return dev.isAdvertisingService(uuid);
-}
-
-bool BleTracker::TryGetAppleMfgPayload(const NimBLEAdvertisedDevice& dev, const uint8_t*& p, size_t& n) {
-  p = nullptr;
-  n = 0;
-
-  if (!dev.haveManufacturerData()) return false;
-
-  const std::string mfg = dev.getManufacturerData();
-  if (mfg.size() < 2) return false;
-
-  const auto* b = reinterpret_cast<const uint8_t*>(mfg.data());
-  const uint16_t company = (uint16_t)b[0] | (uint16_t(b[1]) << 8);
-  if (company != BT_COMPANY_ID_APPLE) return false;
-
-  // Apple payload starts after the 2-byte company id
-  p = b + 2;
-  n = mfg.size() - 2;
-  return true;
-}
-
 GoogleFmnManufacturer BleTracker::GuessGoogleMfrFromName(const uint8_t* name, uint8_t name_len) {
   if (name == nullptr || name_len == 0) return GoogleFmnManufacturer::Unknown;
 
@@ -91,47 +60,49 @@ GoogleFmnManufacturer BleTracker::GuessGoogleMfrFromName(const uint8_t* name, ui
   return SamsungTrackerSubtype::Unknown;
 }
 
-TrackerInfo BleTracker::Inspect(const NimBLEAdvertisedDevice& dev,
-                      const uint8_t* name, uint8_t name_len) const {
+TrackerInfo BleTracker::Inspect(const BleAdvert& adv) const {
   TrackerInfo out{};
+  const uint8_t* name = adv.name;
+  const uint8_t name_len = adv.name_len;
 
   // 1) Strong UUID signals first
-  if (HasService(dev, UUID_FEED)) {
+  if (adv.HasService(BleService::FEED)) {
     out.type = TrackerType::Tile;
     out.confidence = 95;
     return out;
   }
 
-  if (HasService(dev, UUID_FD5A)) {
+  if (adv.HasService(BleService::FD5A)) {
     out.type = TrackerType::SmartThingsTracker;
     out.confidence = 95;
     out.samsung_subtype = GuessSamsungSubtypeFromName(name, name_len);
     return out;
   }
 
-  if (HasService(dev, UUID_FD69)) {
+  if (adv.HasService(BleService::FD69)) {
     out.type = TrackerType::SmartThingsFind;
     out.confidence = 90;
     return out;
   }
 
-  if (HasService(dev, UUID_FEAA)) {
+  if (adv.HasService(BleService::FEAA)) {
     out.type = TrackerType::GoogleFindHub;
     out.confidence = 90;
     out.google_mfr = GuessGoogleMfrFromName(name, name_len);
     return out;
   }
 
-  if (HasService(dev, UUID_FA25)) {
+  if (adv.HasService(BleService::FA25)) {
     out.type = TrackerType::PebbleBee;
     out.confidence = 90;
     return out;
   }
 
-  // 2) Apple mfg data heuristics (from AirGuard filters)
-  const uint8_t* ap = nullptr;
-  size_t an = 0;
-  if (TryGetAppleMfgPayload(dev, ap, an)) {
+  // 2) Apple mfg data heuristics (from AirGuard filters); the Apple payload
+  //    starts after the 2-byte company id
+  if (adv.HasCompany(BT_COMPANY_ID_APPLE)) {
+    const uint8_t* ap = adv.mfg;
+    const size_t an = adv.mfg_len;
     // AirGuard: manufacturer payload begins with 0x12, 0x19 for their Apple tracking-related devices.
     // We use those bytes and a conservative third-byte mask similar to their ScanFilter masks.
     if (an >= 2 && ap[0] == 0x12 && ap[1] == 0x19) {
@@ -150,7 +121,7 @@ TrackerInfo BleTracker::Inspect(const NimBLEAdvertisedDevice& dev,
         if ((b2 & 0x18) == 0x10) {
           // If it also advertises FE33, it is very likely a Find My accessory (including some AirTag behaviors),
           // but we use this to differentiate "AppleFindMy" vs "AppleAirTag" without GATT.
-          const bool has_fe33 = HasService(dev, UUID_FE33);
+          const bool has_fe33 = adv.HasService(BleService::FE33);
 
           out.type = has_fe33 ? TrackerType::AppleFindMy : TrackerType::AppleAirTag;
           out.confidence = has_fe33 ? 80 : 75;
@@ -166,7 +137,7 @@ TrackerInfo BleTracker::Inspect(const NimBLEAdvertisedDevice& dev,
   }
 
   // 3) Chipolo vs generic FE33 (non-Apple)
-  if (HasService(dev, UUID_FE33)) {
+  if (adv.HasService(BleService::FE33)) {
     // If Apple mfg did not match above, treat FE33 as Chipolo/other accessory.
     out.type = TrackerType::Chipolo;
     out.confidence = 80;
@@ -190,33 +161,6 @@ static bool ieq(const char* a, const char* b) {
   return *a == 0 && *b == 0;
 }
 
-void BleTracker::GetName(
-    const uint8_t* payload, size_t len,
-    uint8_t out[32], uint8_t* out_len)
-{
-  *out_len = 0;
-  if (!payload || len < 2) return;
-
-  size_t i = 0;
-  while (i < len) {
-    uint8_t ad_len = payload[i];
-    if (ad_len == 0) break;
-    if (i + 1 + ad_len > len) break;
-
-    uint8_t ad_type = payload[i + 1];
-    const uint8_t* ad_data = payload + i + 2;
-    size_t ad_data_len = ad_len - 1;
-
-    if (ad_type == BLE_HS_ADV_TYPE_COMP_NAME || ad_type == BLE_HS_ADV_TYPE_INCOMP_NAME) {
-      size_t ncopy = std::min<size_t>(ad_data_len, 32);
-      if (ncopy) memcpy(out, ad_data, ncopy);
-      *out_len = (uint8_t)ncopy;
-      return;
-    }
-    i += (1 + ad_len);
-  }
-}
-
 Vendor BleTracker::GetVendorFromTrackerType(TrackerType t) {
   switch (t) {
     case TrackerType::AppleAirPods:
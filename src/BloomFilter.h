@@ -0,0 +1,59 @@
+#pragma once
+
+#include <cstdint>
+#include <cstring>
+
+// Fixed-size Bloom filter over 64-bit keys (MacIndex keys). MayContain()
+// never misses a key that was Add()ed since the last Clear(); a false
+// positive only costs the caller a lookup it could have skipped.
+//
+// BITS must be a power of two. With K = 3 the false-positive rate stays
+// around 3% up to BITS / 8 keys.
+template <int BITS, int K = 3>
+class BloomFilter {
+  static_assert(BITS >= 64 && (BITS & (BITS - 1)) == 0, "BITS must be a power of two");
+
+public:
+  void Clear() {
+    memset(_words, 0, sizeof(_words));
+    _count = 0;
+  }
+
+  void Add(uint64_t key) {
+    uint32_t h1, h2;
+    Hash(key, h1, h2);
+    for (int i = 0; i < K; ++i) {
+      const uint32_t b = (h1 + (uint32_t)i * h2) & MASK;
+      _words[b >> 5] |= 1u << (b & 31);
+    }
+    _count++;
+  }
+
+  bool MayContain(uint64_t key) const {
+    uint32_t h1, h2;
+    Hash(key, h1, h2);
+    for (int i = 0; i < K; ++i) {
+      const uint32_t b = (h1 + (uint32_t)i * h2) & MASK;
+      if ((_words[b >> 5] & (1u << (b & 31))) == 0) return false;
+    }
+    return true;
+  }
+
+  // Adds since Clear(), duplicates included.
+  uint32_t Count() const { return _count; }
+
+private:
+  static constexpr uint32_t MASK = (uint32_t)BITS - 1;
+
+  // Double hashing from one splitmix64 mix; h2 is odd so the K probes differ.
+  static void Hash(uint64_t key, uint32_t& h1, uint32_t& h2) {
+    key ^= key >> 30; key *= 0xBF58476D1CE4E5B9ULL;
+    key ^= key >> 27; key *= 0x94D049BB133111EBULL;
+    key ^= key >> 31;
+    h1 = (uint32_t)key;
+    h2 = (uint32_t)(key >> 32) | 1u;
+  }
+
+  uint32_t _words[BITS / 32]{};
+  uint32_t _count = 0;
+};
@@ -0,0 +1,60 @@
+#pragma once
+
+#include <cstdint>
+
+// Bottom-k MinHash sketch: keeps the k smallest distinct 32-bit hashes of a
+// set, sorted ascending. Two sketches estimate the Jaccard similarity of
+// their sets in O(k) no matter how large the sets were, and a sketch of
+// width k is also a valid sketch of any smaller width (its first entries),
+// so sketches built with different widths still compare.
+template <int MAX_K>
+class BottomK {
+  static_assert(MAX_K > 0 && MAX_K <= 255, "MAX_K out of range");
+
+public:
+  // Empties the sketch and sets how many hashes it keeps (1..MAX_K).
+  void Reset(int k) {
+    _k = (uint8_t)(k < 1 ? 1 : (k > MAX_K ? MAX_K : k));
+    _n = 0;
+  }
+
+  void Add(uint32_t h) {
+    if (_n == _k && h >= _h[_n - 1]) return; // common case once full
+    int j = _n;
+    while (j > 0 && _h[j - 1] > h) --j;
+    if (j > 0 && _h[j - 1] == h) return;     // already present
+
+    const int last = (_n < _k) ? _n++ : _n - 1;
+    for (int i = last; i > j; --i) _h[i] = _h[i - 1];
+    _h[j] = h;
+  }
+
+  int Count() const { return _n; }
+  int Width() const { return _k; }
+
+  // Estimated |A n B| / |A u B|: walks the union of both sketches in order,
+  // up to the smaller width, and counts hashes present in both. 1 if both
+  // sets are empty.
+  static float Jaccard(const BottomK& a, const BottomK& b) {
+    if (a._n == 0 && b._n == 0) return 1.0f;
+    const int k = a._k < b._k ? a._k : b._k;
+
+    int i = 0, j = 0, taken = 0, shared = 0;
+    while (taken < k && (i < a._n || j < b._n)) {
+      if (j >= b._n || (i < a._n && a._h[i] < b._h[j])) {
+        ++i;
+      } else if (i >= a._n || b._h[j] < a._h[i]) {
+        ++j;
+      } else {
+        ++i; ++j; ++shared;
+      }
+      ++taken;
+    }
+    return (float)shared / (float)taken;
+  }
+
+private:
+  uint32_t _h[MAX_K];
+  uint8_t  _k = MAX_K;
+  uint8_t  _n = 0;
+};
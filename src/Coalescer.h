@@ -0,0 +1,143 @@
+#pragma once
+
+#include <cstdint>
+#include <cstring>
+
+// Producer-side merge of repeat sightings. An AP beaconing at 10 Hz is heard
+// ten times a second with nothing new but the RSSI. The producer offers each
+// sighting here instead of queueing it, and a run of sightings of the same
+// device leaves as one record that carries the count and the min, max and
+// mean RSSI.
+//
+// 4-way set-associative on (kind, addr); a direct-mapped table thrashes as
+// soon as two busy APs share a slot. Two sightings merge only if they also
+// have the same caller tag, which covers anything else that has to match
+// (e.g. SSID ref and channel). A run closes in three cases:
+//   - the window has passed since its first sighting
+//   - it has reached 255 sightings
+//   - its set is full and it is the oldest run there when a new key arrives
+// Add hands back a run that closed. Expire sweeps the table for runs whose
+// window has passed. A closed run carries the record of its latest sighting.
+// With a window of 0 every sighting is its own run.
+//
+// Not thread-safe; one producer owns it.
+template <typename Rec, int SLOTS>
+class Coalescer {
+  static constexpr int WAYS = 4;
+  static_assert(SLOTS >= WAYS && (SLOTS & (SLOTS - 1)) == 0, "SLOTS must be a power of two >= 4");
+
+public:
+  struct Run {
+    Rec     rec;       // latest sighting
+    uint8_t count;
+    int8_t  rssi_min;
+    int8_t  rssi_max;
+    int8_t  rssi_mean; // rounded
+  };
+
+  explicit Coalescer(uint32_t window_ms) : _window_ms(window_ms) {}
+
+  uint32_t Window() const { return _window_ms; }
+
+  // Offers one sighting heard at now_ms. Returns true if a run closed to
+  // make room for it (or, with a window of 0, the sighting itself); that
+  // run is copied into done.
+  bool Add(uint8_t kind, const uint8_t addr[6], uint64_t tag, int8_t rssi, const Rec& rec, uint32_t now_ms,
+           Run& done) {
+    if (_window_ms == 0) {
+      done = Run{rec, 1, rssi, rssi, rssi};
+      return true;
+    }
+
+    Slot* set = &_slots[Set(kind, addr) * WAYS];
+    Slot* free = nullptr;
+    Slot* oldest = set;
+    for (int w = 0; w < WAYS; ++w) {
+      Slot& s = set[w];
+      if (!s.count) {
+        if (!free) free = &s;
+        continue;
+      }
+      if (s.kind == kind && memcmp(s.addr, addr, 6) == 0) {
+        if (s.tag == tag && now_ms - s.first_ms < _window_ms && s.count < 255) {
+          s.rec = rec;
+          s.count++;
+          s.sum += rssi;
+          if (rssi < s.min) s.min = rssi;
+          if (rssi > s.max) s.max = rssi;
+          return false;
+        }
+        // Same device, but the run is over: it gives way to the new one.
+        Close(s, done);
+        Start(s, kind, addr, tag, rssi, rec, now_ms);
+        return true;
+      }
+      if (now_ms - s.first_ms > now_ms - oldest->first_ms) oldest = &s;
+    }
+
+    if (free) {
+      Start(*free, kind, addr, tag, rssi, rec, now_ms);
+      return false;
+    }
+    Close(*oldest, done);
+    Start(*oldest, kind, addr, tag, rssi, rec, now_ms);
+    return true;
+  }
+
+  // Closes up to max runs whose window has passed by now_ms into out;
+  // returns how many. Call again while it returns max.
+  int Expire(uint32_t now_ms, Run* out, int max) {
+    int n = 0;
+    for (int i = 0; i < SLOTS && n < max; ++i) {
+      Slot& s = _slots[i];
+      if (s.count && now_ms - s.first_ms >= _window_ms) Close(s, out[n++]);
+    }
+    return n;
+  }
+
+  // Drops every open run.
+  void Clear() {
+    for (Slot& s : _slots) s.count = 0;
+  }
+
+private:
+  struct Slot {
+    Rec      rec;
+    uint64_t tag = 0;
+    uint32_t first_ms = 0;
+    int32_t  sum = 0;
+    uint8_t  kind = 0;
+    uint8_t  addr[6]{};
+    uint8_t  count = 0; // 0 = free
+    int8_t   min = 0;
+    int8_t   max = 0;
+  };
+
+  static int Set(uint8_t kind, const uint8_t addr[6]) {
+    uint32_t h = ((uint32_t)addr[2] << 24) | ((uint32_t)addr[3] << 16) | ((uint32_t)addr[4] << 8) | addr[5];
+    h ^= ((uint32_t)addr[0] << 8 | addr[1]) * 31u + kind;
+    return (int)((h * 2654435761u) >> 16) & (SLOTS / WAYS - 1);
+  }
+
+  static void Start(Slot& s, uint8_t kind, const uint8_t addr[6], uint64_t tag, int8_t rssi, const Rec& rec,
+                    uint32_t now_ms) {
+    s.rec = rec;
+    s.kind = kind;
+    memcpy(s.addr, addr, 6);
+    s.tag = tag;
+    s.first_ms = now_ms;
+    s.count = 1;
+    s.sum = rssi;
+    s.min = s.max = rssi;
+  }
+
+  static void Close(Slot& s, Run& out) {
+    const int32_t c = s.count;
+    const int32_t mean = s.sum >= 0 ? (s.sum + c / 2) / c : -((-s.sum + c / 2) / c);
+    out = Run{s.rec, s.count, s.min, s.max, (int8_t)mean};
+    s.count = 0;
+  }
+
+  uint32_t _window_ms;
+  Slot     _slots[SLOTS];
+};
@@ -0,0 +1,143 @@
+#include "ColdStore.h"
+
+#include <cstring>
+
+static constexpr uint32_t COLD_MAGIC = 0x53435450; // "PTCS"
+static constexpr uint16_t COLD_VERSION = 1;
+
+bool ColdStore::Begin(fs::FS& fs, const char* path, int buckets) {
+  End();
+  if (buckets <= 0 || (buckets & (buckets - 1)) != 0) return false;
+  _buckets = (uint32_t)buckets;
+
+  Header h{};
+  bool valid = false;
+  if (fs.exists(path)) {
+    _file = fs.open(path, "r+");
+    valid = _file && _file.size() == FileSize() &&
+            _file.seek(0) && _file.read((uint8_t*)&h, sizeof(h)) == sizeof(h) &&
+            h.magic == COLD_MAGIC && h.version == COLD_VERSION &&
+            h.probe == PROBE && h.buckets == _buckets;
+  }
+
+  if (!valid) {
+    if (_file) _file.close();
+    _file = fs.open(path, "w+");
+    if (!_file) {
+      Serial.printf("[cold] open failed: %s\n", path);
+      return false;
+    }
+    Serial.printf("[cold] formatting %s (%u bytes)\n", path, (unsigned)FileSize());
+    _session = 0;
+    if (!Format()) {
+      Serial.printf("[cold] format failed: %s\n", path);
+      _file.close();
+      return false;
+    }
+  } else {
+    _session = h.session;
+  }
+
+  _ready = true;
+  return NewSession();
+}
+
+void ColdStore::End() {
+  if (_file) _file.close();
+  _ready = false;
+}
+
+bool ColdStore::NewSession() {
+  if (!_ready) return false;
+  _session++;
+  if (_session == 0) {
+    // Wrapped: old records could alias the new session, so start clean.
+    if (!Format()) {
+      _ready = false;
+      return false;
+    }
+    _session = 1;
+  }
+  return WriteHeader();
+}
+
+bool ColdStore::Format() {
+  uint8_t zero[256]{};
+  if (!_file.seek(0)) return false;
+  for (size_t left = FileSize(); left > 0;) {
+    const size_t n = left < sizeof(zero) ? left : sizeof(zero);
+    if (_file.write(zero, n) != n) return false;
+    left -= n;
+  }
+  _file.flush();
+  return true;
+}
+
+bool ColdStore::WriteHeader() {
+  Header h{};
+  h.magic = COLD_MAGIC;
+  h.version = COLD_VERSION;
+  h.probe = PROBE;
+  h.buckets = _buckets;
+  h.session = _session;
+  if (!_file.seek(0) || _file.write((const uint8_t*)&h, sizeof(h)) != sizeof(h)) return false;
+  _file.flush();
+  return true;
+}
+
+// Same splitmix64 finalizer as MacIndex; OUI bytes repeat too much to mask raw.
+uint32_t ColdStore::Home(uint64_t key) const {
+  key ^= key >> 30; key *= 0xBF58476D1CE4E5B9ULL;
+  key ^= key >> 27; key *= 0x94D049BB133111EBULL;
+  key ^= key >> 31;
+  return (uint32_t)key & (_buckets - 1);
+}
+
+bool ColdStore::ReadRecords(uint32_t first, ColdRecord* out, int n) {
+  const size_t bytes = (size_t)n * sizeof(ColdRecord);
+  return _file.seek(Offset(first)) && _file.read((uint8_t*)out, bytes) == bytes;
+}
+
+bool ColdStore::Get(uint64_t key, ColdRecord& out) {
+  if (!_ready || key == 0) return false;
+  ColdRecord win[PROBE];
+  if (!ReadRecords(Home(key), win, PROBE)) return false;
+  for (const ColdRecord& r : win) {
+    if (r.key == key && r.session == _session) {
+      out = r;
+      return true;
+    }
+  }
+  return false;
+}
+
+bool ColdStore::Put(const ColdRecord& rec) {
+  if (!_ready || rec.key == 0) return false;
+  const uint32_t home = Home(rec.key);
+  ColdRecord win[PROBE];
+  if (!ReadRecords(home, win, PROBE)) return false;
+
+  // Same key, else the first empty/stale bucket, else the oldest record.
+  int same = -1, empty = -1, oldest = 0;
+  for (int i = 0; i < PROBE; ++i) {
+    const bool live = win[i].key != 0 && win[i].session == _session;
+    if (!live) {
+      if (empty < 0) empty = i;
+    } else if (win[i].key == rec.key) {
+      same = i;
+      break;
+    } else if (win[i].last_seen_s < win[oldest].last_seen_s) {
+      oldest = i;
+    }
+  }
+  const int pick = (same >= 0) ? same : (empty >= 0) ? empty : oldest;
+
+  ColdRecord w = rec;
+  w.session = _session;
+  return _file.seek(Offset(home + (uint32_t)pick)) &&
+         _file.write((const uint8_t*)&w, sizeof(w)) == sizeof(w);
+}
+
+void ColdStore::Flush() {
+  if (_ready) _file.flush();
+}
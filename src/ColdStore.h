@@ -0,0 +1,92 @@
+#pragma once
+
+#include <cstdint>
+#include <FS.h>
+
+// History of a track that left the live table (idle expiry or eviction).
+// Timestamps are seconds since boot, so records are only valid within the
+// session that wrote them.
+struct ColdRecord {
+  uint64_t key = 0;            // MacIndex key; 0 = empty
+  uint32_t first_seen_s = 0;
+  uint32_t last_seen_s = 0;
+  uint32_t last_window = 0;
+  uint32_t last_segment_id = 0;
+  uint16_t seen_windows = 0;
+  uint16_t near_windows = 0;
+  uint16_t env_hits = 0;
+  uint8_t  crowd = 0;          // crowd_ema, rounded
+  uint8_t  session = 0;        // 0 = never written
+};
+static_assert(sizeof(ColdRecord) == 32, "ColdRecord is the on-flash record size");
+
+// On-flash hash table of ColdRecords: a header, then a fixed array of
+// buckets. A key lives in one of PROBE consecutive buckets from its home, so
+// Get() and Put() are one positioned read of the probe window (plus one
+// record write for Put). A full window overwrites the least recently seen
+// record.
+//
+// Begin() starts a new session; records from earlier sessions (or before
+// NewSession()) read as empty, so nothing has to be erased. The file is only
+// rewritten in full when it is created or the 8-bit session counter wraps.
+//
+// Not thread-safe; the tracker calls it from the processing task only, never
+// under g_lock.
+class ColdStore {
+public:
+  static constexpr int PROBE = 4;
+
+  // Opens or creates path on fs with buckets (power of two) records.
+  bool Begin(fs::FS& fs, const char* path, int buckets);
+  void End();
+  bool Ready() const { return _ready; }
+
+  // Stores rec under rec.key, replacing that key, an empty or stale bucket,
+  // or the least recently seen record in the window.
+  bool Put(const ColdRecord& rec);
+  // Finds key in the current session.
+  bool Get(uint64_t key, ColdRecord& out);
+  void Flush();
+
+  // Forgets every record.
+  bool NewSession();
+
+  // Calls fn(key) for every record of the current session; reads the whole
+  // file, so only for rare maintenance such as rebuilding a Bloom filter.
+  template <typename F>
+  void ForEachKey(F&& fn) {
+    if (!_ready) return;
+    ColdRecord buf[16];
+    const uint32_t total = _buckets + PROBE - 1;
+    for (uint32_t b = 0; b < total; b += 16) {
+      const int n = (int)((total - b < 16) ? total - b : 16);
+      if (!ReadRecords(b, buf, n)) return;
+      for (int i = 0; i < n; ++i) {
+        if (buf[i].key != 0 && buf[i].session == _session) fn(buf[i].key);
+      }
+    }
+  }
+
+private:
+  struct Header {
+    uint32_t magic;
+    uint16_t version;
+    uint16_t probe;
+    uint32_t buckets;
+    uint8_t  session;
+    uint8_t  reserved[19];
+  };
+  static_assert(sizeof(Header) == 32, "header is one record long");
+
+  bool Format();
+  bool WriteHeader();
+  bool ReadRecords(uint32_t first, ColdRecord* out, int n);
+  uint32_t Home(uint64_t key) const;
+  size_t Offset(uint32_t bucket) const { return sizeof(Header) + (size_t)bucket * sizeof(ColdRecord); }
+  size_t FileSize() const { return Offset(_buckets + PROBE - 1); }
+
+  fs::File _file;
+  uint32_t _buckets = 0;
+  uint8_t  _session = 0;
+  bool     _ready = false;
+};
@@ -3,9 +3,28 @@
 #include "BleGlasses.h"
 #include "BleFlock.h"
 #include "Track.h"
+#include "Arena.h"
+#include "MacIndex.h"
+#include "RecencyList.h"
+#include "TimerWheel.h"
+#include "MacFilter.h"
+#include "SsidPool.h"
+#include "SpscRing.h"
+#include "TrackScore.h"
+#include "BloomFilter.h"
+#include "ColdStore.h"
+#include "HyperLogLog.h"
+#include "Journal.h"
+#include "Pcapng.h"
+#include "Ieee80211.h"
+#include "BleAdvert.h"
+#include "HopScheduler.h"
+#include "Coalescer.h"
 
 #include <WiFi.h>
+#ifndef PIGTAIL_NO_JSON // host builds without ArduinoJson skip list loading
 #include <ArduinoJson.h>
+#endif
 #include <FS.h>
 #include <SD.h>
 #include <SPIFFS.h>
@@ -19,50 +38,97 @@
 #include "freertos/queue.h"
 
 #include <algorithm>
+#include <new>
 #include <math.h>
 #include <string.h>
 
 // ----------------------------- Tuning -----------------------------
 
 static constexpr int WINDOW_SEC     = 10;
+static constexpr int CROWD_HLL_P    = 8; // 256 registers per radio, ~6.5% error
 static constexpr int ENV_WINDOW_SEC = 30;
 
 static constexpr int TRACK_IDLE_SEC_WIFI = 15 * 60;
 static constexpr int TRACK_IDLE_SEC_BLE  = 20 * 60;
 static constexpr int ANCHOR_IDLE_SEC     = 10 * 60;
 
-static constexpr int MAX_TRACKS  = 256;
-static constexpr int MAX_ANCHORS = 128;
+// Table capacity unless setCapacity() is called before begin(). The limits
+// keep slot ids in a handle's 16 bits and snapshot ranks in int16_t.
+static constexpr int DEFAULT_TRACKS  = 256;
+static constexpr int DEFAULT_ANCHORS = 128;
+static constexpr int TRACKS_LIMIT    = 16384;
+static constexpr int ANCHORS_LIMIT   = 8192;
+
+// Score-weighted eviction looks at this many least-recent, non-watched tracks
+static constexpr int EVICT_SAMPLE = 8;
 
 static constexpr int RSSI_NEAR_DBM = -65;
 static constexpr int RSSI_MID_DBM  = -80;
 
-static constexpr float T_CAP_MIN    = 30.0f;
-static constexpr float RSSI_DEV_CAP = 10.0f;
-
-static constexpr float CROWD_LO = 5.0f;
-static constexpr float CROWD_HI = 40.0f;
+// Score weights and caps live in TrackScore.h.
 
 static constexpr float FP_SIMILARITY_MIN = 0.50f;
+static constexpr int   FP_WIDTH_DEFAULT  = 32;
 
 // Wi-Fi hopping
 static constexpr uint8_t WIFI_CH_MIN = 1;
 static constexpr uint8_t WIFI_CH_MAX = 11;
-static constexpr int     HOP_MS      = 250;
+static constexpr int     HOP_MS      = 250; // fixed mode; adaptive rounds are as long (HopScheduler.h)
+static constexpr int     WIFI_CHANNELS = WIFI_CH_MAX - WIFI_CH_MIN + 1;
+static_assert(WIFI_CHANNELS == sizeof(HopStats::channel) / sizeof(HopStats::channel[0]),
+              "HopStats must cover every hopped channel");
 
 static constexpr const char* PATH_WATCHLIST_JSON = "/pt_watchlist.json";
 static constexpr const char* PATH_WATCHLIST_KML = "/pt_watchlist.kml";
 
 static constexpr const char* PATH_IGNORELIST_JSON = "/pt_ignorelist.json";
 
+// Cold tier: history of tracks that expired or were evicted (see ColdStore.h)
+static constexpr const char* PATH_COLD_STORE = "/pt_cold.bin";
+static constexpr int COLD_BUCKETS      = 8192;      // 256 KB on SPIFFS
+static constexpr int COLD_BLOOM_BITS   = 64 * 1024; // 8 KB RAM
+static constexpr int COLD_MIN_WINDOWS  = 2;         // single-window blips are not worth a flash write
+static constexpr int COLD_QUEUE        = 32;        // spills / lookups per processing pass
+static constexpr uint32_t COLD_BLOOM_REBUILD = 16384; // adds before the filter is rebuilt from flash
+
+// Observation journal on SD (format in Journal.h)
+static constexpr const char* PATH_JOURNAL = "/pt_journal.bin";
+static constexpr int JOURNAL_RING     = 128;  // entries; ~10 KB, allocated on first start
+static constexpr int JOURNAL_BUF      = 4096; // encoded bytes per SD write
+static constexpr int JOURNAL_WRITE_MS = 1000; // max age of buffered records
+static constexpr int JOURNAL_FLUSH_MS = 5000;
+
+// Raw pcapng capture on SD (format in Pcapng.h)
+static constexpr const char* PATH_CAPTURE_FMT = "/pt_capture_%03u.pcapng";
+static constexpr int CAPTURE_WIFI_SNAP = 512;  // bytes kept of each management frame
+static constexpr int CAPTURE_BLE_SNAP  = 62;   // advert + scan response data
+static constexpr int CAPTURE_WIFI_RING = 32;   // frames; ~17 KB, allocated on first start
+static constexpr int CAPTURE_BLE_RING  = 64;   // adverts; ~5 KB
+static constexpr int CAPTURE_SECTOR    = 512;  // SD writes are whole multiples of this
+static constexpr int CAPTURE_BUF       = 8192;
+static constexpr int CAPTURE_FLUSH_MS  = 5000;
+
 static uint8_t mac_temp[6]{};
 static uint8_t ssid_temp[32]{};
 static char mac_temp_str[18]{};
 
 // ----------------------------- Time helpers -----------------------------
 
-static inline uint64_t now_us() { return (uint64_t)esp_timer_get_time(); }
+// Every timestamp, timer and score in the tracker reads this clock.
+// setClock() swaps it for a virtual one on the host; producers call it from
+// the radio callbacks, so on the device it must stay IRAM-safe.
+static int64_t (*g_clock)() = esp_timer_get_time;
+
+static inline uint64_t now_us() { return (uint64_t)g_clock(); }
 static inline uint32_t now_s()  { return (uint32_t)(now_us() / 1000000ULL); }
+
+// Random per boot, never 0; journal Session records carry it so a reader can
+// tell a reboot (clock restarted) from a restarted recording.
+static uint32_t boot_id() {
+  static const uint32_t id = esp_random() | 1u;
+  return id;
+}
+
 static inline float clamp01(float x) { return x < 0 ? 0 : (x > 1 ? 1 : x); }
 
 static inline int rssi_bucket(int rssi_dbm) {
@@ -71,32 +137,6 @@ static inline int rssi_bucket(int rssi_dbm) {
   return 0;
 }
 
-static inline void extract_ssid_ie(
-  const uint8_t* payload, int len, int ie_start,
-  uint8_t out_ssid[32], uint8_t* out_len)
-{
-  *out_len = 0;
-  if (!payload || len <= ie_start) return;
-
-  int i = ie_start;
-  while (i + 2 <= len) {
-    uint8_t id = payload[i + 0];
-    uint8_t l  = payload[i + 1];
-    i += 2;
-
-    if (i + l > len) break; // malformed IE list
-
-    if (id == 0) { // SSID
-      uint8_t ncopy = (uint8_t)std::min<int>(l, 32);
-      if (ncopy) memcpy(out_ssid, payload + i, ncopy);
-      *out_len = ncopy; // 0 means hidden
-      return;
-    }
-
-    i += l;
-  }
-}
-
 static bool macToString(const uint8_t mac[6], char out[18]) {
   int n = snprintf(out, 18, "%02X:%02X:%02X:%02X:%02X:%02X",
                    mac[0], mac[1], mac[2], mac[3], mac[4], mac[5]);
@@ -145,19 +185,81 @@ static bool parseKind(const char* s, EntityKind& out) {
 
 // ----------------------------- Model -----------------------------
 
-static Track  g_tracks[MAX_TRACKS];
-static Anchor g_anchors[MAX_ANCHORS];
-static uint16_t g_next_index = 1;
+// Every capacity-sized array below is carved from g_arena in begin()
+// (alloc_tables_unlocked). Until then g_max_tracks/g_max_anchors are 0, so
+// table walks are empty and handle lookups miss.
+static Arena g_arena;
+static int   g_max_tracks  = 0;
+static int   g_max_anchors = 0;
+static int   g_cfg_tracks  = DEFAULT_TRACKS;
+static int   g_cfg_anchors = DEFAULT_ANCHORS;
+static bool  g_cfg_psram   = true;
+
+// Hot state; cold payload in the parallel *_info arrays (see Track.h).
+static Track*      g_tracks      = nullptr;
+static TrackInfo*  g_track_info  = nullptr;
+static Anchor*     g_anchors     = nullptr;
+static AnchorInfo* g_anchor_info = nullptr;
+
+static inline TrackInfo& track_info(const Track& t) { return g_track_info[&t - g_tracks]; }
+static inline AnchorInfo& anchor_info(const Anchor& a) { return g_anchor_info[&a - g_anchors]; }
+
+// Entity handles: slot in the low 16 bits, that slot's generation in the high
+// 16. The generation bumps every time a slot is claimed, so a handle held by
+// the UI stops matching once its slot is recycled. 0 is never a valid handle.
+static uint16_t* g_track_gen  = nullptr;
+static uint16_t* g_anchor_gen = nullptr;
+
+static inline uint32_t next_handle(uint16_t& gen, int slot) {
+  gen = (uint16_t)(gen + 1);
+  if (gen == 0) gen = 1;
+  return ((uint32_t)gen << 16) | (uint32_t)slot;
+}
+
+static inline int handle_slot(uint32_t handle) { return (int)(handle & 0xFFFF); }
+
+// (kind, MAC) -> slot; must be kept in sync whenever in_use changes
+static MacIndex g_track_index;
+static MacIndex g_anchor_index;
+
+// slot recency + free lists; a slot is linked in use exactly when in_use is set
+static RecencyList g_track_lru;
+static RecencyList g_anchor_lru;
+static EvictionPolicy g_evict_policy = EvictionPolicy::ScoreWeightedLru;
+
+// idle-expiry deadlines, re-armed on every sighting
+static TimerWheel g_track_expiry;
+static TimerWheel g_anchor_expiry;
+
+// ids (track slot, or g_max_tracks + anchor slot) whose rank key may have
+// changed since the last publish: claimed, released, observed or re-flagged.
+// Each id is listed at most once. Guarded by g_lock.
+static uint16_t* g_rank_dirty = nullptr;
+static bool*     g_rank_is_dirty = nullptr;
+static int       g_rank_dirty_count = 0;
+
+static inline void rank_mark_unlocked(int id) {
+  if (g_rank_is_dirty[id]) return;
+  g_rank_is_dirty[id] = true;
+  g_rank_dirty[g_rank_dirty_count++] = (uint16_t)id;
+}
+
+static inline void rank_mark_track_unlocked(int i) { rank_mark_unlocked(i); }
+static inline void rank_mark_anchor_unlocked(int i) { rank_mark_unlocked(g_max_tracks + i); }
 
 // env segmentation
 static EnvFingerprint g_last_fp{};
+static int g_fp_width = FP_WIDTH_DEFAULT;
 static uint32_t g_last_env_tick_s = 0;
 static uint32_t g_segment_id = 1;
 static uint32_t g_move_segments = 0;
 
-// crowd estimator
+// crowd estimator: distinct devices per WINDOW_SEC window, per radio. Tracks
+// read g_crowd, the last complete window, when they enter a new window.
 static uint32_t g_current_window = 0;
-static uint32_t g_window_unique_hits = 0;
+static HyperLogLog<CROWD_HLL_P> g_window_wifi;
+static HyperLogLog<CROWD_HLL_P> g_window_ble;
+static CrowdStats g_crowd;
 
 // GPS segmentation (optional)
 static bool   g_gps_valid = false;
@@ -178,6 +280,7 @@ enum class ObsKind : uint8_t {
   BleAdv = 4,
 };
 
+// Decoded form, as applied by the processing task.
 struct Observation {
   ObsKind  kind;
   int8_t   rssi_dbm;
@@ -185,6 +288,10 @@ struct Observation {
   uint8_t  ssid[32];
   uint8_t  ssid_len;
   uint32_t ts_s;
+  uint8_t  channel = 0; // Wi-Fi channel heard on; 0 for BLE, scans and replays
+  uint8_t  count = 1;   // sightings merged into this one; rssi_dbm is their mean
+  int8_t   rssi_min = 0;
+  int8_t   rssi_max = 0;
 
   TrackerType           tracker_type = TrackerType::Unknown;
   GoogleFmnManufacturer tracker_google_mfr = GoogleFmnManufacturer::Unknown;
@@ -198,7 +305,136 @@ struct Observation {
   uint8_t               flock_confidence = 0;
 };
 
-static QueueHandle_t g_obs_q = nullptr;
+// Ring record format: a packed header, plus (BLE ring only) an ObsBleExt block
+// that is meaningful only when a classifier matched. SSIDs and BLE names
+// travel as SsidPool refs. A beacon costs 21 bytes instead of a full
+// Observation, and so does a second's worth of them once coalesced.
+struct __attribute__((packed)) ObsRecord {
+  ObsKind  kind;
+  int8_t   rssi_dbm; // mean over count sightings
+  uint8_t  addr[6];
+  uint32_t ts_s;     // latest sighting
+  uint32_t ssid_ref; // SsidPool ref, 0 = none
+  uint8_t  ext_len;  // 0 or sizeof(ObsBleExt)
+  uint8_t  channel;  // Wi-Fi channel heard on, 0 = n/a
+  uint8_t  count;    // sightings merged into this record, >= 1
+  int8_t   rssi_min;
+  int8_t   rssi_max;
+};
+
+// A record for a single sighting.
+static inline void set_single_rssi(ObsRecord& rec, int8_t rssi_dbm) {
+  rec.rssi_dbm = rec.rssi_min = rec.rssi_max = rssi_dbm;
+  rec.count = 1;
+}
+
+struct __attribute__((packed)) ObsBleExt {
+  TrackerType           tracker_type;
+  GoogleFmnManufacturer tracker_google_mfr;
+  SamsungTrackerSubtype tracker_samsung_subtype;
+  uint8_t               tracker_confidence;
+  GlassesType           glasses_type;
+  uint8_t               glasses_confidence;
+  FlockType             flock_type;
+  uint8_t               flock_confidence;
+};
+
+struct __attribute__((packed)) ObsBleRecord {
+  ObsRecord hdr;
+  ObsBleExt ble;
+};
+
+static constexpr int SSID_POOL_ENTRIES = 64;
+static SsidPool<SSID_POOL_ENTRIES> g_ssid_pool;
+static portMUX_TYPE g_ssid_lock = portMUX_INITIALIZER_UNLOCKED;
+
+// Safe from both the Wi-Fi callback and task context.
+static uint32_t intern_ssid(const uint8_t* ssid, uint8_t len) {
+  if (len == 0) return SsidPool<SSID_POOL_ENTRIES>::NONE;
+  portENTER_CRITICAL_SAFE(&g_ssid_lock);
+  const uint32_t ref = g_ssid_pool.Intern(ssid, len);
+  portEXIT_CRITICAL_SAFE(&g_ssid_lock);
+  return ref;
+}
+
+static void decode_observation(const ObsRecord& rec, const ObsBleExt* ext, Observation& out) {
+  out = Observation{};
+  out.kind = rec.kind;
+  out.rssi_dbm = rec.rssi_dbm;
+  memcpy(out.addr, rec.addr, 6);
+  out.ts_s = rec.ts_s;
+  out.channel = rec.channel;
+  out.count = rec.count;
+  out.rssi_min = rec.rssi_min;
+  out.rssi_max = rec.rssi_max;
+
+  if (rec.ssid_ref != SsidPool<SSID_POOL_ENTRIES>::NONE) {
+    portENTER_CRITICAL(&g_ssid_lock);
+    out.ssid_len = g_ssid_pool.Resolve(rec.ssid_ref, out.ssid);
+    portEXIT_CRITICAL(&g_ssid_lock);
+  }
+
+  if (ext) {
+    out.tracker_type = ext->tracker_type;
+    out.tracker_google_mfr = ext->tracker_google_mfr;
+    out.tracker_samsung_subtype = ext->tracker_samsung_subtype;
+    out.tracker_confidence = ext->tracker_confidence;
+    out.glasses_type = ext->glasses_type;
+    out.glasses_confidence = ext->glasses_confidence;
+    out.flock_type = ext->flock_type;
+    out.flock_confidence = ext->flock_confidence;
+  }
+}
+
+// One SPSC ring per producer, so a burst on one radio can't crowd out the
+// other. The Wi-Fi ring is fed by the promiscuous callback, or by wifi_event
+// when scan mode is used instead; the two are never enabled together.
+static constexpr int WIFI_RING_LEN = 128;
+static constexpr int BLE_RING_LEN  = 64;
+static SpscRing<ObsRecord, WIFI_RING_LEN>    g_wifi_ring;
+static SpscRing<ObsBleRecord, BLE_RING_LEN>  g_ble_ring;
+
+// The sniffer merges repeat sightings of a device before they reach its ring
+// (Coalescer.h). Within COALESCE_MS, one record carries the sighting count
+// and RSSI spread, so the tracker pays one decode and one locked table
+// update where it used to pay ten. The Wi-Fi callback owns the cache and
+// closes expired runs itself every COALESCE_SWEEP_MS. A run therefore
+// reaches the tracker at most about COALESCE_MS + COALESCE_SWEEP_MS after
+// its first frame, as long as frames keep arriving on some channel.
+static constexpr int      COALESCE_SLOTS = 64;
+static constexpr uint32_t COALESCE_MS = 1000;
+static constexpr uint32_t COALESCE_SWEEP_MS = 250;
+using WifiCoalescer = Coalescer<ObsRecord, COALESCE_SLOTS>;
+static WifiCoalescer     g_wifi_coalesce{COALESCE_MS}; // Wi-Fi callback only
+static uint32_t          g_wifi_sweep_ms = 0;          // Wi-Fi callback only
+static std::atomic<bool> g_coalesce_clear{false};
+
+// Observations taken from each ring per round-robin turn.
+static constexpr int DRAIN_WEIGHT_WIFI = 1;
+static constexpr int DRAIN_WEIGHT_BLE  = 1;
+
+static std::atomic<TaskHandle_t> g_proc_task{nullptr};
+static std::atomic<bool>         g_obs_flush{false};
+
+// Producers only signal on an empty -> non-empty transition; the consumer
+// sleeps only after finding every ring empty, so no wakeup is lost.
+static void wake_processing_from_isr() {
+  TaskHandle_t t = g_proc_task.load(std::memory_order_relaxed);
+  if (t) vTaskNotifyGiveFromISR(t, nullptr);
+}
+
+static void wake_processing() {
+  TaskHandle_t t = g_proc_task.load(std::memory_order_relaxed);
+  if (t) xTaskNotifyGive(t);
+}
+
+// Batched drain: up to g_batch_size observations per lock acquisition
+static constexpr int OBS_BATCH_MAX     = 32;
+static constexpr int OBS_BATCH_DEFAULT = 16;
+static int         g_batch_size = OBS_BATCH_DEFAULT;
+static IngestStats g_ingest{};
+static TableStats  g_table_stats{}; // churn counters; live counts filled on read
+static ChannelStats g_chan_stats[WIFI_CHANNELS]; // g_lock; index 0 = WIFI_CH_MIN
 static BleTracker* g_bleTracker = nullptr;
 static BleGlasses* g_bleGlasses = nullptr;
 static BleFlock*   g_bleFlock   = nullptr;
@@ -206,189 +442,405 @@ static BleFlock*   g_bleFlock   = nullptr;
 // ----------------------------- Ignorelist (persistent in-memory) -----------------------------
 
 static constexpr int MAX_IGNORES = 256; // tune as needed
+static constexpr int IGNORE_BUCKETS = 512; // power of two, >= 2x MAX_IGNORES
 
-struct IgnoreEntry {
-  bool    in_use = false;
-  uint8_t addr[6]{};
-};
-
-static IgnoreEntry g_ignores[MAX_IGNORES];
+// Dense list (for persistence) plus a hashed set that the radio callbacks
+// also read lock-free, so ignored MACs are dropped before they are queued.
+static uint8_t g_ignores[MAX_IGNORES][6];
+static int     g_ignore_count = 0;
+static MacFilter<IGNORE_BUCKETS> g_ignore_filter;
 
 static inline void ignore_clear_unlocked() {
-  for (int i = 0; i < MAX_IGNORES; ++i) g_ignores[i] = IgnoreEntry{};
+  g_ignore_count = 0;
+  g_ignore_filter.Clear();
 }
 
 static inline bool ignore_contains_unlocked(const uint8_t mac[6]) {
-  for (int i = 0; i < MAX_IGNORES; ++i) {
-    if (g_ignores[i].in_use && memcmp(g_ignores[i].addr, mac, 6) == 0) return true;
-  }
-  return false;
+  return g_ignore_filter.Contains(mac);
 }
 
 static inline bool ignore_add_unlocked(const uint8_t mac[6]) {
-  // Already present?
-  for (int i = 0; i < MAX_IGNORES; ++i) {
-    if (g_ignores[i].in_use && memcmp(g_ignores[i].addr, mac, 6) == 0) return true;
-  }
-  // Find free slot
-  for (int i = 0; i < MAX_IGNORES; ++i) {
-    if (!g_ignores[i].in_use) {
-      g_ignores[i].in_use = true;
-      memcpy(g_ignores[i].addr, mac, 6);
-      return true;
-    }
-  }
-  return false; // full
+  if (g_ignore_filter.Contains(mac)) return true;
+  if (g_ignore_count >= MAX_IGNORES) return false; // full
+
+  memcpy(g_ignores[g_ignore_count++], mac, 6);
+  g_ignore_filter.Insert(mac);
+  return true;
 }
 
 static inline void ignore_remove_unlocked(const uint8_t mac[6]) {
-  for (int i = 0; i < MAX_IGNORES; ++i) {
-    if (g_ignores[i].in_use && memcmp(g_ignores[i].addr, mac, 6) == 0) {
-      g_ignores[i] = IgnoreEntry{};
-      return;
-    }
+  if (!g_ignore_filter.Contains(mac)) return;
+  g_ignore_filter.Erase(mac);
+
+  for (int i = 0; i < g_ignore_count; ++i) {
+    if (memcmp(g_ignores[i], mac, 6) != 0) continue;
+    // swap-remove keeps the list dense
+    g_ignore_count--;
+    if (i != g_ignore_count) memcpy(g_ignores[i], g_ignores[g_ignore_count], 6);
+    return;
   }
 }
 
 // Ensure current live entities reflect ignore table
 static inline void ignore_apply_to_entities_unlocked() {
-  for (int i = 0; i < MAX_TRACKS; ++i) {
+  for (int i = 0; i < g_max_tracks; ++i) {
     if (!g_tracks[i].in_use) continue;
-    if (ignore_contains_unlocked(g_tracks[i].addr)) SetFlag(g_tracks[i].flags, EntityFlags::Ignoring);
-    else ClearFlag(g_tracks[i].flags, EntityFlags::Ignoring);
+    const bool ignoring = ignore_contains_unlocked(g_tracks[i].addr);
+    if (ignoring == HasFlag(g_tracks[i].flags, EntityFlags::Ignoring)) continue;
+    SetFlag(g_tracks[i].flags, EntityFlags::Ignoring, ignoring);
+    rank_mark_track_unlocked(i);
   }
-  for (int i = 0; i < MAX_ANCHORS; ++i) {
+  for (int i = 0; i < g_max_anchors; ++i) {
     if (!g_anchors[i].in_use) continue;
-    if (ignore_contains_unlocked(g_anchors[i].addr)) SetFlag(g_anchors[i].flags, EntityFlags::Ignoring);
-    else ClearFlag(g_anchors[i].flags, EntityFlags::Ignoring);
+    const bool ignoring = ignore_contains_unlocked(g_anchors[i].addr);
+    if (ignoring == HasFlag(g_anchors[i].flags, EntityFlags::Ignoring)) continue;
+    SetFlag(g_anchors[i].flags, EntityFlags::Ignoring, ignoring);
+    rank_mark_anchor_unlocked(i);
   }
 }
 
 // ----------------------------- Helpers -----------------------------
 
-static float score_track(const Track& t, float stationary_ratio) {
-  float T_min = (float)(t.last_seen_s - t.first_seen_s) / 60.0f;
-  float P = 30.0f * clamp01(log1pf(T_min) / log1pf(T_CAP_MIN));
+// Cached P + R + C (see TrackScore.h); its inputs only change in
+// update_track_from_obs, which marks it stale.
+static inline int32_t track_score_base(Track& t) {
+  if (t.score_stale) {
+    t.score_base = (int16_t)TrackScore::Base(t.last_seen_s - t.first_seen_s, t.seen_windows, t.near_windows,
+                                             t.ema_abs_dev, t.crowd_ema);
+    t.score_stale = false;
+  }
+  return t.score_base;
+}
+
+// Q8 score; stationary_q8 is TrackScore::Stationary(), computed once per pass.
+static int32_t score_track(Track& t, int32_t stationary_q8) {
+  return TrackScore::Combine(track_score_base(t), TrackScore::Coverage(t.env_hits, g_move_segments), stationary_q8);
+}
+
+static inline uint64_t track_key(TrackKind kind, const uint8_t addr[6]) {
+  return MacIndex::MakeKey((uint8_t)kind, addr);
+}
+
+static inline uint64_t anchor_key(const uint8_t addr[6]) {
+  return MacIndex::MakeKey((uint8_t)EntityKind::WifiAp, addr);
+}
+
+static inline Track* find_track_unlocked(TrackKind kind, const uint8_t addr[6]) {
+  int i = g_track_index.Find(track_key(kind, addr));
+  return (i >= 0) ? &g_tracks[i] : nullptr;
+}
+
+static inline Anchor* find_anchor_unlocked(const uint8_t addr[6]) {
+  int i = g_anchor_index.Find(anchor_key(addr));
+  return (i >= 0) ? &g_anchors[i] : nullptr;
+}
+
+// Frees a slot and drops it from the index, recency list and expiry wheel.
+static inline void release_track_unlocked(int i) {
+  g_track_index.Erase(track_key(g_tracks[i].kind, g_tracks[i].addr));
+  g_track_lru.Release(i);
+  g_track_expiry.Cancel(i);
+  rank_mark_track_unlocked(i);
+  g_tracks[i] = Track{};
+  g_track_info[i] = TrackInfo{};
+}
+
+static inline void release_anchor_unlocked(int i) {
+  g_anchor_index.Erase(anchor_key(g_anchors[i].addr));
+  g_anchor_lru.Release(i);
+  g_anchor_expiry.Cancel(i);
+  rank_mark_anchor_unlocked(i);
+  g_anchors[i] = Anchor{};
+  g_anchor_info[i] = AnchorInfo{};
+}
+
+// An entry expires once it has been idle for more than its limit.
+static inline uint32_t track_idle_limit(TrackKind kind) {
+  return (kind == TrackKind::WifiClient) ? TRACK_IDLE_SEC_WIFI : TRACK_IDLE_SEC_BLE;
+}
+
+static inline void arm_track_unlocked(const Track& t) {
+  g_track_expiry.Schedule((int)(&t - g_tracks), t.last_seen_s + track_idle_limit(t.kind) + 1);
+}
+
+static inline void arm_anchor_unlocked(const Anchor& a) {
+  g_anchor_expiry.Schedule((int)(&a - g_anchors), a.last_seen_s + (uint32_t)ANCHOR_IDLE_SEC + 1);
+}
+
+// ----------------------------- Cold tier -----------------------------
+
+// Flash I/O cannot happen under g_lock, so the table code only queues: a
+// track leaving the table is copied into g_cold_spill, and a new track whose
+// key the Bloom filter may have seen is queued in g_cold_fetch. The
+// processing task services both between batches (cold_service). The Bloom
+// filter is fed at spill time, so a re-sighting in the same batch still
+// finds the pending record. Only the processing task touches the filter.
+//
+// Records overwritten on flash stay set in the filter; once it has taken
+// COLD_BLOOM_REBUILD adds it is rebuilt from the keys actually stored, which
+// keeps the false-positive rate near its design point (~3% at 8K keys).
+struct ColdFetch {
+  uint64_t key;
+  uint32_t handle;
+};
+
+static ColdStore g_cold;
+static bool      g_cold_ready = false;
+static BloomFilter<COLD_BLOOM_BITS> g_cold_bloom;
+static ColdRecord g_cold_spill[COLD_QUEUE];
+static int        g_cold_spill_count = 0;
+static ColdFetch  g_cold_fetch[COLD_QUEUE];
+static int        g_cold_fetch_count = 0;
+static ColdStats  g_cold_stats;
+static std::atomic<bool> g_cold_clear{false};
+
+static inline uint16_t sat_u16(uint32_t v) { return (uint16_t)std::min<uint32_t>(v, 0xFFFF); }
+
+// Queues slot i's history before it is released. Watched tracks never leave.
+static void spill_track_unlocked(int i) {
+  const Track& t = g_tracks[i];
+  if (!g_cold_ready || t.seen_windows < (uint32_t)COLD_MIN_WINDOWS) return;
+  if (g_cold_spill_count >= COLD_QUEUE) {
+    g_cold_stats.dropped++;
+    return;
+  }
+
+  ColdRecord& r = g_cold_spill[g_cold_spill_count++];
+  r = ColdRecord{};
+  r.key = track_key(t.kind, t.addr);
+  r.first_seen_s = t.first_seen_s;
+  r.last_seen_s = t.last_seen_s;
+  r.last_window = t.last_window;
+  r.last_segment_id = t.last_segment_id;
+  r.seen_windows = sat_u16(t.seen_windows);
+  r.near_windows = sat_u16(t.near_windows);
+  r.env_hits = sat_u16(t.env_hits);
+  r.crowd = (uint8_t)std::min(255L, lroundf(t.crowd_ema));
+  g_cold_bloom.Add(r.key);
+}
 
-  float f_near = (t.seen_windows > 0) ? ((float)t.near_windows / (float)t.seen_windows) : 0.0f;
-  float stability = clamp01(1.0f - (t.ema_abs_dev / RSSI_DEV_CAP));
-  float R = 25.0f * clamp01(0.7f * f_near + 0.3f * stability);
+// New track: ask for its history if the cold tier may have it.
+static void request_rehydrate_unlocked(const Track& t) {
+  if (!g_cold_ready) return;
+  const uint64_t key = track_key(t.kind, t.addr);
+  if (!g_cold_bloom.MayContain(key)) return;
+  if (g_cold_fetch_count >= COLD_QUEUE) {
+    g_cold_stats.dropped++;
+    return;
+  }
+  g_cold_fetch[g_cold_fetch_count++] = ColdFetch{key, t.handle};
+}
 
-  float move_segments = (float)std::max<uint32_t>(1, g_move_segments);
-  float coverage = (float)t.env_hits / move_segments;
-  float M = 35.0f * clamp01(coverage);
+// Folds stored history into a track that has been live for a few
+// observations; counts for the window/segment both saw are not doubled.
+static void merge_cold_unlocked(Track& t, const ColdRecord& r) {
+  t.first_seen_s = std::min(t.first_seen_s, r.first_seen_s);
 
-  float crowd_norm = clamp01((t.crowd_ema - CROWD_LO) / (CROWD_HI - CROWD_LO));
-  float C = -25.0f * crowd_norm;
+  t.seen_windows += r.seen_windows;
+  if (r.last_window == t.last_window && t.seen_windows > 0) t.seen_windows--;
+  t.near_windows = std::min(t.near_windows + r.near_windows, t.seen_windows);
 
-  float I = -20.0f * clamp01(stationary_ratio);
+  t.env_hits += r.env_hits;
+  if (r.last_segment_id == t.last_segment_id && t.env_hits > 0) t.env_hits--;
 
-  float S = P + R + M + C + I;
-  if (S < 0) S = 0;
-  if (S > 100) S = 100;
-  return S;
+  if (t.crowd_ema == 0.0f) t.crowd_ema = (float)r.crowd;
+  t.score_stale = true;
+  rank_mark_track_unlocked((int)(&t - g_tracks));
 }
 
-static Track* find_or_alloc_track(TrackKind kind, const uint8_t addr[6], uint32_t ts_s) {
+// Processing task, outside g_lock: writes queued spills, then resolves
+// queued lookups and merges hits into tracks that still hold the same handle.
+static void cold_service() {
+  static ColdRecord spill[COLD_QUEUE];
+  static ColdFetch fetch[COLD_QUEUE];
+
+  const bool clear = g_cold_clear.exchange(false);
+  // Both queues are only filled from this task, so an empty check needs no lock.
+  if (!clear && g_cold_spill_count == 0 && g_cold_fetch_count == 0) return;
+
+  portENTER_CRITICAL(&g_lock);
+  if (clear) {
+    g_cold_bloom.Clear();
+    g_cold_spill_count = 0;
+    g_cold_fetch_count = 0;
+  }
+  const int ns = g_cold_spill_count;
+  const int nf = g_cold_fetch_count;
+  memcpy(spill, g_cold_spill, (size_t)ns * sizeof(ColdRecord));
+  memcpy(fetch, g_cold_fetch, (size_t)nf * sizeof(ColdFetch));
+  g_cold_spill_count = 0;
+  g_cold_fetch_count = 0;
+  portEXIT_CRITICAL(&g_lock);
 
-  for (int i = 0; i < MAX_TRACKS; i++) {
-    if (g_tracks[i].in_use && g_tracks[i].kind == kind && memcmp(g_tracks[i].addr, addr, 6) == 0) return &g_tracks[i];
+  if (clear) g_cold.NewSession();
+
+  uint32_t spilled = 0, failed = 0, rehydrated = 0, false_hits = 0;
+  for (int k = 0; k < ns; ++k) {
+    if (g_cold.Put(spill[k])) spilled++;
+    else failed++;
   }
-  for (int i = 0; i < MAX_TRACKS; i++) {
-    if (!g_tracks[i].in_use) {
-      Track& t = g_tracks[i];
-      t = Track{};
-      t.in_use = true;
-      t.kind = kind;
-      memcpy(t.addr, addr, 6);
-      t.vendor = GetVendor(addr);
-      t.flags = EntityFlags::None;
-      if (ignore_contains_unlocked(addr))
-        t.flags |= EntityFlags::Ignoring;
-      t.index = g_next_index++;
-      t.first_seen_s = ts_s;
-      t.last_seen_s  = ts_s;
-      t.last_segment_id = g_segment_id;
-      t.env_hits = 1;
-      return &t;
-    }
+  if (ns > 0) g_cold.Flush();
+
+  if (g_cold_bloom.Count() > COLD_BLOOM_REBUILD) {
+    // This pass's spills are already on flash, so the stored set is complete.
+    g_cold_bloom.Clear();
+    g_cold.ForEachKey([](uint64_t key) { g_cold_bloom.Add(key); });
   }
-  // evict oldest (but never watched)
-  int ev = -1;
-  uint32_t oldest = UINT32_MAX;
 
-  for (int i = 0; i < MAX_TRACKS; i++) {
-    if (!g_tracks[i].in_use) continue;
-    if (HasFlag(g_tracks[i].flags, EntityFlags::Watching)) continue;
+  for (int k = 0; k < nf; ++k) {
+    ColdRecord r;
+    if (!g_cold.Get(fetch[k].key, r)) {
+      false_hits++;
+      continue;
+    }
 
-    if (g_tracks[i].last_seen_s < oldest) { oldest = g_tracks[i].last_seen_s; ev = i; }
+    const int slot = handle_slot(fetch[k].handle);
+    portENTER_CRITICAL(&g_lock);
+    Track& t = g_tracks[slot];
+    if (t.in_use && t.handle == fetch[k].handle) {
+      merge_cold_unlocked(t, r);
+      rehydrated++;
+    }
+    portEXIT_CRITICAL(&g_lock);
   }
 
-  if (ev < 0) return nullptr;
+  portENTER_CRITICAL(&g_lock);
+  g_cold_stats.spilled += spilled;
+  g_cold_stats.failed += failed;
+  g_cold_stats.rehydrated += rehydrated;
+  g_cold_stats.false_hits += false_hits;
+  portEXIT_CRITICAL(&g_lock);
+}
 
-  Track& t = g_tracks[ev];
+// Claims a free slot (no eviction) and indexes it. Caller fills in the rest.
+static Track* claim_track_unlocked(TrackKind kind, const uint8_t addr[6]) {
+  int i = g_track_lru.Claim();
+  if (i < 0) return nullptr;
+  Track& t = g_tracks[i];
   t = Track{};
+  g_track_info[i] = TrackInfo{};
   t.in_use = true;
   t.kind = kind;
+  t.handle = next_handle(g_track_gen[i], i);
   memcpy(t.addr, addr, 6);
-  t.vendor = GetVendor(addr);
-  t.flags = EntityFlags::None;
-  t.index = g_next_index++;
-  t.first_seen_s = ts_s;
-  t.last_seen_s  = ts_s;
-  t.last_segment_id = g_segment_id;
-  t.env_hits = 1;
+  g_track_index.Insert(track_key(kind, addr), i);
+  rank_mark_track_unlocked(i);
   return &t;
 }
 
-static Anchor* find_or_alloc_anchor(const uint8_t bssid[6], uint32_t ts_s) {
+static Anchor* claim_anchor_unlocked(const uint8_t addr[6]) {
+  int i = g_anchor_lru.Claim();
+  if (i < 0) return nullptr;
+  Anchor& a = g_anchors[i];
+  a = Anchor{};
+  g_anchor_info[i] = AnchorInfo{};
+  a.in_use = true;
+  a.handle = next_handle(g_anchor_gen[i], i);
+  memcpy(a.addr, addr, 6);
+  g_anchor_index.Insert(anchor_key(addr), i);
+  rank_mark_anchor_unlocked(i);
+  return &a;
+}
 
-  for (int i = 0; i < MAX_ANCHORS; i++) {
-    if (g_anchors[i].in_use && memcmp(g_anchors[i].addr, bssid, 6) == 0) return &g_anchors[i];
+// Picks a track to evict, walking from the least-recent end. Watched tracks
+// are never evicted (they are few, so skipping them stays cheap). Pure LRU
+// takes the first candidate; score-weighted LRU takes the lowest-scoring of
+// the EVICT_SAMPLE oldest so long-lived, interesting tracks survive churn.
+static int pick_track_victim_unlocked() {
+  int victim = -1;
+  int32_t victim_score = 0;
+  int sampled = 0;
+
+  for (int i = g_track_lru.Oldest(); i >= 0 && sampled < EVICT_SAMPLE; i = g_track_lru.Newer(i)) {
+    if (HasFlag(g_tracks[i].flags, EntityFlags::Watching)) continue;
+    if (g_evict_policy == EvictionPolicy::Lru) return i;
+
+    const int32_t s = score_track(g_tracks[i], 0);
+    if (victim < 0 || s < victim_score) { victim = i; victim_score = s; }
+    sampled++;
   }
-  for (int i = 0; i < MAX_ANCHORS; i++) {
-    if (!g_anchors[i].in_use) {
-      Anchor& a = g_anchors[i];
-      a = Anchor{};
-      a.in_use = true;
-      memcpy(a.addr, bssid, 6);
-      a.vendor = GetVendor(bssid);
-      a.flags = EntityFlags::None;
-      if (ignore_contains_unlocked(bssid))
-        a.flags |= EntityFlags::Ignoring;
-      a.index = g_next_index++;
-      a.last_seen_s = ts_s;
-      a.last_rssi = -100;
-      return &a;
-    }
+  return victim;
+}
+
+// Anchors are not scored, so they are always evicted least-recent first.
+static int pick_anchor_victim_unlocked() {
+  for (int i = g_anchor_lru.Oldest(); i >= 0; i = g_anchor_lru.Newer(i)) {
+    if (!HasFlag(g_anchors[i].flags, EntityFlags::Watching)) return i;
+  }
+  return -1;
+}
+
+static Track* find_or_alloc_track(TrackKind kind, const uint8_t addr[6], uint32_t ts_s, bool* created = nullptr) {
+  if (Track* t = find_track_unlocked(kind, addr)) {
+    g_track_lru.Touch((int)(t - g_tracks));
+    return t;
   }
-  // evict oldest (but never watched)
-  int ev = -1;
-  uint32_t oldest = UINT32_MAX;
 
-  for (int i = 0; i < MAX_ANCHORS; i++) {
-    if (!g_anchors[i].in_use) continue;
-    if (HasFlag(g_anchors[i].flags, EntityFlags::Watching)) continue;
+  Track* t = claim_track_unlocked(kind, addr);
+  if (!t) {
+    int ev = pick_track_victim_unlocked();
+    if (ev < 0) {
+      g_table_stats.rejected++;
+      return nullptr;
+    }
 
-    if (g_anchors[i].last_seen_s < oldest) { oldest = g_anchors[i].last_seen_s; ev = i; }
+    spill_track_unlocked(ev);
+    release_track_unlocked(ev);
+    g_table_stats.track_evictions++;
+    t = claim_track_unlocked(kind, addr);
+  }
+
+  t->vendor = GetVendor(addr);
+  t->flags = EntityFlags::None;
+  if (ignore_contains_unlocked(addr))
+    t->flags |= EntityFlags::Ignoring;
+  t->first_seen_s = ts_s;
+  t->last_seen_s  = ts_s;
+  t->last_segment_id = g_segment_id;
+  t->env_hits = 1;
+  request_rehydrate_unlocked(*t);
+  if (created) *created = true;
+  return t;
+}
+
+static Anchor* find_or_alloc_anchor(const uint8_t bssid[6], uint32_t ts_s, bool* created = nullptr) {
+  if (Anchor* a = find_anchor_unlocked(bssid)) {
+    g_anchor_lru.Touch((int)(a - g_anchors));
+    return a;
   }
 
-  if (ev < 0) return nullptr;
+  Anchor* a = claim_anchor_unlocked(bssid);
+  if (!a) {
+    int ev = pick_anchor_victim_unlocked();
+    if (ev < 0) {
+      g_table_stats.rejected++;
+      return nullptr;
+    }
 
-  Anchor& a = g_anchors[ev];
-  a = Anchor{};
-  a.in_use = true;
-  memcpy(a.addr, bssid, 6);
-  a.vendor = GetVendor(bssid);
-  a.flags = EntityFlags::None;
-  a.index = g_next_index++;
-  a.last_seen_s = ts_s;
-  a.last_rssi = -100;
-  return &a;
+    release_anchor_unlocked(ev);
+    g_table_stats.anchor_evictions++;
+    a = claim_anchor_unlocked(bssid);
+  }
+
+  a->vendor = GetVendor(bssid);
+  a->flags = EntityFlags::None;
+  if (ignore_contains_unlocked(bssid))
+    a->flags |= EntityFlags::Ignoring;
+  a->last_seen_s = ts_s;
+  a->last_rssi = -100;
+  if (created) *created = true;
+  return a;
 }
 
-static void update_track_from_obs(Track& t, int rssi_dbm, uint32_t ts_s) {
+// A coalesced observation stands for count sightings at a mean RSSI. The
+// RSSI EMAs take it as count steps at that mean. The deviation EMA uses the
+// larger of the mean's distance from the EMA and a quarter of the run's
+// spread; a quarter is the mean deviation of a uniform spread.
+static void update_track_from_obs(Track& t, const Observation& obs) {
+  const uint32_t ts_s = obs.ts_s;
+  const int rssi_dbm = obs.rssi_dbm;
   t.last_seen_s = ts_s;
+  arm_track_unlocked(t);
 
   uint32_t window = ts_s / (uint32_t)WINDOW_SEC;
   if (t.last_window != window) {
@@ -397,76 +849,61 @@ static void update_track_from_obs(Track& t, int rssi_dbm, uint32_t ts_s) {
     if (rssi_dbm >= RSSI_NEAR_DBM) t.near_windows++;
 
     float alpha = 0.1f;
-    t.crowd_ema = (1.0f - alpha) * t.crowd_ema + alpha * (float)g_window_unique_hits;
+    t.crowd_ema = (1.0f - alpha) * t.crowd_ema + alpha * (float)g_crowd.total;
   }
 
   float alpha = 0.2f;
+  if (obs.count > 1) alpha = 1.0f - powf(1.0f - alpha, (float)obs.count);
   float prev = t.ema_rssi;
   t.ema_rssi = (1.0f - alpha) * t.ema_rssi + alpha * (float)rssi_dbm;
 
   float dev = fabsf((float)rssi_dbm - prev);
-  float beta = 0.2f;
+  if (obs.count > 1) dev = fmaxf(dev, 0.25f * (float)(obs.rssi_max - obs.rssi_min));
+  float beta = alpha; // same 0.2 per sighting
   t.ema_abs_dev = (1.0f - beta) * t.ema_abs_dev + beta * dev;
 
   if (t.last_segment_id != g_segment_id) {
     t.last_segment_id = g_segment_id;
     t.env_hits++;
   }
+
+  t.score_stale = true;
+  rank_mark_track_unlocked((int)(&t - g_tracks));
 }
 
+static inline uint32_t fp_hash(const uint8_t addr[6], uint32_t salt) {
+  uint64_t x = ((uint64_t)addr[0] << 40) | ((uint64_t)addr[1] << 32) | ((uint64_t)addr[2] << 24) |
+               ((uint64_t)addr[3] << 16) | ((uint64_t)addr[4] << 8) | (uint64_t)addr[5];
+  x ^= (uint64_t)salt << 48;
+  x ^= x >> 30; x *= 0xBF58476D1CE4E5B9ULL;
+  x ^= x >> 27; x *= 0x94D049BB133111EBULL;
+  x ^= x >> 31;
+  return (uint32_t)x;
+}
+
+// Sketches every anchor heard in the last minute, not just the strongest few,
+// so a handful of APs swapping places at the top of a dense RSSI list does
+// not look like movement.
 static EnvFingerprint build_fingerprint(uint32_t ts_s) {
-  struct Tmp { uint8_t addr[6]; int rssi; };
-  static Tmp tmp[MAX_ANCHORS];
-  int n = 0;
+  EnvFingerprint fp;
+  fp.aps.Reset(g_fp_width);
+  fp.bands.Reset(g_fp_width);
 
-  for (int i = 0; i < MAX_ANCHORS; i++) {
+  for (int i = 0; i < g_max_anchors; i++) {
     if (!g_anchors[i].in_use) continue;
     if (ts_s - g_anchors[i].last_seen_s > 60) continue;
-    Tmp _tmp;
-    memcpy(_tmp.addr, g_anchors[i].addr, 6);
-    _tmp.rssi = g_anchors[i].last_rssi;
-    tmp[n++] = _tmp;
-    if (n >= MAX_ANCHORS) break;
-  }
-
-  std::sort(tmp, tmp + n, [](const Tmp& a, const Tmp& b) { return a.rssi > b.rssi; });
-
-  EnvFingerprint fp{};
-  fp.count = std::min(n, FP_TOP_N);
-  for (int i = 0; i < fp.count; i++) {
-    memcpy(fp.items[i].addr, tmp[i].addr, 6);
-    fp.items[i].bucket = (uint8_t)rssi_bucket(tmp[i].rssi);
+    fp.aps.Add(fp_hash(g_anchors[i].addr, 0));
+    fp.bands.Add(fp_hash(g_anchors[i].addr, 1 + (uint32_t)rssi_bucket(g_anchors[i].last_rssi)));
   }
   return fp;
 }
 
+// Same shape as the old top-N overlap score: shared APs, plus a bonus for
+// those still in the same RSSI band.
 static float fp_similarity(const EnvFingerprint& a, const EnvFingerprint& b) {
-  int uni = 0, inter = 0;
-  float bonus = 0.0f;
-
-  auto find_bucket = [](const EnvFingerprint& fp, const uint8_t addr[6], uint8_t& out)->bool {
-    for (int i = 0; i < fp.count; i++) if (memcmp(fp.items[i].addr, addr, 6) == 0) { out = fp.items[i].bucket; return true; }
-    return false;
-  };
-
-  uni += a.count;
-  for (int j = 0; j < b.count; j++) {
-    bool found = false;
-    for (int i = 0; i < a.count; i++) if (memcmp(a.items[i].addr, b.items[j].addr, 6) == 0) { found = true; break; }
-    if (!found) uni++;
-  }
-  if (uni == 0) return 1.0f;
-
-  for (int i = 0; i < a.count; i++) {
-    uint8_t bb = 0;
-    if (find_bucket(b, a.items[i].addr, bb)) {
-      inter++;
-      if (bb == a.items[i].bucket) bonus += 0.25f;
-    }
-  }
-
-  float j = (float)inter / (float)uni;
-  return clamp01(j + (bonus / (float)uni));
+  const float j = BottomK<FP_WIDTH_MAX>::Jaccard(a.aps, b.aps);
+  const float jb = BottomK<FP_WIDTH_MAX>::Jaccard(a.bands, b.bands);
+  return clamp01(j + 0.25f * jb);
 }
 
 static double deg2rad(double d) { return d * 0.017453292519943295; }
@@ -525,29 +962,33 @@ static void maybe_advance_segment(uint32_t ts_s) {
   g_last_fp = fp;
 }
 
+// Only entries whose deadline has passed are visited. Watched entries never
+// expire; they are simply re-armed for another idle period.
 static void expire_tables(uint32_t ts_s) {
   portENTER_CRITICAL(&g_lock);
 
-  for (int i = 0; i < MAX_TRACKS; i++) {
-    if (!g_tracks[i].in_use) continue;
-
-    if (HasFlag(g_tracks[i].flags, EntityFlags::Watching))
-      continue; // watched persists
-
-    uint32_t idle = ts_s - g_tracks[i].last_seen_s;
-    uint32_t limit = (g_tracks[i].kind == TrackKind::WifiClient) ? TRACK_IDLE_SEC_WIFI : TRACK_IDLE_SEC_BLE;
-    if (idle > limit) g_tracks[i].in_use = false;
-  }
-
-  for (int i = 0; i < MAX_ANCHORS; i++) {
-    if (!g_anchors[i].in_use) continue;
-
-    if (HasFlag(g_anchors[i].flags, EntityFlags::Watching))
-      continue; // watched persists
+  g_track_expiry.Advance(ts_s, [ts_s](int i) {
+    Track& t = g_tracks[i];
+    if (!t.in_use) return;
+    if (HasFlag(t.flags, EntityFlags::Watching)) {
+      g_track_expiry.Schedule(i, ts_s + track_idle_limit(t.kind));
+      return;
+    }
+    spill_track_unlocked(i);
+    release_track_unlocked(i);
+    g_table_stats.track_expiries++;
+  });
 
-    if (ts_s - g_anchors[i].last_seen_s > (uint32_t)ANCHOR_IDLE_SEC)
-      g_anchors[i].in_use = false;
-  }
+  g_anchor_expiry.Advance(ts_s, [ts_s](int i) {
+    Anchor& a = g_anchors[i];
+    if (!a.in_use) return;
+    if (HasFlag(a.flags, EntityFlags::Watching)) {
+      g_anchor_expiry.Schedule(i, ts_s + (uint32_t)ANCHOR_IDLE_SEC);
+      return;
+    }
+    release_anchor_unlocked(i);
+    g_table_stats.anchor_expiries++;
+  });
 
   portEXIT_CRITICAL(&g_lock);
 }
@@ -557,39 +998,111 @@ static inline float geo_weight_from_rssi(int rssi_dbm) {
   return 1.0f + 9.0f * clamp01(((float)rssi_dbm + 95.0f) / 60.0f);
 }
 
-static inline void stamp_last_geo(EntityFlags& flags, uint32_t& last_geo_s, double& last_lat, double& last_lon,
-                                  uint32_t ts_s, double gps_lat, double gps_lon)
+static inline void stamp_last_geo(EntityFlags& flags, uint32_t& last_geo_s, int32_t& last_lat_e6, int32_t& last_lon_e6,
+                                  uint32_t ts_s, int32_t gps_lat_e6, int32_t gps_lon_e6)
 {
   flags |= EntityFlags::HasGeo;
   last_geo_s = ts_s;
-  last_lat = gps_lat;
-  last_lon = gps_lon;
+  last_lat_e6 = gps_lat_e6;
+  last_lon_e6 = gps_lon_e6;
 }
 
-static void process_observation(const Observation& obs) {
-  uint32_t window = obs.ts_s / (uint32_t)WINDOW_SEC;
-  if (g_current_window != window) {
-    g_current_window = window;
-    g_window_unique_hits = 0;
+// One step of a running mean kept as whole microdegrees plus a fraction.
+// Only the offset from the mean goes through float, and the step is kept
+// whole rather than rounded to a microdegree, so the mean still moves once
+// w_sum is large and each step is far below 1 µdeg.
+static inline void geo_mean_step(int32_t& mean_e6, float& frac, float k, int32_t x_e6) {
+  frac += k * ((float)(x_e6 - mean_e6) - frac);
+  const int32_t whole = (int32_t)lroundf(frac);
+  mean_e6 += whole;
+  frac -= (float)whole;
+}
+
+static inline void geo_weighted_mean_add(AnchorInfo& info, float w, int32_t lat_e6, int32_t lon_e6) {
+  const float prev = info.w_sum;
+  info.w_sum += w;
+  if (prev <= 0.0f) {
+    info.w_lat_e6 = lat_e6;
+    info.w_lon_e6 = lon_e6;
+    info.w_lat_frac = info.w_lon_frac = 0.0f;
+    return;
   }
-  g_window_unique_hits++;
+  const float k = w / info.w_sum;
+  geo_mean_step(info.w_lat_e6, info.w_lat_frac, k, lat_e6);
+  geo_mean_step(info.w_lon_e6, info.w_lon_frac, k, lon_e6);
+}
 
-  portENTER_CRITICAL(&g_lock);
+// Best estimate of an AP's position: the weighted mean once it has enough
+// samples, else the best pass.
+static inline void anchor_position(const AnchorInfo& info, double& lat, double& lon) {
+  if (info.w_sum >= 3.0f) {
+    lat = GeoFromE6(info.w_lat_e6) + (double)info.w_lat_frac * 1e-6;
+    lon = GeoFromE6(info.w_lon_e6) + (double)info.w_lon_frac * 1e-6;
+  } else {
+    lat = GeoFromE6(info.best_lat_e6);
+    lon = GeoFromE6(info.best_lon_e6);
+  }
+}
+
+// Closes the crowd window when obs moves past it. A gap of one or more
+// empty windows means the last complete window saw nobody.
+static void roll_crowd_window_unlocked(uint32_t window) {
+  if (g_current_window == window) return;
+  // A coalesced run closes up to a second or so after its last sighting, so
+  // it can land after the next window has begun; it counts there. Anything
+  // further back is a clock restart.
+  if (window + 1 == g_current_window) return;
+
+  g_crowd = CrowdStats{};
+  if (window == g_current_window + 1) {
+    g_crowd.wifi = (uint16_t)std::min<uint32_t>(g_window_wifi.Estimate(), 0xFFFF);
+    g_crowd.ble = (uint16_t)std::min<uint32_t>(g_window_ble.Estimate(), 0xFFFF);
+    HyperLogLog<CROWD_HLL_P> all = g_window_wifi;
+    all.Merge(g_window_ble);
+    g_crowd.total = (uint16_t)std::min<uint32_t>(all.Estimate(), 0xFFFF);
+  }
+  g_crowd.window = g_current_window;
+
+  g_current_window = window;
+  g_window_wifi.Clear();
+  g_window_ble.Clear();
+}
 
-  // Copy GPS state atomically under lock
+// Caller holds g_lock.
+// Feeds the channel hopper: every sniffed frame, and whether it put a
+// device in the tables that was not there before.
+static inline void count_channel_unlocked(uint8_t ch, uint8_t frames, bool created) {
+  if (ch < WIFI_CH_MIN || ch > WIFI_CH_MAX) return;
+  ChannelStats& c = g_chan_stats[ch - WIFI_CH_MIN];
+  c.frames += frames;
+  if (created) c.new_devices++;
+}
+
+static void process_observation_unlocked(const Observation& obs) {
+  roll_crowd_window_unlocked(obs.ts_s / (uint32_t)WINDOW_SEC);
+  // Beacons and probe responses are the same AP; count each device once.
+  const ObsKind device = (obs.kind == ObsKind::WifiApProbeResp) ? ObsKind::WifiApBeacon : obs.kind;
+  const uint64_t crowd_key = MacIndex::MakeKey((uint8_t)device, obs.addr);
+  if (obs.kind == ObsKind::BleAdv) g_window_ble.Add(crowd_key);
+  else g_window_wifi.Add(crowd_key);
+
+  // GPS state is consistent while we hold the lock
   const bool gps_valid = g_gps_valid;
-  const double gps_lat = g_gps_lat;
-  const double gps_lon = g_gps_lon;
+  const int32_t gps_lat = gps_valid ? GeoToE6(g_gps_lat) : 0;
+  const int32_t gps_lon = gps_valid ? GeoToE6(g_gps_lon) : 0;
 
     switch (obs.kind) {
     case ObsKind::WifiProbeReq: {
-      Track* t = find_or_alloc_track(TrackKind::WifiClient, obs.addr, obs.ts_s);
+      bool created = false;
+      Track* t = find_or_alloc_track(TrackKind::WifiClient, obs.addr, obs.ts_s, &created);
+      count_channel_unlocked(obs.channel, obs.count, created);
       if (!t) break;
-      update_track_from_obs(*t, obs.rssi_dbm, obs.ts_s);
+      update_track_from_obs(*t, obs);
 
       // NEW: stamp last-seen GPS into the Track
       if (gps_valid) {
-        stamp_last_geo(t->flags, t->last_geo_s, t->last_lat, t->last_lon,
+        TrackInfo& ti = track_info(*t);
+        stamp_last_geo(t->flags, ti.last_geo_s, ti.last_lat_e6, ti.last_lon_e6,
                        obs.ts_s, gps_lat, gps_lon);
       }
     } break;
@@ -597,17 +1110,18 @@ static void process_observation(const Observation& obs) {
     case ObsKind::BleAdv: {
       Track* t = find_or_alloc_track(TrackKind::BleAdv, obs.addr, obs.ts_s);
       if (!t) break;
-      update_track_from_obs(*t, obs.rssi_dbm, obs.ts_s);
+      update_track_from_obs(*t, obs);
+      TrackInfo& ti = track_info(*t);
 
       // NEW: stamp last-seen GPS into the Track
       if (gps_valid) {
-        stamp_last_geo(t->flags, t->last_geo_s, t->last_lat, t->last_lon,
+        stamp_last_geo(t->flags, ti.last_geo_s, ti.last_lat_e6, ti.last_lon_e6,
                        obs.ts_s, gps_lat, gps_lon);
       }
 
       // NEW: apply tracker results without clobbering known values with Unknown
       if (obs.tracker_type != TrackerType::Unknown) {
-        t->tracker_type = obs.tracker_type;
+        ti.tracker_type = obs.tracker_type;
 
         // Optional vendor inference
         if (t->vendor == Vendor::Unknown) {
@@ -615,73 +1129,80 @@ static void process_observation(const Observation& obs) {
         }
       }
       if (obs.tracker_google_mfr != GoogleFmnManufacturer::Unknown)
-        t->tracker_google_mfr = obs.tracker_google_mfr;
+        ti.tracker_google_mfr = obs.tracker_google_mfr;
 
       if (obs.tracker_samsung_subtype != SamsungTrackerSubtype::Unknown)
-        t->tracker_samsung_subtype = obs.tracker_samsung_subtype;
+        ti.tracker_samsung_subtype = obs.tracker_samsung_subtype;
 
-      t->tracker_confidence = max(t->tracker_confidence, obs.tracker_confidence);
+      ti.tracker_confidence = max(ti.tracker_confidence, obs.tracker_confidence);
 
       // Apply glasses results without clobbering known values with Unknown
       if (obs.glasses_type != GlassesType::Unknown) {
-        t->glasses_type = obs.glasses_type;
+        ti.glasses_type = obs.glasses_type;
 
         if (t->vendor == Vendor::Unknown) {
           t->vendor = BleGlasses::GetVendorFromGlassesType(obs.glasses_type);
         }
       }
-      t->glasses_confidence = max(t->glasses_confidence, obs.glasses_confidence);
+      ti.glasses_confidence = max(ti.glasses_confidence, obs.glasses_confidence);
 
-      // Apply flock results. Vendor inference here matters extra: BLE addrs
-      // arrive in NimBLE little-endian order so the MAC-prefix GetVendor()
-      // path in find_or_alloc_track won't match the canonical OUI for BLE.
-      // Inspect() handles the byte order correctly, so we can still tag the
-      // vendor when any BLE signal hits.
+      // Apply flock results. Vendor inference here matters extra: the
+      // MAC-prefix GetVendor() path in find_or_alloc_track may not know the
+      // OUI, but Inspect() also matches the Flock OUI and the adv payload,
+      // so we can still tag the vendor when any BLE signal hits.
       if (obs.flock_type != FlockType::Unknown) {
-        t->flock_type = obs.flock_type;
+        ti.flock_type = obs.flock_type;
 
         if (t->vendor == Vendor::Unknown) {
           t->vendor = BleFlock::GetVendorFromFlockType(obs.flock_type);
         }
       }
-      t->flock_confidence = max(t->flock_confidence, obs.flock_confidence);
+      ti.flock_confidence = max(ti.flock_confidence, obs.flock_confidence);
     } break;
 
     case ObsKind::WifiApBeacon:
     case ObsKind::WifiApProbeResp: {
-      Anchor* a = find_or_alloc_anchor(obs.addr, obs.ts_s);
+      bool created = false;
+      Anchor* a = find_or_alloc_anchor(obs.addr, obs.ts_s, &created);
+      count_channel_unlocked(obs.channel, obs.count, created);
       if (!a) break;
       a->last_seen_s = obs.ts_s;
       a->last_rssi   = obs.rssi_dbm;
+      arm_anchor_unlocked(*a);
+      rank_mark_anchor_unlocked((int)(a - g_anchors));
+
+      AnchorInfo& ai = anchor_info(*a);
 
       if (obs.ssid_len > 0) {
-        uint8_t ncopy = (uint8_t)std::min<size_t>(obs.ssid_len, sizeof(a->ssid));
-        a->ssid_len = ncopy;
-        if (ncopy) memcpy(a->ssid, obs.ssid, ncopy);
+        uint8_t ncopy = (uint8_t)std::min<size_t>(obs.ssid_len, sizeof(ai.ssid));
+        ai.ssid_len = ncopy;
+        if (ncopy) memcpy(ai.ssid, obs.ssid, ncopy);
       }
 
       if (gps_valid) {
         const bool hadGeo = HasFlag(a->flags, EntityFlags::HasGeo);
 
-        stamp_last_geo(a->flags, a->last_geo_s, a->last_lat, a->last_lon,
+        stamp_last_geo(a->flags, ai.last_geo_s, ai.last_lat_e6, ai.last_lon_e6,
                       obs.ts_s, gps_lat, gps_lon);
 
         // best pass
-        if (!hadGeo || obs.rssi_dbm > a->best_rssi) {
-          a->best_rssi = obs.rssi_dbm;
-          a->best_lat  = gps_lat;
-          a->best_lon  = gps_lon;
+        if (!hadGeo || obs.rssi_max > ai.best_rssi) {
+          ai.best_rssi   = obs.rssi_max;
+          ai.best_lat_e6 = gps_lat;
+          ai.best_lon_e6 = gps_lon;
         }
 
-        // weighted avg
-        float w = geo_weight_from_rssi(obs.rssi_dbm);
-        a->w_sum += (double)w;
-        a->w_lat += (double)w * gps_lat;
-        a->w_lon += (double)w * gps_lon;
+        // weighted avg; a coalesced run weighs as its sightings would have
+        geo_weighted_mean_add(ai, geo_weight_from_rssi(obs.rssi_dbm) * (float)obs.count, gps_lat, gps_lon);
       }
     } break;
   }
+}
 
+// Applies a drained batch under a single lock acquisition.
+static void process_batch(const Observation* obs, int n) {
+  portENTER_CRITICAL(&g_lock);
+  for (int i = 0; i < n; i++) process_observation_unlocked(obs[i]);
   portEXIT_CRITICAL(&g_lock);
 }
 
@@ -704,17 +1225,18 @@ static void wifi_event(WiFiEvent_t event, WiFiEventInfo_t info) {
         (WiFi.SSID(i).length() == 0) ? " (hidden)" : ""
       );
       
-      Observation obs{};
-      obs.kind = ObsKind::WifiApBeacon;
-      obs.ts_s = now_s();
-      obs.rssi_dbm = (int8_t)WiFi.RSSI(i);
+      ObsRecord rec{};
+      rec.kind = ObsKind::WifiApBeacon;
+      rec.ts_s = now_s();
+      set_single_rssi(rec, (int8_t)WiFi.RSSI(i));
       String ssid = WiFi.SSID(i);
       const uint8_t* bssid = WiFi.BSSID(i);
-      memcpy(obs.addr, bssid, 6);
-      size_t ncopy = std::min<size_t>(ssid.length(), sizeof(obs.ssid));
-      obs.ssid_len = (uint8_t)ncopy;
-      if (ncopy) memcpy(obs.ssid, ssid.c_str(), ncopy);
-      xQueueSend(g_obs_q, &obs, 0);
+      if (g_ignore_filter.ContainsLockFree(bssid)) continue;
+      memcpy(rec.addr, bssid, 6);
+      size_t ncopy = std::min<size_t>(ssid.length(), 32);
+      rec.ssid_ref = intern_ssid((const uint8_t*)ssid.c_str(), (uint8_t)ncopy);
+      bool was_empty = false;
+      if (g_wifi_ring.Push(rec, &was_empty) && was_empty) wake_processing();
     }
   } else if (n == 0) {
     Serial.println("  (no APs found)");
@@ -729,135 +1251,872 @@ static void wifi_event(WiFiEvent_t event, WiFiEventInfo_t info) {
   WiFi.scanNetworks(true /*async*/, true /*show_hidden*/);
 }
 
-// ----------------------------- Wi-Fi promisc parsing -----------------------------
+// ----------------------------- Snapshot publication -----------------------------
+
+// The processing task publishes a ranked view of the tables; the UI copies
+// the page it shows under a seqlock instead of walking the tables under
+// g_lock at 30 Hz. There are two buffers: readers copy from buf[seq & 1]
+// while a publish fills the other one, taking g_lock for SNAPSHOT_CHUNK
+// entities at a time, and then bumps seq to flip them. seq is the
+// generation; a reader retries only if a flip lands during its copy.
+// The arrays are sized to g_max_tracks + g_max_anchors at begin().
+static constexpr uint32_t SNAPSHOT_MIN_INTERVAL_MS = 33; // ~UI frame rate
+static constexpr int      SNAPSHOT_CHUNK = 32;
+
+struct SnapshotBuffer {
+  int         count = 0;
+  uint32_t    segment_id = 0;
+  uint32_t    move_segments = 0;
+  uint32_t    last_env_tick_s = 0;
+  int16_t*    track_rank = nullptr;  // slot -> position in items, -1 if absent
+  int16_t*    anchor_rank = nullptr;
+  EntityView* items = nullptr;       // best first
+};
+
+struct Snapshot {
+  std::atomic<uint32_t> seq{0};
+  SnapshotBuffer        buf[2];
+};
 
-struct __attribute__((packed)) ieee80211_hdr {
-  uint16_t fc;
-  uint16_t dur;
-  uint8_t  addr1[6];
-  uint8_t  addr2[6];
-  uint8_t  addr3[6];
-  uint16_t sc;
+static Snapshot           g_snap;
+static std::atomic<bool>  g_snap_dirty{true};
+static std::atomic<bool>  g_publish_rebase{false}; // reset(): restart the rate limit
+static std::atomic<float> g_stationary_ratio{0.0f};
+
+// Ranking persists across publishes. Ids are track slots, then g_max_tracks +
+// anchor slot. A publish re-keys only the ids marked in g_rank_dirty, drops
+// them from the order, sorts them and merges them back in, so its cost
+// follows what changed, not the table size. g_lock is held only to take the
+// dirty list and, RANK_CHUNK ids at a time, to read their entities.
+//
+// The key leaves out the stationary penalty: it is the same for every track,
+// changes every frame while the user stands still, and would otherwise
+// re-key every track on each publish. A new segment count changes every
+// track's coverage term, so it does re-key them all. Processing task only.
+static constexpr int RANK_CHUNK = 64;
+
+struct RankKey {
+  uint8_t  tier;   // watched first, ignored last
+  int32_t  score;  // Q8, without the stationary penalty
+  int      rssi;
+  uint32_t handle;
 };
 
-static inline uint8_t fc_type(uint16_t fc)    { return (fc >> 2) & 0x3; }
-static inline uint8_t fc_subtype(uint16_t fc) { return (fc >> 4) & 0xF; }
+static uint16_t* g_rank = nullptr;
+static int       g_rank_count = 0;
+static bool*     g_ranked = nullptr;      // id is in g_rank
+static RankKey*  g_rank_key = nullptr;
+static uint16_t* g_rank_moved = nullptr;  // dirty ids taken by the current publish
+static uint32_t  g_rank_move_segments = 0;
+
+static inline bool rank_in_use_unlocked(int id) {
+  return (id < g_max_tracks) ? g_tracks[id].in_use : g_anchors[id - g_max_tracks].in_use;
+}
+
+static inline uint8_t rank_tier(EntityFlags f) {
+  return (uint8_t)((HasFlag(f, EntityFlags::Watching) ? 0 : 2) + (HasFlag(f, EntityFlags::Ignoring) ? 1 : 0));
+}
+
+static RankKey rank_key_unlocked(int id) {
+  RankKey k{};
+  if (id < g_max_tracks) {
+    Track& t = g_tracks[id];
+    k.tier = rank_tier(t.flags);
+    k.score = score_track(t, 0);
+    k.rssi = (int)lroundf(t.ema_rssi);
+    k.handle = t.handle;
+  } else {
+    const Anchor& a = g_anchors[id - g_max_tracks];
+    k.tier = rank_tier(a.flags);
+    k.score = 0;
+    k.rssi = a.last_rssi;
+    k.handle = a.handle;
+  }
+  return k;
+}
+
+static inline bool rank_before(uint16_t a, uint16_t b) {
+  const RankKey& x = g_rank_key[a];
+  const RankKey& y = g_rank_key[b];
+  if (x.tier != y.tier) return x.tier < y.tier;
+  if (x.score != y.score) return x.score > y.score;
+  if (x.rssi != y.rssi) return x.rssi > y.rssi;
+  if (x.handle != y.handle) return x.handle < y.handle;
+  return a < b;
+}
+
+static void update_ranking() {
+  // A new segment count moves every track's coverage: mark them all.
+  portENTER_CRITICAL(&g_lock);
+  const bool rekey_all = g_move_segments != g_rank_move_segments;
+  g_rank_move_segments = g_move_segments;
+  portEXIT_CRITICAL(&g_lock);
+  for (int c = 0; rekey_all && c < g_max_tracks; c += RANK_CHUNK) {
+    portENTER_CRITICAL(&g_lock);
+    for (int i = c, end = std::min(c + RANK_CHUNK, g_max_tracks); i < end; ++i) {
+      if (g_tracks[i].in_use) rank_mark_track_unlocked(i);
+    }
+    portEXIT_CRITICAL(&g_lock);
+  }
+
+  portENTER_CRITICAL(&g_lock);
+  const int n = g_rank_dirty_count;
+  memcpy(g_rank_moved, g_rank_dirty, (size_t)n * sizeof(uint16_t));
+  for (int k = 0; k < n; ++k) g_rank_is_dirty[g_rank_dirty[k]] = false;
+  g_rank_dirty_count = 0;
+  portEXIT_CRITICAL(&g_lock);
+  if (n == 0) return;
+
+  // Re-key the ids still live, keeping them at the front of g_rank_moved.
+  // An id freed or recycled after this point is marked again for next time.
+  int live = 0, dropped = 0;
+  for (int c = 0; c < n; c += RANK_CHUNK) {
+    portENTER_CRITICAL(&g_lock);
+    for (int k = c, end = std::min(c + RANK_CHUNK, n); k < end; ++k) {
+      const uint16_t id = g_rank_moved[k];
+      if (g_ranked[id]) {
+        g_ranked[id] = false;
+        dropped++;
+      }
+      if (!rank_in_use_unlocked(id)) continue;
+      g_rank_key[id] = rank_key_unlocked(id);
+      g_rank_moved[live++] = id;
+    }
+    portEXIT_CRITICAL(&g_lock);
+  }
+
+  if (dropped > 0) {
+    int w = 0;
+    for (int r = 0; r < g_rank_count; ++r) {
+      if (g_ranked[g_rank[r]]) g_rank[w++] = g_rank[r];
+    }
+    g_rank_count = w;
+  }
+
+  // Merge from the back; ids ranked after the last moved one stay put.
+  std::sort(g_rank_moved, g_rank_moved + live, rank_before);
+  int i = g_rank_count - 1, j = live - 1, w = g_rank_count + live - 1;
+  while (j >= 0) {
+    if (i >= 0 && rank_before(g_rank_moved[j], g_rank[i])) g_rank[w--] = g_rank[i--];
+    else g_rank[w--] = g_rank_moved[j--];
+  }
+  for (int k = 0; k < live; ++k) g_ranked[g_rank_moved[k]] = true;
+  g_rank_count += live;
+}
+
+static void fill_track_view(const Track& t, float score, EntityView& e) {
+  const TrackInfo& ti = track_info(t);
+  e = EntityView{};
+  e.kind = (t.kind == TrackKind::WifiClient) ? EntityKind::WifiClient : EntityKind::BleAdv;
+  e.handle = t.handle;
+  memcpy(e.addr, t.addr, 6);
+  e.vendor = t.vendor;
+  e.flags = t.flags;
+  e.rssi = (int)lroundf(t.ema_rssi);
+  e.age_s = (t.last_seen_s - t.first_seen_s);
+  e.last_seen_s = t.last_seen_s;
+  e.env_hits = t.env_hits;
+  e.seen_windows = t.seen_windows;
+  e.near_windows = t.near_windows;
+  e.crowd = t.crowd_ema;
+  e.score = score;
+  e.tracker_type = ti.tracker_type;
+  e.tracker_google_mfr = ti.tracker_google_mfr;
+  e.tracker_samsung_subtype = ti.tracker_samsung_subtype;
+  e.tracker_confidence = ti.tracker_confidence;
+  e.glasses_type = ti.glasses_type;
+  e.glasses_confidence = ti.glasses_confidence;
+  e.flock_type = ti.flock_type;
+  e.flock_confidence = ti.flock_confidence;
+  if (HasFlag(t.flags, EntityFlags::HasGeo)) {
+    e.lat = GeoFromE6(ti.last_lat_e6);
+    e.lon = GeoFromE6(ti.last_lon_e6);
+  }
+}
+
+// Anchors (APs): showable, but not “suspicious” by default
+static void fill_anchor_view(const Anchor& a, uint32_t ts, EntityView& e) {
+  const AnchorInfo& ai = anchor_info(a);
+  e = EntityView{};
+  e.kind = EntityKind::WifiAp;
+  e.handle = a.handle;
+  memcpy(e.addr, a.addr, 6);
+  e.vendor = a.vendor;
+  e.flags = a.flags;
+  e.ssid_len = std::min<uint8_t>(ai.ssid_len, sizeof(e.ssid) - 1);
+  if (e.ssid_len) memcpy(e.ssid, ai.ssid, e.ssid_len);
+  e.ssid[e.ssid_len] = '\0';
+  e.rssi = a.last_rssi;
+  e.age_s = (ts - a.last_seen_s);
+  e.last_seen_s = a.last_seen_s;
+
+  e.score = 0.0f;           // anchors not “suspicious” by default
+  e.tracker_type = TrackerType::Unknown;
+  e.tracker_google_mfr = GoogleFmnManufacturer::Unknown;
+  e.tracker_samsung_subtype = SamsungTrackerSubtype::Unknown;
+  e.tracker_confidence = 0;
+
+  if (HasFlag(a.flags, EntityFlags::HasGeo)) {
+    anchor_position(ai, e.lat, e.lon);
+  }
+}
+
+// Processing task only (or a host harness driving ingest()). Ranks every
+// live entity at time ts into the back buffer and flips it to the front.
+// Entities are read a chunk at a time, so one that changes mid-publish may
+// show its old rank until the next one.
+static void publish_snapshot(uint32_t ts) {
+  const int32_t stationary_q8 = TrackScore::Stationary(g_stationary_ratio.load(std::memory_order_relaxed));
+
+  update_ranking();
+
+  const uint32_t seq = g_snap.seq.load(std::memory_order_relaxed);
+  SnapshotBuffer& b = g_snap.buf[(seq + 1) & 1];
+  // Readers may still be copying the back buffer from before the last flip;
+  // keep our stores after that flip so they see it and retry.
+  std::atomic_thread_fence(std::memory_order_release);
+
+  memset(b.track_rank, 0xFF, (size_t)g_max_tracks * sizeof(int16_t));
+  memset(b.anchor_rank, 0xFF, (size_t)g_max_anchors * sizeof(int16_t));
+  int count = 0;
+  for (int c = 0; c < g_rank_count; c += SNAPSHOT_CHUNK) {
+    portENTER_CRITICAL(&g_lock);
+    for (int r = c, end = std::min(c + SNAPSHOT_CHUNK, g_rank_count); r < end; ++r) {
+      const int id = g_rank[r];
+      // Freed since it was ranked; the next publish drops it.
+      if (!rank_in_use_unlocked(id)) continue;
+      if (id < g_max_tracks) {
+        Track& t = g_tracks[id];
+        fill_track_view(t, TrackScore::ToFloat(score_track(t, stationary_q8)), b.items[count]);
+        b.track_rank[id] = (int16_t)count;
+      } else {
+        fill_anchor_view(g_anchors[id - g_max_tracks], ts, b.items[count]);
+        b.anchor_rank[id - g_max_tracks] = (int16_t)count;
+      }
+      count++;
+    }
+    portEXIT_CRITICAL(&g_lock);
+  }
+  b.count = count;
+
+  portENTER_CRITICAL(&g_lock);
+  b.segment_id = g_segment_id;
+  b.move_segments = g_move_segments;
+  b.last_env_tick_s = g_last_env_tick_s;
+  portEXIT_CRITICAL(&g_lock);
+
+  g_snap.seq.store(seq + 1, std::memory_order_release);
+}
+
+// Republishes when the tables changed, or once a second so ages and
+// time-based scores keep moving.
+static void maybe_publish_snapshot(uint32_t ts) {
+  static uint32_t last_ms = 0;
+  static uint32_t last_s = 0;
+
+  const uint32_t ms = (uint32_t)(now_us() / 1000ULL);
+  // The clock may have gone back across reset(); publish at once and time
+  // the limit from here.
+  if (g_publish_rebase.exchange(false)) last_ms = ms - SNAPSHOT_MIN_INTERVAL_MS;
+  if (ms - last_ms < SNAPSHOT_MIN_INTERVAL_MS) return;
+  if (!g_snap_dirty.exchange(false) && ts == last_s) return;
+  last_ms = ms;
+  last_s = ts;
+  publish_snapshot(ts);
+}
+
+// ----------------------------- Raw capture -----------------------------
+
+// The radio callbacks copy each management frame / advert into a
+// preallocated ring (one per producer) and return; capture_task encodes
+// pcapng blocks and writes them to SD in whole sectors. A slow card costs
+// captured frames (counted as dropped), never observations.
+struct CaptureWifiFrame {
+  uint64_t ts_us;
+  uint16_t len;        // bytes in data
+  uint16_t orig_len;   // frame length without FCS
+  uint8_t  channel;
+  int8_t   rssi;
+  uint8_t  data[CAPTURE_WIFI_SNAP];
+};
+
+struct CaptureBleFrame {
+  uint64_t ts_us;
+  uint8_t  len;
+  int8_t   rssi;
+  uint8_t  adv_type;   // HCI report event type
+  uint8_t  addr_type;  // BLE_ADDR_*; bit 0 set = random
+  uint8_t  addr[6];    // little-endian, as on air
+  uint8_t  data[CAPTURE_BLE_SNAP];
+};
+
+using CaptureWifiRing = SpscRing<CaptureWifiFrame, CAPTURE_WIFI_RING>;
+using CaptureBleRing = SpscRing<CaptureBleFrame, CAPTURE_BLE_RING>;
+
+static CaptureWifiRing*  g_capture_wifi = nullptr; // allocated by the first startCapture()
+static CaptureBleRing*   g_capture_ble = nullptr;
+static std::atomic<bool> g_capture_on{false};
+static CaptureStats      g_capture_stats;
+static char              g_capture_path[32];
+static TaskHandle_t      g_capture_task = nullptr;
+static StaticTask_t      g_capture_tcb;
+static StackType_t       g_capture_stack[4096 / sizeof(StackType_t)];
+
+// Wi-Fi callback. sig_len counts the FCS, which the driver does not
+// reliably fill in, so it is left out.
+static inline void capture_wifi(const wifi_promiscuous_pkt_t* ppkt) {
+  if (!g_capture_on.load(std::memory_order_acquire)) return;
+  const int frame_len = (int)ppkt->rx_ctrl.sig_len - 4;
+  if (frame_len <= 0) return;
+
+  static CaptureWifiFrame f; // only the Wi-Fi callback uses it
+  f.ts_us = now_us();
+  f.orig_len = (uint16_t)frame_len;
+  f.len = (uint16_t)std::min(frame_len, CAPTURE_WIFI_SNAP);
+  f.channel = (uint8_t)ppkt->rx_ctrl.channel;
+  f.rssi = (int8_t)ppkt->rx_ctrl.rssi;
+  memcpy(f.data, ppkt->payload, f.len);
+  g_capture_wifi->Push(f);
+}
+
+// BLE callback.
+static inline void capture_ble(const NimBLEAdvertisedDevice* dev, const ble_addr_t* addr) {
+  if (!g_capture_on.load(std::memory_order_acquire)) return;
+  const std::vector<uint8_t>& p = dev->getPayload();
+
+  CaptureBleFrame f;
+  f.ts_us = now_us();
+  f.len = (uint8_t)std::min<size_t>(p.size(), CAPTURE_BLE_SNAP);
+  f.rssi = (int8_t)dev->getRSSI();
+  f.adv_type = dev->getAdvType();
+  f.addr_type = addr->type;
+  memcpy(f.addr, addr->val, 6);
+  memcpy(f.data, p.data(), f.len);
+  g_capture_ble->Push(f);
+}
+
+// Writes the whole sectors in buf and moves the remainder to the front;
+// with final, writes everything.
+static size_t capture_write(File& f, uint8_t* buf, size_t used, bool final) {
+  const size_t n = final ? used : used - used % CAPTURE_SECTOR;
+  if (n == 0) return used;
+  const bool ok = f.write(buf, n) == n;
+  portENTER_CRITICAL(&g_lock);
+  if (ok) g_capture_stats.bytes += (uint32_t)n;
+  else g_capture_stats.write_errors++;
+  portEXIT_CRITICAL(&g_lock);
+  memmove(buf, buf + n, used - n);
+  return used - n;
+}
+
+// Each capture goes to a new file, so every write but the last of a file
+// starts on a sector boundary.
+static bool capture_open(File& f) {
+  for (unsigned i = 0; i < 1000; ++i) {
+    snprintf(g_capture_path, sizeof(g_capture_path), PATH_CAPTURE_FMT, i);
+    if (SD.exists(g_capture_path)) continue;
+    f = SD.open(g_capture_path, FILE_WRITE);
+    return (bool)f;
+  }
+  return false;
+}
+
+// Opens a file when capture starts and merges the two rings into it in
+// timestamp order; drains and closes it when capture stops.
+static void capture_task(void*) {
+  static uint8_t buf[CAPTURE_BUF];
+  static_assert(CAPTURE_BUF % CAPTURE_SECTOR == 0, "capture buffer must hold whole sectors");
+  static_assert(Pcapng::WifiBlockSize(CAPTURE_WIFI_SNAP) + CAPTURE_SECTOR <= CAPTURE_BUF,
+                "capture buffer too small for a frame");
+  File f;
+  size_t used = 0;
+  uint32_t last_flush_ms = 0;
+  CaptureWifiFrame w;
+  CaptureBleFrame b;
+  bool have_w = false, have_b = false;
+
+  while (true) {
+    const bool on = g_capture_on.load(std::memory_order_acquire);
+
+    if (on && !f) {
+      if (capture_open(f)) {
+        used = Pcapng::EncodeHeader(buf, CAPTURE_WIFI_SNAP, CAPTURE_BLE_SNAP);
+        last_flush_ms = millis();
+        Serial.printf("[capture] recording to %s\n", g_capture_path);
+      } else {
+        Serial.println("[capture] no file could be created");
+        g_capture_on.store(false, std::memory_order_release);
+        portENTER_CRITICAL(&g_lock);
+        g_capture_stats.write_errors++;
+        portEXIT_CRITICAL(&g_lock);
+      }
+    }
+
+    if (f) {
+      uint32_t frames = 0;
+      while (true) {
+        if (!have_w) have_w = g_capture_wifi->Pop(w);
+        if (!have_b) have_b = g_capture_ble->Pop(b);
+        if (!have_w && !have_b) break;
+
+        if (used + Pcapng::WifiBlockSize(CAPTURE_WIFI_SNAP) > sizeof(buf)) used = capture_write(f, buf, used, false);
+        if (have_w && (!have_b || w.ts_us <= b.ts_us)) {
+          used += Pcapng::EncodeWifi(buf + used, w.ts_us, w.channel, w.rssi, w.data, w.len, w.orig_len);
+          have_w = false;
+        } else {
+          used += Pcapng::EncodeBle(buf + used, b.ts_us, b.rssi, b.adv_type, b.addr_type & 1, b.addr, b.data, b.len);
+          have_b = false;
+        }
+        frames++;
+      }
+      if (frames) {
+        portENTER_CRITICAL(&g_lock);
+        g_capture_stats.frames += frames;
+        portEXIT_CRITICAL(&g_lock);
+      }
+
+      const uint32_t now_ms = millis();
+      used = capture_write(f, buf, used, !on);
+      if (!on) {
+        f.close();
+        Serial.printf("[capture] stopped: %s\n", g_capture_path);
+      } else if (now_ms - last_flush_ms >= (uint32_t)CAPTURE_FLUSH_MS) {
+        f.flush();
+        last_flush_ms = now_ms;
+      }
+    }
+
+    vTaskDelay(pdMS_TO_TICKS(50));
+  }
+}
+
+// ----------------------------- Wi-Fi promisc parsing -----------------------------
+
+static_assert((uint8_t)MgmtKind::ProbeReq == (uint8_t)ObsKind::WifiProbeReq &&
+              (uint8_t)MgmtKind::Beacon == (uint8_t)ObsKind::WifiApBeacon &&
+              (uint8_t)MgmtKind::ProbeResp == (uint8_t)ObsKind::WifiApProbeResp,
+              "MgmtKind must match ObsKind");
+
+static void push_wifi_run(const WifiCoalescer::Run& run) {
+  ObsRecord rec = run.rec;
+  rec.count = run.count;
+  rec.rssi_dbm = run.rssi_mean;
+  rec.rssi_min = run.rssi_min;
+  rec.rssi_max = run.rssi_max;
+
+  bool was_empty = false;
+  if (g_wifi_ring.Push(rec, &was_empty) && was_empty) wake_processing_from_isr();
+}
 
 static void IRAM_ATTR wifi_promisc_cb(void* buf, wifi_promiscuous_pkt_type_t type) {
   if (type != WIFI_PKT_MGMT) return;
 
   const wifi_promiscuous_pkt_t* ppkt = (wifi_promiscuous_pkt_t*)buf;
-  const uint8_t* payload = ppkt->payload;
   const int len = ppkt->rx_ctrl.sig_len;
 
   if (len < 24) return;
+  capture_wifi(ppkt);
+
+  const uint32_t now_ms = (uint32_t)(now_us() / 1000);
+  if (g_coalesce_clear.load(std::memory_order_relaxed) && g_coalesce_clear.exchange(false)) {
+    g_wifi_coalesce.Clear();
+  }
+  if (now_ms - g_wifi_sweep_ms >= COALESCE_SWEEP_MS) {
+    g_wifi_sweep_ms = now_ms;
+    WifiCoalescer::Run runs[8];
+    int n;
+    do {
+      n = g_wifi_coalesce.Expire(now_ms, runs, 8);
+      for (int i = 0; i < n; ++i) push_wifi_run(runs[i]);
+    } while (n == 8);
+  }
+
+  MgmtFrame m;
+  if (!parse_mgmt_frame(ppkt->payload, len, m)) return;
+  if (g_ignore_filter.ContainsLockFree(m.addr)) return;
+
+  ObsRecord rec{};
+  rec.kind = (ObsKind)m.kind;
+  rec.ts_s = now_s();
+  set_single_rssi(rec, (int8_t)ppkt->rx_ctrl.rssi);
+  rec.channel = (uint8_t)ppkt->rx_ctrl.channel;
+  memcpy(rec.addr, m.addr, 6);
+  rec.ssid_ref = intern_ssid(m.ssid, m.ssid_len);
+
+  // Sightings merge only while the channel stays the same, and for APs the
+  // SSID too. A client's probe requests merge across the SSIDs it asks for;
+  // the tracker does not keep those.
+  const uint32_t ssid_key = rec.kind == ObsKind::WifiProbeReq ? 0 : rec.ssid_ref;
+  const uint64_t tag = (uint64_t)ssid_key | ((uint64_t)rec.channel << 32);
+  WifiCoalescer::Run done;
+  if (g_wifi_coalesce.Add((uint8_t)rec.kind, rec.addr, tag, rec.rssi_dbm, rec, now_ms, done)) {
+    push_wifi_run(done);
+  }
+}
+
+// ----------------------------- BLE scanning -----------------------------
+
+class ScanCB : public NimBLEScanCallbacks {
+public:
+  void onResult(const NimBLEAdvertisedDevice* dev) override {
+    ObsBleRecord rec{};
+    rec.hdr.kind = ObsKind::BleAdv;
+    rec.hdr.ts_s = now_s();
+    set_single_rssi(rec.hdr, (int8_t)dev->getRSSI());
+
+    // NimBLE stores ble_addr_t.val in little-endian (val[0]=LSB, val[5]=OUI MSB).
+    // The rest of the pipeline — GetVendor(), IsMacRandomized(), macToString(),
+    // watchlist JSON — assumes canonical big-endian (addr[0]=OUI MSB), matching
+    // how the 802.11 paths fill obs.addr. Reverse on entry so BLE addresses live
+    // in canonical order everywhere downstream.
+    NimBLEAddress a = dev->getAddress();
+    const ble_addr_t* addr_ptr = a.getBase();
+    std::reverse_copy(addr_ptr->val, addr_ptr->val + 6, rec.hdr.addr);
+    capture_ble(dev, addr_ptr);
+
+    // Ignored devices never reach the queue (or the classifiers below).
+    if (g_ignore_filter.ContainsLockFree(rec.hdr.addr)) return;
+
+    // One pass over the AD structures; every classifier reads the view.
+    const std::vector<uint8_t>& p = dev->getPayload();
+    BleAdvert adv;
+    parse_ble_advert(rec.hdr.addr, p.data(), p.size(), adv);
+    rec.hdr.ssid_ref = intern_ssid(adv.name, adv.name_len);
+
+    ObsBleExt& ext = rec.ble;
+
+    if (g_bleTracker) {
+      const TrackerInfo info = g_bleTracker->Inspect(adv);
+      ext.tracker_type = info.type;
+      ext.tracker_google_mfr = info.google_mfr;
+      ext.tracker_samsung_subtype = info.samsung_subtype;
+      ext.tracker_confidence = info.confidence;
+    }
+
+    if (g_bleGlasses) {
+      const GlassesInfo ginfo = g_bleGlasses->Inspect(adv);
+      ext.glasses_type = ginfo.type;
+      ext.glasses_confidence = ginfo.confidence;
+    }
+
+    if (g_bleFlock) {
+      const FlockInfo finfo = g_bleFlock->Inspect(adv);
+      ext.flock_type = finfo.type;
+      ext.flock_confidence = finfo.confidence;
+    }
+
+    // Only carry the classifier block when something matched.
+    const bool matched = ext.tracker_type != TrackerType::Unknown || ext.tracker_confidence ||
+                         ext.glasses_type != GlassesType::Unknown || ext.glasses_confidence ||
+                         ext.flock_type != FlockType::Unknown || ext.flock_confidence;
+    rec.hdr.ext_len = matched ? (uint8_t)sizeof(ObsBleExt) : 0;
+
+    bool was_empty = false;
+    if (g_ble_ring.Push(rec, &was_empty) && was_empty) wake_processing();
+  }
+};
 
-  uint16_t fc = payload[0] | (payload[1] << 8);
-  if (fc_type(fc) != 0) return;
+// ----------------------------- Tasks -----------------------------
 
-  const uint8_t st = fc_subtype(fc);
+// Weighted round robin over the producer rings: each turn takes up to the
+// source's weight from each ring, until the batch is full or all are empty.
+static int drain_rings(Observation* batch, int limit) {
+  if (g_obs_flush.exchange(false)) {
+    g_wifi_ring.Clear();
+    g_ble_ring.Clear();
+  }
 
-  Observation obs{};
-  obs.ts_s = now_s();
-  obs.rssi_dbm = (int8_t)ppkt->rx_ctrl.rssi;
+  int n = 0;
+  bool progress = true;
+  while (n < limit && progress) {
+    progress = false;
+
+    ObsRecord w;
+    for (int k = 0; k < DRAIN_WEIGHT_WIFI && n < limit && g_wifi_ring.Pop(w); ++k) {
+      decode_observation(w, nullptr, batch[n++]);
+      progress = true;
+    }
 
-  const ieee80211_hdr* h = (const ieee80211_hdr*)payload;
+    ObsBleRecord b;
+    for (int k = 0; k < DRAIN_WEIGHT_BLE && n < limit && g_ble_ring.Pop(b); ++k) {
+      const bool has_ext = b.hdr.ext_len == sizeof(ObsBleExt);
+      decode_observation(b.hdr, has_ext ? &b.ble : nullptr, batch[n++]);
+      progress = true;
+    }
+  }
+  return n;
+}
 
-  if (st == 8 || st == 5) {
-    // beacon or probe response:
-    // 24-byte header + 12-byte fixed params = 36
-    const int ie_start = 36;
-    if (len <= ie_start) return;
+// ----------------------------- Observation journal -----------------------------
+
+// The processing task copies each drained batch (and any new GPS fix) into
+// g_journal_ring; journal_task encodes the entries and appends them to SD at
+// low priority. A slow card costs journal records (counted as dropped),
+// never ingest.
+using JournalRing = SpscRing<JournalEntry, JOURNAL_RING>;
+
+static JournalRing*      g_journal_ring = nullptr; // allocated by the first startJournal()
+static std::atomic<bool> g_journal_on{false};
+static JournalStats      g_journal_stats;
+static TaskHandle_t      g_journal_task = nullptr;
+static StaticTask_t      g_journal_tcb;
+static StackType_t       g_journal_stack[4096 / sizeof(StackType_t)];
+
+static void to_journal(const Observation& o, JournalObservation& out) {
+  out.kind = (uint8_t)o.kind;
+  out.rssi_dbm = o.rssi_dbm;
+  out.count = o.count;
+  out.rssi_min = o.rssi_min;
+  out.rssi_max = o.rssi_max;
+  memcpy(out.addr, o.addr, 6);
+  out.ts_s = o.ts_s;
+  out.ssid_len = std::min<uint8_t>(o.ssid_len, 32);
+  memcpy(out.ssid, o.ssid, out.ssid_len);
+  out.tracker_type = o.tracker_type;
+  out.tracker_google_mfr = o.tracker_google_mfr;
+  out.tracker_samsung_subtype = o.tracker_samsung_subtype;
+  out.tracker_confidence = o.tracker_confidence;
+  out.glasses_type = o.glasses_type;
+  out.glasses_confidence = o.glasses_confidence;
+  out.flock_type = o.flock_type;
+  out.flock_confidence = o.flock_confidence;
+}
 
-    obs.kind = (st == 8) ? ObsKind::WifiApBeacon : ObsKind::WifiApProbeResp;
-    memcpy(obs.addr, h->addr3, 6); // BSSID
+static void from_journal(const JournalObservation& o, Observation& out) {
+  out = Observation{};
+  out.kind = (ObsKind)o.kind;
+  out.rssi_dbm = o.rssi_dbm;
+  if (o.count > 1) {
+    out.count = o.count;
+    out.rssi_min = o.rssi_min;
+    out.rssi_max = o.rssi_max;
+  } else {
+    out.rssi_min = out.rssi_max = o.rssi_dbm;
+  }
+  memcpy(out.addr, o.addr, 6);
+  out.ts_s = o.ts_s;
+  out.ssid_len = std::min<uint8_t>(o.ssid_len, 32);
+  memcpy(out.ssid, o.ssid, out.ssid_len);
+  out.tracker_type = o.tracker_type;
+  out.tracker_google_mfr = o.tracker_google_mfr;
+  out.tracker_samsung_subtype = o.tracker_samsung_subtype;
+  out.tracker_confidence = o.tracker_confidence;
+  out.glasses_type = o.glasses_type;
+  out.glasses_confidence = o.glasses_confidence;
+  out.flock_type = o.flock_type;
+  out.flock_confidence = o.flock_confidence;
+}
 
-    extract_ssid_ie(payload, len, ie_start, obs.ssid, &obs.ssid_len);
+// Processing task (the ring's only producer). A fix is recorded when it
+// changes and once at the start of each recording.
+static void journal_batch(const Observation* batch, int n) {
+  static bool recording = false;
+  static JournalFix last_fix;
 
-    xQueueSendFromISR(g_obs_q, &obs, nullptr);
+  if (!g_journal_on.load(std::memory_order_acquire)) {
+    recording = false;
+    return;
   }
-  else if (st == 4) {
-    // probe request: client SA in addr2; IEs begin immediately after header (24)
-    obs.kind = ObsKind::WifiProbeReq;
-    memcpy(obs.addr, h->addr2, 6);
 
-    // OPTIONAL: extract probed SSID(s) (often SSID IE is present, may be empty or wildcard)
-    const int ie_start = 24;
-    if (len > ie_start) {
-      extract_ssid_ie(payload, len, ie_start, obs.ssid, &obs.ssid_len);
-    }
+  JournalEntry e;
+  e.type = JournalType::GnssFix;
+  portENTER_CRITICAL(&g_lock);
+  e.fix.valid = g_gps_valid;
+  e.fix.lat_e6 = g_gps_valid ? GeoToE6(g_gps_lat) : 0;
+  e.fix.lon_e6 = g_gps_valid ? GeoToE6(g_gps_lon) : 0;
+  portEXIT_CRITICAL(&g_lock);
+
+  if (!recording || e.fix.valid != last_fix.valid ||
+      e.fix.lat_e6 != last_fix.lat_e6 || e.fix.lon_e6 != last_fix.lon_e6) {
+    e.fix.ts_s = now_s();
+    last_fix = e.fix;
+    g_journal_ring->Push(e);
+  }
+  recording = true;
 
-    xQueueSendFromISR(g_obs_q, &obs, nullptr);
+  e.type = JournalType::Observation;
+  for (int i = 0; i < n; ++i) {
+    to_journal(batch[i], e.obs);
+    g_journal_ring->Push(e);
   }
 }
 
-// ----------------------------- BLE scanning -----------------------------
+static void journal_write(File& f, const uint8_t* buf, size_t len, uint32_t records) {
+  const bool ok = f.write(buf, len) == len;
+  portENTER_CRITICAL(&g_lock);
+  if (ok) {
+    g_journal_stats.records += records;
+    g_journal_stats.bytes += (uint32_t)len;
+  } else {
+    g_journal_stats.write_errors++;
+  }
+  portEXIT_CRITICAL(&g_lock);
+}
 
-class ScanCB : public NimBLEScanCallbacks {
-public:
-  void onResult(const NimBLEAdvertisedDevice* dev) override {
-    Observation obs{};
-    obs.kind = ObsKind::BleAdv;
-    obs.ts_s = now_s();
-    obs.rssi_dbm = (int8_t)dev->getRSSI();
+// Opens the journal when recording starts, appends whatever the ring holds in
+// JOURNAL_BUF chunks (or when the oldest buffered record is JOURNAL_WRITE_MS
+// old), and drains and closes it when recording stops. Every recording
+// starts with a Session record; a new file also gets the header.
+static void journal_task(void*) {
+  static uint8_t buf[JOURNAL_BUF];
+  File f;
+  size_t used = 0;
+  uint32_t pending = 0;
+  uint32_t last_write_ms = 0, last_flush_ms = 0;
 
-    // NimBLE stores ble_addr_t.val in little-endian (val[0]=LSB, val[5]=OUI MSB).
-    // The rest of the pipeline — GetVendor(), IsMacRandomized(), macToString(),
-    // watchlist JSON — assumes canonical big-endian (addr[0]=OUI MSB), matching
-    // how the 802.11 paths fill obs.addr. Reverse on entry so BLE addresses live
-    // in canonical order everywhere downstream.
-    NimBLEAddress a = dev->getAddress();
-    const ble_addr_t* addr_ptr = a.getBase();
-    std::reverse_copy(addr_ptr->val, addr_ptr->val + 6, obs.addr);
+  while (true) {
+    const bool on = g_journal_on.load(std::memory_order_acquire);
+
+    if (on && !f) {
+      f = SD.open(PATH_JOURNAL, FILE_APPEND);
+      if (f) {
+        if (f.size() == 0) used += Journal::EncodeHeader(buf + used);
+        JournalEntry e;
+        e.type = JournalType::Session;
+        e.session_ts_s = now_s();
+        e.boot_id = boot_id();
+        used += Journal::Encode(e, buf + used);
+        pending++;
+        last_write_ms = last_flush_ms = millis();
+        Serial.printf("[journal] recording to %s\n", PATH_JOURNAL);
+      } else {
+        Serial.printf("[journal] open failed: %s\n", PATH_JOURNAL);
+        g_journal_on.store(false, std::memory_order_release);
+        portENTER_CRITICAL(&g_lock);
+        g_journal_stats.write_errors++;
+        portEXIT_CRITICAL(&g_lock);
+      }
+    }
 
-    const std::vector<uint8_t>& p = dev->getPayload();
-    BleTracker::GetName(p.data(), p.size(), obs.ssid, &obs.ssid_len);
+    if (f) {
+      // Once off, this pass also takes whatever was queued before the
+      // processing task saw the flag.
+      JournalEntry e;
+      while (g_journal_ring->Pop(e)) {
+        if (used + Journal::RECORD_MAX > sizeof(buf)) {
+          journal_write(f, buf, used, pending);
+          used = 0;
+          pending = 0;
+          last_write_ms = millis();
+        }
+        used += Journal::Encode(e, buf + used);
+        pending++;
+      }
 
-    if (g_bleTracker) {
-      const TrackerInfo info = g_bleTracker->Inspect(*dev, obs.ssid, obs.ssid_len);
-      obs.tracker_type = info.type;
-      obs.tracker_google_mfr = info.google_mfr;
-      obs.tracker_samsung_subtype = info.samsung_subtype;
-      obs.tracker_confidence = info.confidence;
-    }
+      const uint32_t now_ms = millis();
+      if (used > 0 && (!on || now_ms - last_write_ms >= (uint32_t)JOURNAL_WRITE_MS)) {
+        journal_write(f, buf, used, pending);
+        used = 0;
+        pending = 0;
+        last_write_ms = now_ms;
+      }
 
-    if (g_bleGlasses) {
-      const GlassesInfo ginfo = g_bleGlasses->Inspect(*dev, obs.ssid, obs.ssid_len);
-      obs.glasses_type = ginfo.type;
-      obs.glasses_confidence = ginfo.confidence;
+      if (!on) {
+        f.close();
+        Serial.printf("[journal] stopped: %s\n", PATH_JOURNAL);
+      } else if (now_ms - last_flush_ms >= (uint32_t)JOURNAL_FLUSH_MS) {
+        f.flush();
+        last_flush_ms = now_ms;
+      }
     }
 
-    if (g_bleFlock) {
-      const FlockInfo finfo = g_bleFlock->Inspect(*dev, obs.ssid, obs.ssid_len);
-      obs.flock_type = finfo.type;
-      obs.flock_confidence = finfo.confidence;
-    }
+    vTaskDelay(pdMS_TO_TICKS(100));
+  }
+}
 
-    xQueueSend(g_obs_q, &obs, 0);
+// One processing pass: applies a batch, then runs segmentation, expiry, the
+// cold tier and snapshot publication for time ts_s. Segmentation and expiry
+// run once per batch rather than per observation.
+static void process_pass(const Observation* batch, int n, uint32_t ts_s) {
+  const int64_t t0 = esp_timer_get_time(); // real cost, whatever the clock
+  if (n > 0) {
+    process_batch(batch, n);
+    g_snap_dirty = true;
   }
-};
+  maybe_advance_segment(ts_s);
+  expire_tables(ts_s);
+  cold_service();
+  maybe_publish_snapshot(ts_s);
 
-// ----------------------------- Tasks -----------------------------
+  if (n > 0) {
+    const uint32_t dt_us = (uint32_t)(esp_timer_get_time() - t0);
+    uint32_t sightings = 0;
+    for (int i = 0; i < n; ++i) sightings += batch[i].count;
+    portENTER_CRITICAL(&g_lock);
+    g_ingest.batches++;
+    g_ingest.observations += (uint32_t)n;
+    g_ingest.sightings += sightings;
+    g_ingest.last_batch = (uint16_t)n;
+    g_ingest.last_batch_us = dt_us;
+    if (dt_us > g_ingest.max_batch_us) g_ingest.max_batch_us = dt_us;
+    portEXIT_CRITICAL(&g_lock);
+  }
+}
 
+// Drains whatever is already queued, up to the batch size; if nothing is,
+// sleeps until a producer signals (or the 250 ms idle tick) and tries again.
 static void processing_task(void*) {
-  Observation obs;
+  static Observation batch[OBS_BATCH_MAX];
   while (true) {
-    if (xQueueReceive(g_obs_q, &obs, pdMS_TO_TICKS(250)) == pdTRUE) {
-      process_observation(obs);
+    const int limit = g_batch_size;
+    int n = drain_rings(batch, limit);
+    if (n == 0) {
+      ulTaskNotifyTake(pdTRUE, pdMS_TO_TICKS(250));
+      n = drain_rings(batch, limit);
     }
-    uint32_t ts_s = now_s();
-    maybe_advance_segment(ts_s);
-    expire_tables(ts_s);
+
+    journal_batch(batch, n);
+    process_pass(batch, n, now_s());
   }
 }
 
+// Channel hopper. Each round visits every channel once: HOP_MS apiece in
+// fixed mode, or the dwell g_hop_sched plans from recent yield in adaptive
+// mode. Both modes feed each round's per-channel results back into the
+// scheduler, so switching is seamless. The processing task counts frames
+// when their coalesced run closes, up to a second or so after they were
+// heard. Attribution is by the channel in the frame's rx_ctrl, so the lag
+// only shifts them into the next round.
+static HopScheduler<WIFI_CHANNELS> g_hop_sched;     // hop task only
+static std::atomic<HopMode> g_hop_mode{HopMode::Adaptive};
+
 static void wifi_hop_task(void*) {
-  uint8_t ch = WIFI_CH_MIN;
+  uint32_t dwell[WIFI_CHANNELS], spent[WIFI_CHANNELS];
+  uint32_t frames[WIFI_CHANNELS], fresh[WIFI_CHANNELS];
+  uint32_t last_frames[WIFI_CHANNELS]{}, last_fresh[WIFI_CHANNELS]{};
+
   while (true) {
-    esp_wifi_set_channel(ch, WIFI_SECOND_CHAN_NONE);
-    ch++;
-    if (ch > WIFI_CH_MAX) ch = WIFI_CH_MIN;
-    vTaskDelay(pdMS_TO_TICKS(HOP_MS));
+    if (g_hop_mode.load(std::memory_order_relaxed) == HopMode::Adaptive) {
+      g_hop_sched.Plan(dwell);
+    } else {
+      for (int i = 0; i < WIFI_CHANNELS; ++i) dwell[i] = HOP_MS;
+    }
+
+    for (int i = 0; i < WIFI_CHANNELS; ++i) {
+      const uint32_t t0 = millis();
+      esp_wifi_set_channel((uint8_t)(WIFI_CH_MIN + i), WIFI_SECOND_CHAN_NONE);
+      vTaskDelay(pdMS_TO_TICKS(dwell[i]));
+      spent[i] = millis() - t0;
+    }
+
+    portENTER_CRITICAL(&g_lock);
+    for (int i = 0; i < WIFI_CHANNELS; ++i) {
+      ChannelStats& c = g_chan_stats[i];
+      frames[i] = c.frames - last_frames[i];
+      fresh[i] = c.new_devices - last_fresh[i];
+      last_frames[i] = c.frames;
+      last_fresh[i] = c.new_devices;
+      c.dwell_ms += spent[i];
+    }
+    portEXIT_CRITICAL(&g_lock);
+
+    g_hop_sched.Update(fresh, frames, spent);
+
+    uint16_t share[WIFI_CHANNELS];
+    for (int i = 0; i < WIFI_CHANNELS; ++i) share[i] = g_hop_sched.ShareQ8(i);
+    portENTER_CRITICAL(&g_lock);
+    for (int i = 0; i < WIFI_CHANNELS; ++i) g_chan_stats[i].share_q8 = share[i];
+    portEXIT_CRITICAL(&g_lock);
   }
 }
 
@@ -933,29 +2192,74 @@ void DeviceTracker::initBleTracker()
   g_bleFlock   = new BleFlock();
 }
 
-static constexpr int OBS_Q_LEN = 64;
-
-// Keep Observation as-is for now (we’ll slim it later if needed).
-static StaticQueue_t g_obs_q_struct;
-static uint8_t g_obs_q_storage[OBS_Q_LEN * sizeof(Observation)];
-
-static void init_obs_queue() {
-  g_obs_q = xQueueCreateStatic(
-      OBS_Q_LEN,
-      sizeof(Observation),
-      g_obs_q_storage,
-      &g_obs_q_struct
-  );
-}
-
 static StaticTask_t g_proc_tcb;
 static StackType_t  g_proc_stack[8192 / sizeof(StackType_t)];
 
 static StaticTask_t g_hop_tcb;
 static StackType_t  g_hop_stack[4096 / sizeof(StackType_t)];
 
+// ----------------------------- Table allocation -----------------------------
+
+// Carves every capacity-sized array from arena. Run once on an empty arena to
+// measure, then again on the reserved block; returns true only for the latter.
+static bool layout_tables(Arena& arena, int tracks, int anchors) {
+  const int ids = tracks + anchors;
+
+  g_tracks      = arena.Alloc<Track>((size_t)tracks);
+  g_track_info  = arena.Alloc<TrackInfo>((size_t)tracks);
+  g_anchors     = arena.Alloc<Anchor>((size_t)anchors);
+  g_anchor_info = arena.Alloc<AnchorInfo>((size_t)anchors);
+  g_track_gen   = arena.Alloc<uint16_t>((size_t)tracks);
+  g_anchor_gen  = arena.Alloc<uint16_t>((size_t)anchors);
+
+  bool ok = g_track_index.Init(arena, MacIndex::BucketsFor(tracks));
+  ok = g_anchor_index.Init(arena, MacIndex::BucketsFor(anchors)) && ok;
+  ok = g_track_lru.Init(arena, tracks) && ok;
+  ok = g_anchor_lru.Init(arena, anchors) && ok;
+  ok = g_track_expiry.Init(arena, tracks) && ok;
+  ok = g_anchor_expiry.Init(arena, anchors) && ok;
+
+  for (SnapshotBuffer& b : g_snap.buf) {
+    b.track_rank  = arena.Alloc<int16_t>((size_t)tracks);
+    b.anchor_rank = arena.Alloc<int16_t>((size_t)anchors);
+    b.items       = arena.Alloc<EntityView>((size_t)ids);
+  }
+  g_rank     = arena.Alloc<uint16_t>((size_t)ids);
+  g_ranked   = arena.Alloc<bool>((size_t)ids);
+  g_rank_key = arena.Alloc<RankKey>((size_t)ids);
+  g_rank_moved = arena.Alloc<uint16_t>((size_t)ids);
+  g_rank_dirty = arena.Alloc<uint16_t>((size_t)ids);
+  g_rank_is_dirty = arena.Alloc<bool>((size_t)ids);
+
+  return ok && !arena.Sizing() && arena.Fits();
+}
+
+// One block for all tables, in PSRAM when configured and available. Called
+// from begin() before any producer or task can touch the tables.
+static bool alloc_tables() {
+  const int tracks = g_cfg_tracks;
+  const int anchors = g_cfg_anchors;
+
+  Arena sizing;
+  layout_tables(sizing, tracks, anchors);
+  if (!g_arena.Reserve(sizing.Used(), g_cfg_psram) || !layout_tables(g_arena, tracks, anchors)) {
+    g_arena.Release();
+    return false;
+  }
+
+  portENTER_CRITICAL(&g_lock);
+  g_max_tracks = tracks;
+  g_max_anchors = anchors;
+  g_rank_count = 0;
+  portEXIT_CRITICAL(&g_lock);
+
+  Serial.printf("[tracker] %d tracks + %d anchors: %u bytes in %s\n", tracks, anchors,
+                (unsigned)g_arena.Used(), g_arena.InPsram() ? "PSRAM" : "internal RAM");
+  return true;
+}
+
 static void start_tasks() {
-  xTaskCreateStaticPinnedToCore(processing_task, "dt_proc",
+  g_proc_task = xTaskCreateStaticPinnedToCore(processing_task, "dt_proc",
       (uint32_t)(sizeof(g_proc_stack)/sizeof(g_proc_stack[0])),
       nullptr, 10, g_proc_stack, &g_proc_tcb, 0);
 
@@ -970,28 +2274,225 @@ static void start_tasks() {
 bool DeviceTracker::begin() {
   Serial.println("DeviceTracker starting...");
 
-  init_obs_queue();
-  if (!g_obs_q) return false;
+  if (!beginCore()) return false;
 
   initWifiSniffer();
   initBleScan();
   initBleTracker();
 
+  start_tasks();
+
+  // expose segment stats
+  _segment_id = g_segment_id;
+  _move_segments = g_move_segments;
+  _last_env_tick_s = g_last_env_tick_s;
+  return true;
+}
+
+bool DeviceTracker::beginCore() {
+  if (g_max_tracks == 0 && !alloc_tables()) {
+    Serial.printf("[tracker] table allocation failed (%d tracks, %d anchors)\n", g_cfg_tracks, g_cfg_anchors);
+    return false;
+  }
+
   readIgnorelist();
   readWatchlist();
 
   //dumpWatchlistFile();
   //outputLists();
 
-  start_tasks();
+  g_cold_ready = g_cold.Begin(SPIFFS, PATH_COLD_STORE, COLD_BUCKETS);
+  if (!g_cold_ready) Serial.println("[cold] store unavailable; idle tracks will be dropped");
+  return true;
+}
 
-  // expose segment stats
-  _segment_id = g_segment_id;
-  _move_segments = g_move_segments;
-  _last_env_tick_s = g_last_env_tick_s;
+void DeviceTracker::setClock(int64_t (*now_us)()) {
+  g_clock = now_us ? now_us : esp_timer_get_time;
+}
+
+void DeviceTracker::ingest(const JournalObservation* obs, int n) {
+  static Observation batch[OBS_BATCH_MAX];
+  const uint32_t ts_s = now_s();
+  int k = 0;
+  bool ran = false;
+  for (int i = 0; i < n; ++i) {
+    // Same filter the radio callbacks apply before queueing.
+    if (g_ignore_filter.ContainsLockFree(obs[i].addr)) continue;
+    from_journal(obs[i], batch[k++]);
+    if (k == OBS_BATCH_MAX) {
+      process_pass(batch, k, ts_s);
+      k = 0;
+      ran = true;
+    }
+  }
+  if (k > 0 || !ran) process_pass(batch, k, ts_s);
+}
+
+void DeviceTracker::publishSnapshot() {
+  g_snap_dirty = false;
+  publish_snapshot(now_s());
+}
+
+bool DeviceTracker::setCapacity(int tracks, int anchors, bool prefer_psram) {
+  if (g_max_tracks != 0) return false; // tables are fixed once allocated
+  g_cfg_tracks = std::max(1, std::min(tracks, TRACKS_LIMIT));
+  g_cfg_anchors = std::max(1, std::min(anchors, ANCHORS_LIMIT));
+  g_cfg_psram = prefer_psram;
+  return true;
+}
+
+int DeviceTracker::trackCapacity() const {
+  return g_max_tracks;
+}
+
+int DeviceTracker::anchorCapacity() const {
+  return g_max_anchors;
+}
+
+void DeviceTracker::setEvictionPolicy(EvictionPolicy policy) {
+  portENTER_CRITICAL(&g_lock);
+  g_evict_policy = policy;
+  portEXIT_CRITICAL(&g_lock);
+}
+
+void DeviceTracker::setFingerprintWidth(int k) {
+  k = std::max(8, std::min(k, FP_WIDTH_MAX));
+  portENTER_CRITICAL(&g_lock);
+  g_fp_width = k;
+  portEXIT_CRITICAL(&g_lock);
+}
+
+void DeviceTracker::setBatchSize(int n) {
+  n = std::max(1, std::min(n, OBS_BATCH_MAX));
+  portENTER_CRITICAL(&g_lock);
+  g_batch_size = n;
+  portEXIT_CRITICAL(&g_lock);
+}
+
+int DeviceTracker::batchSize() const {
+  return g_batch_size;
+}
+
+TableStats DeviceTracker::tableStats() const {
+  portENTER_CRITICAL(&g_lock);
+  TableStats st = g_table_stats;
+  st.tracks = (uint16_t)g_track_lru.Count();
+  st.anchors = (uint16_t)g_anchor_lru.Count();
+  portEXIT_CRITICAL(&g_lock);
+  return st;
+}
+
+HopStats DeviceTracker::hopStats() const {
+  HopStats st;
+  st.mode = g_hop_mode.load(std::memory_order_relaxed);
+  portENTER_CRITICAL(&g_lock);
+  memcpy(st.channel, g_chan_stats, sizeof(st.channel));
+  portEXIT_CRITICAL(&g_lock);
+  return st;
+}
+
+void DeviceTracker::setHopMode(HopMode mode) {
+  g_hop_mode.store(mode, std::memory_order_relaxed);
+}
+
+ColdStats DeviceTracker::coldStats() const {
+  portENTER_CRITICAL(&g_lock);
+  ColdStats st = g_cold_stats;
+  portEXIT_CRITICAL(&g_lock);
+  return st;
+}
+
+bool DeviceTracker::startJournal() {
+  if (!_sdAvailable) {
+    Serial.println("[journal] SD card not available");
+    return false;
+  }
+  if (!g_journal_ring) {
+    g_journal_ring = new (std::nothrow) JournalRing();
+    if (!g_journal_ring) {
+      Serial.println("[journal] out of memory");
+      return false;
+    }
+  }
+  if (!g_journal_task) {
+    g_journal_task = xTaskCreateStaticPinnedToCore(journal_task, "dt_journal",
+        (uint32_t)(sizeof(g_journal_stack)/sizeof(g_journal_stack[0])),
+        nullptr, 1, g_journal_stack, &g_journal_tcb, 0);
+  }
+  g_journal_on.store(true, std::memory_order_release);
+  return true;
+}
+
+void DeviceTracker::stopJournal() {
+  g_journal_on.store(false, std::memory_order_release);
+}
+
+bool DeviceTracker::journalActive() const {
+  return g_journal_on.load(std::memory_order_acquire);
+}
+
+JournalStats DeviceTracker::journalStats() const {
+  portENTER_CRITICAL(&g_lock);
+  JournalStats st = g_journal_stats;
+  portEXIT_CRITICAL(&g_lock);
+  st.dropped = g_journal_ring ? g_journal_ring->Dropped() : 0;
+  return st;
+}
+
+bool DeviceTracker::startCapture() {
+  if (!_sdAvailable) {
+    Serial.println("[capture] SD card not available");
+    return false;
+  }
+  if (!g_capture_wifi) g_capture_wifi = new (std::nothrow) CaptureWifiRing();
+  if (!g_capture_ble) g_capture_ble = new (std::nothrow) CaptureBleRing();
+  if (!g_capture_wifi || !g_capture_ble) {
+    Serial.println("[capture] out of memory");
+    return false;
+  }
+  if (!g_capture_task) {
+    g_capture_task = xTaskCreateStaticPinnedToCore(capture_task, "dt_capture",
+        (uint32_t)(sizeof(g_capture_stack)/sizeof(g_capture_stack[0])),
+        nullptr, 1, g_capture_stack, &g_capture_tcb, 0);
+  }
+  g_capture_on.store(true, std::memory_order_release);
   return true;
 }
 
+void DeviceTracker::stopCapture() {
+  g_capture_on.store(false, std::memory_order_release);
+}
+
+bool DeviceTracker::captureActive() const {
+  return g_capture_on.load(std::memory_order_acquire);
+}
+
+CaptureStats DeviceTracker::captureStats() const {
+  portENTER_CRITICAL(&g_lock);
+  CaptureStats st = g_capture_stats;
+  portEXIT_CRITICAL(&g_lock);
+  st.dropped = (g_capture_wifi ? g_capture_wifi->Dropped() : 0) + (g_capture_ble ? g_capture_ble->Dropped() : 0);
+  return st;
+}
+
+CrowdStats DeviceTracker::crowdStats() const {
+  portENTER_CRITICAL(&g_lock);
+  CrowdStats st = g_crowd;
+  portEXIT_CRITICAL(&g_lock);
+  return st;
+}
+
+IngestStats DeviceTracker::ingestStats() const {
+  portENTER_CRITICAL(&g_lock);
+  IngestStats st = g_ingest;
+  portEXIT_CRITICAL(&g_lock);
+  st.wifi.enqueued = g_wifi_ring.Enqueued();
+  st.wifi.dropped = g_wifi_ring.Dropped();
+  st.ble.enqueued = g_ble_ring.Enqueued();
+  st.ble.dropped = g_ble_ring.Dropped();
+  return st;
+}
+
 void DeviceTracker::setGpsFix(bool valid, double lat, double lon) {
   portENTER_CRITICAL(&g_lock);
   g_gps_valid = valid;
@@ -1004,235 +2505,188 @@ void DeviceTracker::setGpsFix(bool valid, double lat, double lon) {
   portEXIT_CRITICAL(&g_lock);
 }
 
-int DeviceTracker::buildSnapshot(EntityView* out, int maxOut, float stationary_ratio) {
-  int n = 0;
-  uint32_t ts = now_s();
-
-  portENTER_CRITICAL(&g_lock);
+void DeviceTracker::setStationaryRatio(float stationary_ratio) {
+  g_stationary_ratio.store(stationary_ratio, std::memory_order_relaxed);
+}
 
-  // tracks
-  for (int i = 0; i < MAX_TRACKS && n < maxOut; i++) {
-    if (!g_tracks[i].in_use) continue;
-    const Track& t = g_tracks[i];
-
-    EntityView e{};
-    e.kind = (t.kind == TrackKind::WifiClient) ? EntityKind::WifiClient : EntityKind::BleAdv;
-    e.index = t.index;
-    memcpy(e.addr, t.addr, 6);
-    e.vendor = t.vendor;
-    e.flags = t.flags;
-    e.rssi = (int)lroundf(t.ema_rssi);
-    e.age_s = (t.last_seen_s - t.first_seen_s);
-    e.last_seen_s = t.last_seen_s;
-    e.env_hits = t.env_hits;
-    e.seen_windows = t.seen_windows;
-    e.near_windows = t.near_windows;
-    e.crowd = t.crowd_ema;
-    e.score = score_track(t, stationary_ratio);
-    e.tracker_type = t.tracker_type;
-    e.tracker_google_mfr = t.tracker_google_mfr;
-    e.tracker_samsung_subtype = t.tracker_samsung_subtype;
-    e.tracker_confidence = t.tracker_confidence;
-    e.glasses_type = t.glasses_type;
-    e.glasses_confidence = t.glasses_confidence;
-    e.flock_type = t.flock_type;
-    e.flock_confidence = t.flock_confidence;
-    if (HasFlag(t.flags, EntityFlags::HasGeo)) {
-      e.lat = t.last_lat;
-      e.lon = t.last_lon;
-    }
-
-    out[n++] = e;
-  }
-
-  // anchors (APs): showable, but not “suspicious” by default
-  for (int i = 0; i < MAX_ANCHORS && n < maxOut; i++) {
-    if (!g_anchors[i].in_use) continue;
-    const Anchor& a = g_anchors[i];
-
-    EntityView e{};
-    e.kind = EntityKind::WifiAp;
-    e.index = a.index;
-    memcpy(e.addr, a.addr, 6);
-    e.vendor = a.vendor;
-    e.flags = a.flags;
-    e.ssid_len = std::min<uint8_t>(a.ssid_len, sizeof(e.ssid) - 1);
-    if (e.ssid_len) memcpy(e.ssid, a.ssid, e.ssid_len);
-    e.ssid[e.ssid_len] = '\0';
-    e.rssi = a.last_rssi;
-    e.age_s = (ts - a.last_seen_s);
-    e.last_seen_s = a.last_seen_s;
-
-    e.score = 0.0f;           // anchors not “suspicious” by default
-    e.tracker_type = TrackerType::Unknown;
-    e.tracker_google_mfr = GoogleFmnManufacturer::Unknown;
-    e.tracker_samsung_subtype = SamsungTrackerSubtype::Unknown;
-    e.tracker_confidence = 0;
-
-    e.flags = a.flags;
-    if (HasFlag(a.flags, EntityFlags::HasGeo)) {
-      // Prefer weighted average if it has enough samples, else best-pass
-      if (a.w_sum >= 3.0) {
-        e.lat = a.w_lat / a.w_sum;
-        e.lon = a.w_lon / a.w_sum;
-      } else {
-        e.lat = a.best_lat;
-        e.lon = a.best_lon;
-      }
+// Copies ranks [offset, offset+count) of the latest published snapshot; never
+// takes g_lock. The publisher fills the other buffer, so a copy is retried
+// only if a flip lands while it runs.
+int DeviceTracker::topK(EntityView* out, int offset, int count, int* total, uint32_t* generation) {
+  if (offset < 0) offset = 0;
+
+  for (int attempt = 0; ; ++attempt) {
+    const uint32_t s1 = g_snap.seq.load(std::memory_order_acquire);
+    const SnapshotBuffer& b = g_snap.buf[s1 & 1];
+    const int avail = std::max(0, std::min(b.count, g_max_tracks + g_max_anchors));
+    const int n = std::max(0, std::min(count, avail - offset));
+    if (n > 0) memcpy(out, b.items + offset, (size_t)n * sizeof(EntityView));
+    _segment_id = b.segment_id;
+    _move_segments = b.move_segments;
+    _last_env_tick_s = b.last_env_tick_s;
+
+    std::atomic_thread_fence(std::memory_order_acquire);
+    if (g_snap.seq.load(std::memory_order_relaxed) == s1) {
+      if (total) *total = avail;
+      if (generation) *generation = s1;
+      return n;
     }
-
-    out[n++] = e;
+    if (attempt >= 2) vTaskDelay(1);
   }
+}
 
-  portEXIT_CRITICAL(&g_lock);
+// Full ordering on demand (export, dumps); the UI should page with topK().
+int DeviceTracker::buildSnapshot(EntityView* out, int maxOut, float stationary_ratio, uint32_t* generation) {
+  setStationaryRatio(stationary_ratio);
+  return topK(out, 0, maxOut, nullptr, generation);
+}
 
-  std::sort(out, out + n, [](const EntityView& a, const EntityView& b) {
-    bool a_watched = HasFlag(a.flags, EntityFlags::Watching);
-    bool b_watched = HasFlag(b.flags, EntityFlags::Watching);
-    bool a_ignored = HasFlag(a.flags, EntityFlags::Ignoring);
-    bool b_ignored = HasFlag(b.flags, EntityFlags::Ignoring);
-
-    if (a_watched != b_watched) return a_watched > b_watched;
-    if (a_ignored != b_ignored) return a_ignored < b_ignored;
-    if (a.score != b.score) return a.score > b.score;
-    if (a.rssi != b.rssi) return a.rssi > b.rssi;
-    return a.index < b.index;
-  });
+uint32_t DeviceTracker::snapshotGeneration() const {
+  return g_snap.seq.load(std::memory_order_acquire);
+}
 
-  _segment_id = g_segment_id;
-  _move_segments = g_move_segments;
-  _last_env_tick_s = g_last_env_tick_s;
+int DeviceTracker::rankOf(EntityKind kind, uint32_t handle) const {
+  const int slot = handle_slot(handle);
 
-  return n;
+  for (int attempt = 0; ; ++attempt) {
+    const uint32_t s1 = g_snap.seq.load(std::memory_order_acquire);
+    const SnapshotBuffer& b = g_snap.buf[s1 & 1];
+    int r = -1;
+    if (kind == EntityKind::WifiAp) {
+      if (slot < g_max_anchors) r = b.anchor_rank[slot];
+    } else {
+      if (slot < g_max_tracks) r = b.track_rank[slot];
+    }
+    const bool match = r >= 0 && r < b.count && b.items[r].handle == handle && b.items[r].kind == kind;
+
+    std::atomic_thread_fence(std::memory_order_acquire);
+    if (g_snap.seq.load(std::memory_order_relaxed) == s1) return match ? r : -1;
+    if (attempt >= 2) vTaskDelay(1);
+  }
 }
 
+// Applies the UI's watch/ignore flags to the entity named by in->handle.
+// O(1): the handle carries the slot; a stale handle (slot recycled since the
+// snapshot) fails the generation check and is ignored.
 void DeviceTracker::updateEntity(const EntityView* in)
 {
-  portENTER_CRITICAL(&g_lock);
+  const int slot = handle_slot(in->handle);
 
-  if (in->kind == EntityKind::WifiAp)
-  {
-    for (int i = 0; i < MAX_ANCHORS; ++i) {
-      if (!g_anchors[i].in_use) continue;
-      if (g_anchors[i].index != in->index) continue;
-
-      if (HasFlag(in->flags, EntityFlags::Watching))
-        SetFlag(g_anchors[i].flags, EntityFlags::Watching);
-      else
-        ClearFlag(g_anchors[i].flags, EntityFlags::Watching);
-      
-      if (HasFlag(in->flags, EntityFlags::Ignoring))
-        SetFlag(g_anchors[i].flags, EntityFlags::Ignoring);
-      else
-        ClearFlag(g_anchors[i].flags, EntityFlags::Ignoring);
+  portENTER_CRITICAL(&g_lock);
 
-      if (HasFlag(in->flags, EntityFlags::Ignoring))
-        ignore_add_unlocked(g_anchors[i].addr);
-      else
-        ignore_remove_unlocked(g_anchors[i].addr);
+  EntityFlags* flags = nullptr;
+  const uint8_t* addr = nullptr;
+  int id = -1;
 
-      portEXIT_CRITICAL(&g_lock);
-      return;
+  if (in->kind == EntityKind::WifiAp) {
+    if (slot < g_max_anchors && g_anchors[slot].in_use && g_anchors[slot].handle == in->handle) {
+      flags = &g_anchors[slot].flags;
+      addr = g_anchors[slot].addr;
+      id = g_max_tracks + slot;
+    }
+  } else {
+    if (slot < g_max_tracks && g_tracks[slot].in_use && g_tracks[slot].handle == in->handle) {
+      flags = &g_tracks[slot].flags;
+      addr = g_tracks[slot].addr;
+      id = slot;
     }
   }
-  else
-  {
-    for (int i = 0; i < MAX_TRACKS; ++i) {
-      if (!g_tracks[i].in_use) continue;
-      if (g_tracks[i].index != in->index) continue;
 
-      if (HasFlag(in->flags, EntityFlags::Watching))
-        SetFlag(g_tracks[i].flags, EntityFlags::Watching);
-      else
-        ClearFlag(g_tracks[i].flags, EntityFlags::Watching);
-      
-      if (HasFlag(in->flags, EntityFlags::Ignoring))
-        SetFlag(g_tracks[i].flags, EntityFlags::Ignoring);
-      else
-        ClearFlag(g_tracks[i].flags, EntityFlags::Ignoring);
-
-      if (HasFlag(in->flags, EntityFlags::Ignoring))
-        ignore_add_unlocked(g_tracks[i].addr);
-      else
-        ignore_remove_unlocked(g_tracks[i].addr);
+  if (flags) {
+    SetFlag(*flags, EntityFlags::Watching, HasFlag(in->flags, EntityFlags::Watching));
+    SetFlag(*flags, EntityFlags::Ignoring, HasFlag(in->flags, EntityFlags::Ignoring));
+    rank_mark_unlocked(id);
 
-      portEXIT_CRITICAL(&g_lock);
-      return;
-    }
+    if (HasFlag(in->flags, EntityFlags::Ignoring))
+      ignore_add_unlocked(addr);
+    else
+      ignore_remove_unlocked(addr);
   }
 
   portEXIT_CRITICAL(&g_lock);
+
+  if (flags) {
+    g_snap_dirty = true;
+    wake_processing();
+  }
 }
 
 void DeviceTracker::reset()
 {
   // Clear pending observations so we don't immediately repopulate from old data.
-  // NOTE: This may race with ISR producers; if you see issues, consider gating producers
-  // with a global "paused" flag checked before xQueueSend*.
-  if (g_obs_q) {
-    xQueueReset(g_obs_q);
-  }
+  // Only the processing task may pop the rings, so ask it to discard them.
+  // NOTE: a batch already in flight may still land after the tables are
+  // cleared; gate producers with a "paused" flag if that ever matters.
+  g_obs_flush = true;
+  g_coalesce_clear = true;
+  g_cold_clear = true;
+
+  g_publish_rebase = true;
 
   portENTER_CRITICAL(&g_lock);
 
+  // The clock may go back across a reset (a new session in a replay, or a
+  // harness starting over), so the wheels start again from tick 0 and only
+  // the watched entries are re-armed on them.
+  g_track_expiry.Reset();
+  g_anchor_expiry.Reset();
+
   // 1) Clear non-watched tracks/anchors in-place (O(1) extra memory)
-  for (int i = 0; i < MAX_TRACKS; ++i) {
+  for (int i = 0; i < g_max_tracks; ++i) {
     if (!g_tracks[i].in_use) continue;
 
     if (HasFlag(g_tracks[i].flags, EntityFlags::Watching)) {
-      // Leave watched tracks untouched
+      // Keep watched tracks
+      arm_track_unlocked(g_tracks[i]);
       continue;
     }
 
     // Fully clear the slot
-    g_tracks[i] = Track{};
+    release_track_unlocked(i);
   }
 
-  for (int i = 0; i < MAX_ANCHORS; ++i) {
+  for (int i = 0; i < g_max_anchors; ++i) {
     if (!g_anchors[i].in_use) continue;
 
     if (HasFlag(g_anchors[i].flags, EntityFlags::Watching)) {
-      // Leave watched anchors untouched
+      // Keep watched anchors
+      arm_anchor_unlocked(g_anchors[i]);
       continue;
     }
 
-    g_anchors[i] = Anchor{};
+    release_anchor_unlocked(i);
   }
 
-  // 2) Recompute g_next_index so we don't collide with preserved watched entities.
-  //    (Preserves stable indices for watched entities.)
-  uint16_t maxIdx = 0;
-  for (int i = 0; i < MAX_TRACKS; ++i) {
-    if (g_tracks[i].in_use) maxIdx = std::max<uint16_t>(maxIdx, g_tracks[i].index);
-  }
-  for (int i = 0; i < MAX_ANCHORS; ++i) {
-    if (g_anchors[i].in_use) maxIdx = std::max<uint16_t>(maxIdx, g_anchors[i].index);
-  }
-  g_next_index = (uint16_t)(maxIdx + 1);
-  if (g_next_index == 0) g_next_index = 1; // paranoia if maxIdx was 0xFFFF
+  // (Watched entities keep their slots, so their handles stay valid.)
 
-  // 3) Reset env segmentation / movement stats (as before)
+  // 2) Reset env segmentation / movement stats (as before)
   g_last_fp = EnvFingerprint{};
   g_last_env_tick_s = 0;
   g_segment_id = 1;
   g_move_segments = 0;
 
-  // 4) Reset crowd window (as before)
+  // 3) Reset crowd window (as before)
   g_current_window = 0;
-  g_window_unique_hits = 0;
+  g_window_wifi.Clear();
+  g_window_ble.Clear();
+  g_crowd = CrowdStats{};
 
-  // 5) Reset GPS segmentation anchor (keep current GPS fix validity as-is)
+  // 4) Reset GPS segmentation anchor (keep current GPS fix validity as-is)
   g_gps_anchor_valid = false;
   g_last_gps_seg_s = 0;
 
   portEXIT_CRITICAL(&g_lock);
 
+  g_snap_dirty = true;
+  wake_processing();
+
   // Expose reset stats
   _segment_id = g_segment_id;
   _move_segments = g_move_segments;
   _last_env_tick_s = g_last_env_tick_s;
 }
 
+#ifndef PIGTAIL_NO_JSON
 bool DeviceTracker::readWatchlist()
 {
   fs::FS& fs = SPIFFS;
@@ -1296,46 +2750,36 @@ bool DeviceTracker::readWatchlist()
     }
 
     if (ek == EntityKind::WifiAp) {
-      Anchor* a = nullptr;
-
-      for (int i = 0; i < MAX_ANCHORS; ++i) {
-        if (g_anchors[i].in_use && memcmp(g_anchors[i].addr, mac_temp, 6) == 0) { a = &g_anchors[i]; break; }
-      }
+      Anchor* a = find_anchor_unlocked(mac_temp);
 
       if (!a) {
-        for (int i = 0; i < MAX_ANCHORS; ++i) {
-          if (!g_anchors[i].in_use) {
-            Anchor& na = g_anchors[i];
-            na = Anchor{};
-            na.in_use = true;
-            memcpy(na.addr, mac_temp, 6);
-            na.vendor = GetVendor(mac_temp);
-            na.flags  = EntityFlags::None;
-            na.index  = g_next_index++;
-            na.last_seen_s = ts;
-            na.last_rssi   = -95;
-            a = &na;
-            break;
-          }
+        a = claim_anchor_unlocked(mac_temp);
+        if (a) {
+          a->vendor = GetVendor(mac_temp);
+          a->flags  = EntityFlags::None;
+          a->last_seen_s = ts;
+          a->last_rssi   = -95;
+          arm_anchor_unlocked(*a);
         }
       }
 
       if (!a) { skipped++; continue; }
 
       a->flags |= EntityFlags::Watching;
+      AnchorInfo& ai = anchor_info(*a);
 
       if (it["ssid"].is<const char*>()) {
         const char* ss = it["ssid"];
-        size_t n = std::min<size_t>(strlen(ss), sizeof(a->ssid));
-        a->ssid_len = (uint8_t)n;
-        if (n) memcpy(a->ssid, ss, n);
+        size_t n = std::min<size_t>(strlen(ss), sizeof(ai.ssid));
+        ai.ssid_len = (uint8_t)n;
+        if (n) memcpy(ai.ssid, ss, n);
       }
 
       if (it["lat"].is<double>() && it["lon"].is<double>()) {
-        a->best_lat  = (double)it["lat"];
-        a->best_lon  = (double)it["lon"];
-        a->best_rssi = -127;
-        a->w_sum = 0.0; a->w_lat = 0.0; a->w_lon = 0.0;
+        ai.best_lat_e6 = GeoToE6((double)it["lat"]);
+        ai.best_lon_e6 = GeoToE6((double)it["lon"]);
+        ai.best_rssi = -127;
+        ai.w_sum = 0.0f; ai.w_lat_e6 = 0; ai.w_lon_e6 = 0; ai.w_lat_frac = 0.0f; ai.w_lon_frac = 0.0f;
         a->flags |= EntityFlags::HasGeo;
       }
 
@@ -1343,88 +2787,79 @@ bool DeviceTracker::readWatchlist()
     }
     else {
       TrackKind tk = (ek == EntityKind::BleAdv) ? TrackKind::BleAdv : TrackKind::WifiClient;
-      Track* t = nullptr;
-
-      for (int i = 0; i < MAX_TRACKS; ++i) {
-        if (g_tracks[i].in_use && g_tracks[i].kind == tk && memcmp(g_tracks[i].addr, mac_temp, 6) == 0) { t = &g_tracks[i]; break; }
-      }
+      Track* t = find_track_unlocked(tk, mac_temp);
 
       if (!t) {
-        for (int i = 0; i < MAX_TRACKS; ++i) {
-          if (!g_tracks[i].in_use) {
-            Track& nt = g_tracks[i];
-            nt = Track{};
-            nt.in_use = true;
-            nt.kind   = tk;
-            memcpy(nt.addr, mac_temp, 6);
-            nt.vendor = GetVendor(mac_temp);
-            nt.flags  = EntityFlags::None;
-            nt.index  = g_next_index++;
-            nt.first_seen_s = ts;
-            nt.last_seen_s  = ts;
-            nt.ema_rssi     = -95.0f;
-            t = &nt;
-
-            if (it["lat"].is<double>() && it["lon"].is<double>()) {
-              t->last_lat = (double)it["lat"];
-              t->last_lon = (double)it["lon"];
-              t->last_geo_s = ts;
-              t->flags |= EntityFlags::HasGeo;
-            }
-            break;
+        t = claim_track_unlocked(tk, mac_temp);
+        if (t) {
+          t->vendor = GetVendor(mac_temp);
+          t->flags  = EntityFlags::None;
+          t->first_seen_s = ts;
+          t->last_seen_s  = ts;
+          t->ema_rssi     = -95.0f;
+          arm_track_unlocked(*t);
+
+          if (it["lat"].is<double>() && it["lon"].is<double>()) {
+            TrackInfo& ti = track_info(*t);
+            ti.last_lat_e6 = GeoToE6((double)it["lat"]);
+            ti.last_lon_e6 = GeoToE6((double)it["lon"]);
+            ti.last_geo_s = ts;
+            t->flags |= EntityFlags::HasGeo;
           }
         }
       }
 
       if (!t) { skipped++; continue; }
 
+      TrackInfo& ti = track_info(*t);
+
       // ---- Restore tracker fields (optional) ----
       // Keep each independent; you can choose to "sanitize" later if desired.
       if (it["tracker_type"].is<const char*>()) {
         TrackerType tt{};
         if (BleTracker::ParseTrackerType(it["tracker_type"].as<const char*>(), tt)) {
-          t->tracker_type = tt;
+          ti.tracker_type = tt;
         }
       }
 
       if (it["tracker_google_mfr"].is<const char*>()) {
         GoogleFmnManufacturer gm{};
         if (BleTracker::ParseGoogleMfr(it["tracker_google_mfr"].as<const char*>(), gm)) {
-          t->tracker_google_mfr = gm;
+          ti.tracker_google_mfr = gm;
         }
       }
 
       if (it["tracker_samsung_subtype"].is<const char*>()) {
         SamsungTrackerSubtype ss{};
         if (BleTracker::ParseSamsungSubtype(it["tracker_samsung_subtype"].as<const char*>(), ss)) {
-          t->tracker_samsung_subtype = ss;
+          ti.tracker_samsung_subtype = ss;
         }
       }
 
       if (it["tracker_confidence"].is<uint8_t>()) {
-        t->tracker_confidence = it["tracker_confidence"].as<uint8_t>();
+        ti.tracker_confidence = it["tracker_confidence"].as<uint8_t>();
       }
 
       if (it["glasses_type"].is<const char*>()) {
         GlassesType gt{};
         if (BleGlasses::ParseGlassesType(it["glasses_type"].as<const char*>(), gt)) {
-          t->glasses_type = gt;
+          ti.glasses_type = gt;
         }
       }
 
       if (it["glasses_confidence"].is<uint8_t>()) {
-        t->glasses_confidence = it["glasses_confidence"].as<uint8_t>();
+        ti.glasses_confidence = it["glasses_confidence"].as<uint8_t>();
       }
 
       if (it["flock_type"].is<const char*>()) {
         FlockType ft{};
         if (BleFlock::ParseFlockType(it["flock_type"].as<const char*>(), ft)) {
-          t->flock_type = ft;
+          ti.flock_type = ft;
         }
       }
 
       if (it["flock_confidence"].is<uint8_t>()) {
-        t->flock_confidence = it["flock_confidence"].as<uint8_t>();
+        ti.flock_confidence = it["flock_confidence"].as<uint8_t>();
       }
 
       t->flags |= EntityFlags::Watching;
@@ -1432,13 +2867,6 @@ bool DeviceTracker::readWatchlist()
     }
   }
 
-  // Fix next index
-  uint16_t maxIdx = 0;
-  for (int i = 0; i < MAX_TRACKS; ++i)  if (g_tracks[i].in_use)  maxIdx = std::max<uint16_t>(maxIdx, g_tracks[i].index);
-  for (int i = 0; i < MAX_ANCHORS; ++i) if (g_anchors[i].in_use) maxIdx = std::max<uint16_t>(maxIdx, g_anchors[i].index);
-  g_next_index = (uint16_t)(maxIdx + 1);
-  if (g_next_index == 0) g_next_index = 1;
-
   portEXIT_CRITICAL(&g_lock);
 
   Serial.printf("[watchlist] json=%u applied=%u skipped=%u\n",
@@ -1446,6 +2874,13 @@ bool DeviceTracker::readWatchlist()
 
   return applied > 0;
 }
+#else
+bool DeviceTracker::readWatchlist()
+{
+  Serial.println("[watchlist] built without ArduinoJson; not loaded");
+  return false;
+}
+#endif
 
 void DeviceTracker::dumpWatchlistFile() {
   fs::FS& fs = SPIFFS;
@@ -1461,27 +2896,27 @@ void DeviceTracker::outputLists()
 {
   portENTER_CRITICAL(&g_lock);
 
-  for (int i=0;i<MAX_TRACKS;i++) {
+  for (int i=0;i<g_max_tracks;i++) {
     if (g_tracks[i].in_use && HasFlag(g_tracks[i].flags, EntityFlags::Watching)) {
       macToString(g_tracks[i].addr, mac_temp_str);
-      Serial.printf("[watch] Track kind=%d idx=%u mac=%s flags=0x%X tt=%s gm=%s ss=%s gt=%s ft=%s\n",
+      Serial.printf("[watch] Track kind=%d handle=%08X mac=%s flags=0x%X tt=%s gm=%s ss=%s gt=%s ft=%s\n",
         (int)g_tracks[i].kind,
-        g_tracks[i].index,
+        (unsigned)g_tracks[i].handle,
         mac_temp_str,
         (unsigned)g_tracks[i].flags,
-        BleTracker::TrackerTypeName(g_tracks[i].tracker_type),
-        BleTracker::GoogleMfrName(g_tracks[i].tracker_google_mfr),
-        BleTracker::SamsungSubtypeName(g_tracks[i].tracker_samsung_subtype),
-        BleGlasses::GlassesTypeName(g_tracks[i].glasses_type),
-        BleFlock::FlockTypeName(g_tracks[i].flock_type));
+        BleTracker::TrackerTypeName(g_track_info[i].tracker_type),
+        BleTracker::GoogleMfrName(g_track_info[i].tracker_google_mfr),
+        BleTracker::SamsungSubtypeName(g_track_info[i].tracker_samsung_subtype),
+        BleGlasses::GlassesTypeName(g_track_info[i].glasses_type),
+        BleFlock::FlockTypeName(g_track_info[i].flock_type));
     }
   }
 
-  for (int i=0;i<MAX_ANCHORS;i++) {
+  for (int i=0;i<g_max_anchors;i++) {
     if (g_anchors[i].in_use && HasFlag(g_anchors[i].flags, EntityFlags::Watching)) {
       macToString(g_anchors[i].addr, mac_temp_str);
-      Serial.printf("[watch] Anchor idx=%u mac=%s ssid_len=%u flags=0x%X\n",
-        g_anchors[i].index, mac_temp_str, g_anchors[i].ssid_len, (unsigned)g_anchors[i].flags);
+      Serial.printf("[watch] Anchor handle=%08X mac=%s ssid_len=%u flags=0x%X\n",
+        (unsigned)g_anchors[i].handle, mac_temp_str, g_anchor_info[i].ssid_len, (unsigned)g_anchors[i].flags);
     }
   }
 
@@ -1522,7 +2957,7 @@ bool DeviceTracker::writeWatchlist()
   bool first = true;
 
   // ---------- Anchors ----------
-  for (int i = 0; i < MAX_ANCHORS; ++i) {
+  for (int i = 0; i < g_max_anchors; ++i) {
     bool in_use = false;
     bool watching = false;
     uint8_t ssid_len = 0;
@@ -1536,18 +2971,12 @@ bool DeviceTracker::writeWatchlist()
       if (watching) {
         memcpy(mac_temp, g_anchors[i].addr, 6);
 
-        ssid_len = std::min<uint8_t>(g_anchors[i].ssid_len, (uint8_t)sizeof(ssid_temp));
-        if (ssid_len) memcpy(ssid_temp, g_anchors[i].ssid, ssid_len);
+        ssid_len = std::min<uint8_t>(g_anchor_info[i].ssid_len, (uint8_t)sizeof(ssid_temp));
+        if (ssid_len) memcpy(ssid_temp, g_anchor_info[i].ssid, ssid_len);
 
         hasGeo = HasFlag(g_anchors[i].flags, EntityFlags::HasGeo);
         if (hasGeo) {
-          if (g_anchors[i].w_sum >= 3.0) {
-            lat = g_anchors[i].w_lat / g_anchors[i].w_sum;
-            lon = g_anchors[i].w_lon / g_anchors[i].w_sum;
-          } else {
-            lat = g_anchors[i].best_lat;
-            lon = g_anchors[i].best_lon;
-          }
+          anchor_position(g_anchor_info[i], lat, lon);
         }
       }
     }
@@ -1579,7 +3008,7 @@ bool DeviceTracker::writeWatchlist()
   }
 
   // ---------- Tracks ----------
-  for (int i = 0; i < MAX_TRACKS; ++i) {
+  for (int i = 0; i < g_max_tracks; ++i) {
     bool in_use = false;
     bool watching = false;
     TrackKind tk{};
@@ -1605,18 +3034,18 @@ bool DeviceTracker::writeWatchlist()
 
         hasGeo = HasFlag(g_tracks[i].flags, EntityFlags::HasGeo);
         if (hasGeo) {
-          lat = g_tracks[i].last_lat;
-          lon = g_tracks[i].last_lon;
+          lat = GeoFromE6(g_track_info[i].last_lat_e6);
+          lon = GeoFromE6(g_track_info[i].last_lon_e6);
         }
 
-        tt = g_tracks[i].tracker_type;
-        gm = g_tracks[i].tracker_google_mfr;
-        ss = g_tracks[i].tracker_samsung_subtype;
-        tc = g_tracks[i].tracker_confidence;
-        gt = g_tracks[i].glasses_type;
-        gc = g_tracks[i].glasses_confidence;
-        ft = g_tracks[i].flock_type;
-        fc = g_tracks[i].flock_confidence;
+        tt = g_track_info[i].tracker_type;
+        gm = g_track_info[i].tracker_google_mfr;
+        ss = g_track_info[i].tracker_samsung_subtype;
+        tc = g_track_info[i].tracker_confidence;
+        gt = g_track_info[i].glasses_type;
+        gc = g_track_info[i].glasses_confidence;
+        ft = g_track_info[i].flock_type;
+        fc = g_track_info[i].flock_confidence;
       }
     }
     portEXIT_CRITICAL(&g_lock);
@@ -1721,7 +3150,7 @@ bool DeviceTracker::writeWatchlistKml()
   File f = fs->open(PATH_WATCHLIST_KML, FILE_WRITE);
   if (!f) {
     Serial.printf("[kml] open failed: %s\n", PATH_WATCHLIST_KML);
-    SD.end();
+    if (!journalActive() && !captureActive()) SD.end(); // the recorders keep their files open
     return false;
   }
 
@@ -1734,7 +3163,7 @@ bool DeviceTracker::writeWatchlistKml()
   bool wroteAny = false;
 
   // ---------------- Anchors (WiFi APs) ----------------
-  for (int i = 0; i < MAX_ANCHORS; ++i) {
+  for (int i = 0; i < g_max_anchors; ++i) {
     bool in_use = false, watching = false, hasGeo = false;
     uint8_t ssid_len = 0;
     double lat = 0.0, lon = 0.0;
@@ -1749,17 +3178,11 @@ bool DeviceTracker::writeWatchlistKml()
       if (watching && hasGeo) {
         memcpy(mac_temp, g_anchors[i].addr, 6);
 
-        ssid_len = std::min<uint8_t>(g_anchors[i].ssid_len, (uint8_t)sizeof(ssid_temp));
-        if (ssid_len) memcpy(ssid_temp, g_anchors[i].ssid, ssid_len);
+        ssid_len = std::min<uint8_t>(g_anchor_info[i].ssid_len, (uint8_t)sizeof(ssid_temp));
+        if (ssid_len) memcpy(ssid_temp, g_anchor_info[i].ssid, ssid_len);
 
         // Prefer your "display" location
-        if (g_anchors[i].w_sum >= 3.0) {
-          lat = g_anchors[i].w_lat / g_anchors[i].w_sum;
-          lon = g_anchors[i].w_lon / g_anchors[i].w_sum;
-        } else {
-          lat = g_anchors[i].best_lat;
-          lon = g_anchors[i].best_lon;
-        }
+        anchor_position(g_anchor_info[i], lat, lon);
       }
     }
     portEXIT_CRITICAL(&g_lock);
@@ -1810,7 +3233,7 @@ bool DeviceTracker::writeWatchlistKml()
   }
 
   // ---------------- Tracks (WiFi clients / BLE) ----------------
-  for (int i = 0; i < MAX_TRACKS; ++i) {
+  for (int i = 0; i < g_max_tracks; ++i) {
     bool in_use = false, watching = false, hasGeo = false;
     TrackKind tk{};
     double lat = 0.0, lon = 0.0;
@@ -1832,17 +3255,17 @@ bool DeviceTracker::writeWatchlistKml()
       if (watching && hasGeo) {
         tk = g_tracks[i].kind;
         memcpy(mac_temp, g_tracks[i].addr, 6);
-        lat = g_tracks[i].last_lat;
-        lon = g_tracks[i].last_lon;
-
-        tt = g_tracks[i].tracker_type;
-        gm = g_tracks[i].tracker_google_mfr;
-        ss = g_tracks[i].tracker_samsung_subtype;
-        tc = g_tracks[i].tracker_confidence;
-        gt = g_tracks[i].glasses_type;
-        gc = g_tracks[i].glasses_confidence;
-        ft = g_tracks[i].flock_type;
-        fc = g_tracks[i].flock_confidence;
+        lat = GeoFromE6(g_track_info[i].last_lat_e6);
+        lon = GeoFromE6(g_track_info[i].last_lon_e6);
+
+        tt = g_track_info[i].tracker_type;
+        gm = g_track_info[i].tracker_google_mfr;
+        ss = g_track_info[i].tracker_samsung_subtype;
+        tc = g_track_info[i].tracker_confidence;
+        gt = g_track_info[i].glasses_type;
+        gc = g_track_info[i].glasses_confidence;
+        ft = g_track_info[i].flock_type;
+        fc = g_track_info[i].flock_confidence;
       }
     }
     portEXIT_CRITICAL(&g_lock);
@@ -1938,11 +3361,12 @@ bool DeviceTracker::writeWatchlistKml()
 
   Serial.printf("[kml] wrote %s (%s)\n", PATH_WATCHLIST_KML, wroteAny ? "with placemarks" : "no geo items");
 
-  SD.end();
+  if (!journalActive() && !captureActive()) SD.end();
 
   return true;
 }
 
+#ifndef PIGTAIL_NO_JSON
 bool DeviceTracker::readIgnorelist()
 {
   fs::FS& fs = SPIFFS;
@@ -2006,6 +3430,13 @@ bool DeviceTracker::readIgnorelist()
 
   return loaded > 0;
 }
+#else
+bool DeviceTracker::readIgnorelist()
+{
+  Serial.println("[ignorelist] built without ArduinoJson; not loaded");
+  return false;
+}
+#endif
 
 bool DeviceTracker::writeIgnorelist()
 {
@@ -2026,9 +3457,9 @@ bool DeviceTracker::writeIgnorelist()
 
     // Snapshot one entry under lock (NO file I/O while locked)
     portENTER_CRITICAL(&g_lock);
-    if (g_ignores[i].in_use) {
+    if (i < g_ignore_count) {
       in_use = true;
-      memcpy(mac_temp, g_ignores[i].addr, 6);
+      memcpy(mac_temp, g_ignores[i], 6);
     }
     portEXIT_CRITICAL(&g_lock);
 
@@ -2055,13 +3486,17 @@ void DeviceTracker::clearWatchlist()
 {
   portENTER_CRITICAL(&g_lock);
 
-  for (int i = 0; i < MAX_TRACKS; ++i) {
-    if (g_tracks[i].in_use)
+  for (int i = 0; i < g_max_tracks; ++i) {
+    if (g_tracks[i].in_use && HasFlag(g_tracks[i].flags, EntityFlags::Watching)) {
       ClearFlag(g_tracks[i].flags, EntityFlags::Watching);
+      rank_mark_track_unlocked(i);
+    }
   }
-  for (int i = 0; i < MAX_ANCHORS; ++i) {
-    if (g_anchors[i].in_use)
+  for (int i = 0; i < g_max_anchors; ++i) {
+    if (g_anchors[i].in_use && HasFlag(g_anchors[i].flags, EntityFlags::Watching)) {
       ClearFlag(g_anchors[i].flags, EntityFlags::Watching);
+      rank_mark_anchor_unlocked(i);
+    }
   }
 
   portEXIT_CRITICAL(&g_lock);
@@ -2076,13 +3511,17 @@ void DeviceTracker::clearIgnorelist()
 
   ignore_clear_unlocked();
 
-  for (int i = 0; i < MAX_TRACKS; ++i) {
-    if (g_tracks[i].in_use)
+  for (int i = 0; i < g_max_tracks; ++i) {
+    if (g_tracks[i].in_use && HasFlag(g_tracks[i].flags, EntityFlags::Ignoring)) {
       ClearFlag(g_tracks[i].flags, EntityFlags::Ignoring);
+      rank_mark_track_unlocked(i);
+    }
   }
-  for (int i = 0; i < MAX_ANCHORS; ++i) {
-    if (g_anchors[i].in_use)
+  for (int i = 0; i < g_max_anchors; ++i) {
+    if (g_anchors[i].in_use && HasFlag(g_anchors[i].flags, EntityFlags::Ignoring)) {
       ClearFlag(g_anchors[i].flags, EntityFlags::Ignoring);
+      rank_mark_anchor_unlocked(i);
+    }
   }
 
   portEXIT_CRITICAL(&g_lock);
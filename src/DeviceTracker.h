@@ -5,10 +5,152 @@
 #include "Track.h"
 #include <FS.h>
 
+// How a full track table picks a victim for a new sighting. Watched
+// entities are never evicted under either policy.
+enum class EvictionPolicy : uint8_t {
+  Lru,              // least-recently seen goes first
+  ScoreWeightedLru, // lowest score among the few least-recently seen
+};
+
+// Per-producer ring counters; a drop means that source's ring was full.
+struct SourceStats {
+  uint32_t enqueued = 0;
+  uint32_t dropped = 0;
+};
+
+// Observation ingest counters, for tuning batch size against UI latency.
+// Batch time covers applying the batch plus the segmentation/expiry pass.
+struct IngestStats {
+  uint32_t batches = 0;
+  uint32_t observations = 0;
+  uint32_t sightings = 0;      // frames/adverts behind them; more when repeats were coalesced
+  uint16_t last_batch = 0;     // observations in the most recent batch
+  uint32_t last_batch_us = 0;
+  uint32_t max_batch_us = 0;
+  SourceStats wifi;
+  SourceStats ble;
+};
+
+// Table occupancy and churn. An eviction makes room for a new sighting in a
+// full table, an expiry frees an idle entity; rejected sightings found every
+// slot held by a watched entity.
+struct TableStats {
+  uint16_t tracks = 0;  // live
+  uint16_t anchors = 0; // live
+  uint32_t track_evictions = 0;
+  uint32_t anchor_evictions = 0;
+  uint32_t track_expiries = 0;
+  uint32_t anchor_expiries = 0;
+  uint32_t rejected = 0;
+};
+
+// Distinct devices in the last complete 10 s observation window
+// (HyperLogLog estimates), split by radio. total feeds the score's crowd
+// penalty.
+struct CrowdStats {
+  uint32_t window = 0; // index (ts / 10 s) of the window the counts are for
+  uint16_t wifi = 0;   // Wi-Fi clients + APs
+  uint16_t ble = 0;
+  uint16_t total = 0;
+};
+
+// Cold tier counters. A track is spilled when it expires or is evicted
+// (if it lasted long enough to be worth keeping) and rehydrated when the
+// same MAC is seen again. false_hits are Bloom filter positives that were
+// not on flash; dropped means a pass queued more than it could service.
+struct ColdStats {
+  uint32_t spilled = 0;
+  uint32_t rehydrated = 0;
+  uint32_t false_hits = 0;
+  uint32_t dropped = 0;
+  uint32_t failed = 0; // flash write errors
+};
+
+// Observation journal counters. dropped means the recorder fell behind and
+// its RAM ring was full; write_errors are failed SD writes.
+struct JournalStats {
+  uint32_t records = 0;
+  uint32_t bytes = 0;
+  uint32_t dropped = 0;
+  uint32_t write_errors = 0;
+};
+
+// Wi-Fi channel hopping. Fixed gives every channel the same dwell; adaptive
+// (the default) shares each round by recent discovery yield, with a
+// guaranteed minimum per channel (HopScheduler.h).
+enum class HopMode : uint8_t {
+  Fixed,
+  Adaptive,
+};
+
+// Per-channel sniffer counters since boot. frames are parsed beacons, probe
+// requests and probe responses heard on the channel; new_devices are those
+// that added a track or anchor the tables did not hold. share_q8 is the
+// channel's current share of adaptive dwell (256 = all of it), kept up to
+// date in either mode. Compare modes by new_devices per dwell_ms.
+struct ChannelStats {
+  uint32_t frames = 0;
+  uint32_t new_devices = 0;
+  uint32_t dwell_ms = 0;
+  uint16_t share_q8 = 0;
+};
+
+struct HopStats {
+  HopMode mode = HopMode::Adaptive;
+  ChannelStats channel[11]; // channels 1..11
+};
+
+// Raw capture counters. frames were encoded; dropped means a callback found
+// its capture ring full; write_errors are failed SD writes.
+struct CaptureStats {
+  uint32_t frames = 0;
+  uint32_t bytes = 0;
+  uint32_t dropped = 0;
+  uint32_t write_errors = 0;
+};
+
+struct JournalObservation;
+
 class DeviceTracker {
 public:
   bool begin(); // starts Wi-Fi sniffer + BLE scan + internal tasks
+  // Tables, lists and cold store only: no radios, no tasks. begin() calls
+  // it; host tools call it instead and drive processing with ingest().
+  bool beginCore();
+  // Replaces the tracker's clock (microseconds since boot; default
+  // esp_timer_get_time) so a harness can run hours of virtual time in
+  // seconds. nullptr restores the default. Set before begin()/beginCore();
+  // the clock must not go backwards except across reset().
+  void setClock(int64_t (*now_us)());
+  // Without begin() only: applies obs as processing passes at the clock's
+  // current second (segmentation, expiry, cold tier, snapshot included).
+  // n == 0 runs one idle pass.
+  void ingest(const JournalObservation* obs, int n);
+  // Publishes the ranked snapshot now instead of at the next rate-limited
+  // pass, for harnesses that read topK() right after ingest().
+  void publishSnapshot();
   void setGpsFix(bool valid, double lat, double lon); // optional; safe to call always
+  // Table sizes, fixed at begin(); call before it (clamped to 16384 tracks,
+  // 8192 anchors). With prefer_psram the tables go to PSRAM when the board
+  // has it. Returns false once the tables exist.
+  bool setCapacity(int tracks, int anchors, bool prefer_psram = true);
+  int trackCapacity() const;
+  int anchorCapacity() const;
+  void setEvictionPolicy(EvictionPolicy policy);
+
+  // Anchors kept in each environment fingerprint sketch (8..64, default
+  // 32). Wider tells locations apart more reliably at a higher per-tick cost.
+  void setFingerprintWidth(int k);
+
+  // Max observations applied per lock acquisition (1..32, default 16).
+  void setBatchSize(int n);
+  int batchSize() const;
+  IngestStats ingestStats() const;
+  TableStats tableStats() const;
+  HopStats hopStats() const;
+  void setHopMode(HopMode mode);
+  ColdStats coldStats() const;
+  CrowdStats crowdStats() const;
 
   void initBleScan();
   void stopBleScan();
@@ -16,8 +158,18 @@ public:
   void initBleTracker();
   void initWifiSniffer();
 
-  // Build a sorted snapshot into out[]; returns count.
-  int buildSnapshot(EntityView* out, int maxOut, float stationary_ratio);
+  // Ranked snapshot access. None of these block ingestion.
+  // topK copies ranks [offset, offset+count) into out[] and returns how many
+  // it copied; total receives the full ranked count, generation the snapshot
+  // generation the page came from.
+  int topK(EntityView* out, int offset, int count, int* total = nullptr, uint32_t* generation = nullptr);
+  // Full ordering (best first) into out[]; returns count. For export.
+  int buildSnapshot(EntityView* out, int maxOut, float stationary_ratio, uint32_t* generation = nullptr);
+  // Position of an entity in the current snapshot, or -1.
+  int rankOf(EntityKind kind, uint32_t handle) const;
+  // Bumped on every publish; unchanged means a fresh copy would be identical.
+  uint32_t snapshotGeneration() const;
+  void setStationaryRatio(float stationary_ratio);
   void updateEntity(const EntityView* in);
 
   // Accessors for UI/status
@@ -26,6 +178,21 @@ public:
   uint32_t lastEnvTickS() const { return _last_env_tick_s; }
   void setSdAvailable(bool available) { _sdAvailable = available; }
 
+  // Appends every decoded observation and GPS fix to pt_journal.bin on SD
+  // (format in Journal.h) until stopJournal(). Needs the SD card.
+  bool startJournal();
+  void stopJournal();
+  bool journalActive() const;
+  JournalStats journalStats() const;
+
+  // Writes every received management frame and BLE advert, raw, to a new
+  // pt_capture_NNN.pcapng on SD (format in Pcapng.h) until stopCapture().
+  // Independent of the journal. Needs the SD card.
+  bool startCapture();
+  void stopCapture();
+  bool captureActive() const;
+  CaptureStats captureStats() const;
+
   void reset();
   void dumpWatchlistFile();
   void outputLists();
@@ -0,0 +1,82 @@
+#pragma once
+
+#include <cstdint>
+
+// Dwell planner for the Wi-Fi channel hopper. Time is split into rounds that
+// visit every one of N channels once: each visit gets at least MIN_MS, and
+// the rest of the round is shared out in proportion to each channel's
+// expected discovery yield, an EMA of new devices per second of dwell (plus
+// a small weight on frames per second, which breaks ties between channels
+// that have gone quiet, and a floor so no channel's estimate sinks to zero).
+// The minimum sweep bounds how long any channel goes unheard to one round.
+//
+// Starts out uniform; with ROUND_MS = N * 250 ms the round length matches
+// the fixed hopper, so adaptive and fixed hopping get the same total time.
+template <int N>
+class HopScheduler {
+  static_assert(N > 0, "need at least one channel");
+
+public:
+  static constexpr uint32_t ROUND_MS = (uint32_t)N * 250;
+  static constexpr uint32_t MIN_MS = 100;
+  static constexpr float    FRAME_WEIGHT = 0.02f; // 50 frames/s count as one new device/s
+  static constexpr float    FLOOR = 0.05f;        // per second
+  static constexpr float    ALPHA = 0.2f;         // EMA weight of the latest round
+
+  static_assert(N * MIN_MS <= ROUND_MS, "minimum sweep exceeds the round");
+
+  HopScheduler() {
+    for (int i = 0; i < N; ++i) {
+      _yield[i] = 0.0f;
+      _rate[i] = 0.0f;
+    }
+  }
+
+  // Dwell for each channel in the next round; sums to ROUND_MS.
+  void Plan(uint32_t dwell_ms[N]) const {
+    float w[N], sum = 0.0f;
+    for (int i = 0; i < N; ++i) sum += (w[i] = Weight(i));
+    const uint32_t spare = ROUND_MS - (uint32_t)N * MIN_MS;
+    uint32_t given = 0;
+    for (int i = 0; i < N; ++i) {
+      dwell_ms[i] = MIN_MS + (uint32_t)((float)spare * w[i] / sum);
+      given += dwell_ms[i];
+    }
+    dwell_ms[Best()] += ROUND_MS - given; // rounding remainder
+  }
+
+  // Results of a round: what each channel produced in dwell_ms[i] of
+  // listening. A channel with no dwell keeps its estimate.
+  void Update(const uint32_t new_devices[N], const uint32_t frames[N], const uint32_t dwell_ms[N]) {
+    for (int i = 0; i < N; ++i) {
+      if (dwell_ms[i] == 0) continue;
+      const float s = (float)dwell_ms[i] / 1000.0f;
+      _yield[i] += ALPHA * ((float)new_devices[i] / s - _yield[i]);
+      _rate[i] += ALPHA * ((float)frames[i] / s - _rate[i]);
+    }
+  }
+
+  // Channel i's share of the adaptive part of the round, 0..256.
+  uint16_t ShareQ8(int i) const {
+    float sum = 0.0f;
+    for (int k = 0; k < N; ++k) sum += Weight(k);
+    return (uint16_t)(256.0f * Weight(i) / sum + 0.5f);
+  }
+
+  float Yield(int i) const { return _yield[i]; }
+  float FrameRate(int i) const { return _rate[i]; }
+
+private:
+  float Weight(int i) const { return _yield[i] + FRAME_WEIGHT * _rate[i] + FLOOR; }
+
+  int Best() const {
+    int b = 0;
+    for (int i = 1; i < N; ++i) {
+      if (Weight(i) > Weight(b)) b = i;
+    }
+    return b;
+  }
+
+  float _yield[N]; // new devices per second of dwell
+  float _rate[N];  // frames per second of dwell
+};
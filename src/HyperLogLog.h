@@ -0,0 +1,61 @@
+#pragma once
+
+#include <cmath>
+#include <cstdint>
+#include <cstring>
+
+// HyperLogLog distinct counter over 64-bit keys (MacIndex keys), with 2^P
+// one-byte registers. Adding the same key again never changes the estimate,
+// so a device beaconing at 10 Hz counts once. Standard error is about
+// 1.04 / sqrt(2^P); small counts use linear counting, which is close to
+// exact in the range the crowd heuristic cares about.
+template <int P>
+class HyperLogLog {
+  static_assert(P >= 4 && P <= 16, "P out of range");
+
+public:
+  static constexpr int M = 1 << P;
+
+  void Clear() { memset(_reg, 0, sizeof(_reg)); }
+
+  void Add(uint64_t key) {
+    const uint64_t h = Mix(key);
+    const uint32_t idx = (uint32_t)(h >> (64 - P));
+    const uint64_t rest = (h << P) | (1ULL << (P - 1)); // sentinel bounds the rank
+    const uint8_t rank = (uint8_t)(__builtin_clzll(rest) + 1);
+    if (rank > _reg[idx]) _reg[idx] = rank;
+  }
+
+  // Union: afterwards this counts keys added to either sketch.
+  void Merge(const HyperLogLog& other) {
+    for (int i = 0; i < M; ++i) {
+      if (other._reg[i] > _reg[i]) _reg[i] = other._reg[i];
+    }
+  }
+
+  uint32_t Estimate() const {
+    float sum = 0.0f;
+    int zeros = 0;
+    for (int i = 0; i < M; ++i) {
+      sum += ldexpf(1.0f, -(int)_reg[i]);
+      zeros += (_reg[i] == 0);
+    }
+
+    const float alpha = (M == 16) ? 0.673f : (M == 32) ? 0.697f : (M == 64) ? 0.709f
+                                                        : 0.7213f / (1.0f + 1.079f / (float)M);
+    float e = alpha * (float)M * (float)M / sum;
+    if (e <= 2.5f * (float)M && zeros > 0) e = (float)M * logf((float)M / (float)zeros);
+    return (uint32_t)lroundf(e);
+  }
+
+private:
+  // splitmix64 finalizer; the rank needs well-mixed high bits.
+  static uint64_t Mix(uint64_t key) {
+    key ^= key >> 30; key *= 0xBF58476D1CE4E5B9ULL;
+    key ^= key >> 27; key *= 0x94D049BB133111EBULL;
+    key ^= key >> 31;
+    return key;
+  }
+
+  uint8_t _reg[M]{};
+};
@@ -0,0 +1,97 @@
+#pragma once
+
+#include <cstdint>
+#include <cstring>
+
+// 802.11 management frame parsing for the Wi-Fi sniffer: pulls the
+// transmitter (client or BSSID) and SSID out of beacons, probe requests and
+// probe responses. Plain C++ with no driver types, so host tools run
+// captured frames through the same code as wifi_promisc_cb.
+
+struct __attribute__((packed)) ieee80211_hdr {
+  uint16_t fc;
+  uint16_t dur;
+  uint8_t  addr1[6];
+  uint8_t  addr2[6];
+  uint8_t  addr3[6];
+  uint16_t sc;
+};
+
+static inline uint8_t fc_type(uint16_t fc)    { return (fc >> 2) & 0x3; }
+static inline uint8_t fc_subtype(uint16_t fc) { return (fc >> 4) & 0xF; }
+
+static inline void extract_ssid_ie(
+  const uint8_t* payload, int len, int ie_start,
+  uint8_t out_ssid[32], uint8_t* out_len)
+{
+  *out_len = 0;
+  if (!payload || len <= ie_start) return;
+
+  int i = ie_start;
+  while (i + 2 <= len) {
+    uint8_t id = payload[i + 0];
+    uint8_t l  = payload[i + 1];
+    i += 2;
+
+    if (i + l > len) break; // malformed IE list
+
+    if (id == 0) { // SSID
+      uint8_t ncopy = l < 32 ? l : 32;
+      if (ncopy) memcpy(out_ssid, payload + i, ncopy);
+      *out_len = ncopy; // 0 means hidden
+      return;
+    }
+
+    i += l;
+  }
+}
+
+// Values match the tracker's ObsKind (and JournalObservation::kind).
+enum class MgmtKind : uint8_t {
+  None = 0,
+  ProbeReq = 1,
+  Beacon = 2,
+  ProbeResp = 3,
+};
+
+struct MgmtFrame {
+  MgmtKind       kind = MgmtKind::None;
+  const uint8_t* addr = nullptr; // into the frame: BSSID for beacons/responses, SA for requests
+  uint8_t        ssid_len = 0;   // 0: hidden, wildcard or absent
+  uint8_t        ssid[32];
+};
+
+// frame[0..len) starts at the frame control field. Returns false for
+// anything but a beacon, probe request or probe response.
+static inline bool parse_mgmt_frame(const uint8_t* frame, int len, MgmtFrame& out) {
+  if (len < 24) return false;
+
+  const uint16_t fc = frame[0] | (frame[1] << 8);
+  if (fc_type(fc) != 0) return false;
+
+  const uint8_t st = fc_subtype(fc);
+  const ieee80211_hdr* h = (const ieee80211_hdr*)frame;
+
+  if (st == 8 || st == 5) {
+    // beacon or probe response:
+    // 24-byte header + 12-byte fixed params = 36
+    const int ie_start = 36;
+    if (len <= ie_start) return false;
+
+    out.kind = (st == 8) ? MgmtKind::Beacon : MgmtKind::ProbeResp;
+    out.addr = h->addr3; // BSSID
+    extract_ssid_ie(frame, len, ie_start, out.ssid, &out.ssid_len);
+    return true;
+  }
+
+  if (st == 4) {
+    // probe request: client SA in addr2; IEs begin immediately after header (24)
+    out.kind = MgmtKind::ProbeReq;
+    out.addr = h->addr2;
+    // The SSID IE is often present, and may be empty (wildcard).
+    extract_ssid_ie(frame, len, 24, out.ssid, &out.ssid_len);
+    return true;
+  }
+
+  return false;
+}
@@ -0,0 +1,242 @@
+#pragma once
+
+#include <cstddef>
+#include <cstdint>
+#include <cstring>
+
+#include "Track.h"
+
+// Binary observation journal, appended to SD while recording and read back
+// by host/replay_journal. Plain C++ so the host tools can share it.
+//
+// File: an 8-byte header ("PTJ1", u16 version, u16 reserved), then records
+//   u16 len        bytes in type + payload
+//   u8  type       JournalType
+//   ...payload
+//   u32 crc        CRC-32 (IEEE) over type + payload
+// All integers little-endian. Timestamps are seconds since boot. Every
+// recording starts with a Session record carrying a random id drawn once per
+// boot, so a reader can tell a restarted recording (same id, the clock runs
+// on) from a reboot (new id, the clock starts over). A torn or corrupt
+// record fails its CRC and the reader can resync by scanning forward.
+//
+// Version 2 adds an optional tail to Observation records: count, min and
+// max RSSI, written only when the record stands for several coalesced
+// sightings. Version 1 files have no tails and read the same.
+// Version 3 adds the boot id to Session records; older ones read as 0.
+enum class JournalType : uint8_t {
+  Session = 1,
+  Observation = 2,
+  GnssFix = 3,
+};
+
+// Mirrors the tracker's decoded Observation.
+struct JournalObservation {
+  uint8_t  kind = 0;       // ObsKind
+  int8_t   rssi_dbm = 0;
+  uint8_t  addr[6]{};
+  uint32_t ts_s = 0;
+  uint8_t  ssid_len = 0;
+  uint8_t  ssid[32]{};
+  uint8_t  count = 1;      // sightings merged into this one; rssi_dbm is their mean
+  int8_t   rssi_min = 0;   // valid when count > 1
+  int8_t   rssi_max = 0;
+
+  TrackerType           tracker_type = TrackerType::Unknown;
+  GoogleFmnManufacturer tracker_google_mfr = GoogleFmnManufacturer::Unknown;
+  SamsungTrackerSubtype tracker_samsung_subtype = SamsungTrackerSubtype::Unknown;
+  uint8_t               tracker_confidence = 0;
+  GlassesType           glasses_type = GlassesType::Unknown;
+  uint8_t               glasses_confidence = 0;
+  FlockType             flock_type = FlockType::Unknown;
+  uint8_t               flock_confidence = 0;
+};
+
+struct JournalFix {
+  uint32_t ts_s = 0;
+  bool     valid = false;
+  int32_t  lat_e6 = 0;
+  int32_t  lon_e6 = 0;
+};
+
+struct JournalEntry {
+  JournalType        type = JournalType::Observation;
+  JournalObservation obs;  // Observation
+  JournalFix         fix;  // GnssFix
+  uint32_t           session_ts_s = 0; // Session: clock at start of recording
+  uint32_t           boot_id = 0;      // Session: 0 if the file predates it
+};
+
+class Journal {
+public:
+  static constexpr uint32_t MAGIC = 0x314A5450; // "PTJ1"
+  static constexpr uint16_t VERSION = 3;
+  static constexpr size_t   HEADER_SIZE = 8;
+  static constexpr size_t   BODY_MAX = 1 + 14 + 32 + 8 + 3; // type + largest observation
+  static constexpr size_t   RECORD_MAX = 2 + BODY_MAX + 4;
+
+  enum class Status { Ok, NeedMore, Corrupt };
+
+  static size_t EncodeHeader(uint8_t* out) {
+    Put32(out, MAGIC);
+    Put16(out + 4, VERSION);
+    Put16(out + 6, 0);
+    return HEADER_SIZE;
+  }
+
+  static bool CheckHeader(const uint8_t* in, size_t len) {
+    if (len < HEADER_SIZE || Get32(in) != MAGIC) return false;
+    const uint16_t v = Get16(in + 4);
+    return v >= 1 && v <= VERSION;
+  }
+
+  // Writes one record (at most RECORD_MAX bytes); returns its size.
+  static size_t Encode(const JournalEntry& e, uint8_t* out) {
+    uint8_t* p = out + 3;
+    switch (e.type) {
+      case JournalType::Session:
+        Put32(p, e.session_ts_s); p += 4;
+        Put32(p, e.boot_id); p += 4;
+        break;
+
+      case JournalType::Observation: {
+        const JournalObservation& o = e.obs;
+        const uint8_t ssid_len = o.ssid_len > 32 ? 32 : o.ssid_len;
+        *p++ = o.kind;
+        *p++ = (uint8_t)o.rssi_dbm;
+        memcpy(p, o.addr, 6); p += 6;
+        Put32(p, o.ts_s); p += 4;
+        *p++ = ssid_len;
+        memcpy(p, o.ssid, ssid_len); p += ssid_len;
+
+        const bool ext = o.tracker_type != TrackerType::Unknown || o.tracker_confidence ||
+                         o.glasses_type != GlassesType::Unknown || o.glasses_confidence ||
+                         o.flock_type != FlockType::Unknown || o.flock_confidence ||
+                         o.tracker_google_mfr != GoogleFmnManufacturer::Unknown ||
+                         o.tracker_samsung_subtype != SamsungTrackerSubtype::Unknown;
+        *p++ = ext ? EXT_LEN : 0;
+        if (ext) {
+          *p++ = (uint8_t)o.tracker_type;
+          *p++ = (uint8_t)o.tracker_google_mfr;
+          *p++ = (uint8_t)o.tracker_samsung_subtype;
+          *p++ = o.tracker_confidence;
+          *p++ = (uint8_t)o.glasses_type;
+          *p++ = o.glasses_confidence;
+          *p++ = (uint8_t)o.flock_type;
+          *p++ = o.flock_confidence;
+        }
+        if (o.count > 1) {
+          *p++ = o.count;
+          *p++ = (uint8_t)o.rssi_min;
+          *p++ = (uint8_t)o.rssi_max;
+        }
+      } break;
+
+      case JournalType::GnssFix:
+        Put32(p, e.fix.ts_s); p += 4;
+        *p++ = e.fix.valid ? 1 : 0;
+        Put32(p, (uint32_t)e.fix.lat_e6); p += 4;
+        Put32(p, (uint32_t)e.fix.lon_e6); p += 4;
+        break;
+    }
+
+    const size_t body = (size_t)(p - (out + 2)); // type + payload
+    out[2] = (uint8_t)e.type;
+    Put16(out, (uint16_t)body);
+    Put32(p, Crc32(out + 2, body));
+    return 2 + body + 4;
+  }
+
+  // Parses the record at in[0..len). On Ok, used is its size. NeedMore means
+  // the buffer ends mid-record; Corrupt means skip a byte and try again.
+  static Status Decode(const uint8_t* in, size_t len, JournalEntry& e, size_t& used) {
+    if (len < 2) return Status::NeedMore;
+    const size_t body = Get16(in);
+    if (body < 1 || body > BODY_MAX) return Status::Corrupt;
+    if (len < 2 + body + 4) return Status::NeedMore;
+    if (Crc32(in + 2, body) != Get32(in + 2 + body)) return Status::Corrupt;
+
+    const uint8_t* p = in + 3;
+    const size_t n = body - 1;
+    e = JournalEntry{};
+    e.type = (JournalType)in[2];
+    switch (e.type) {
+      case JournalType::Session:
+        if (n != 4 && n != 8) return Status::Corrupt;
+        e.session_ts_s = Get32(p);
+        if (n == 8) e.boot_id = Get32(p + 4);
+        break;
+
+      case JournalType::Observation: {
+        if (n < 13) return Status::Corrupt;
+        JournalObservation& o = e.obs;
+        o.kind = p[0];
+        o.rssi_dbm = (int8_t)p[1];
+        memcpy(o.addr, p + 2, 6);
+        o.ts_s = Get32(p + 8);
+        o.ssid_len = p[12];
+        if (o.ssid_len > 32 || n < 14u + o.ssid_len) return Status::Corrupt;
+        memcpy(o.ssid, p + 13, o.ssid_len);
+        const uint8_t* x = p + 13 + o.ssid_len;
+        const uint8_t ext = *x++;
+        if (ext != 0 && ext != EXT_LEN) return Status::Corrupt;
+        const size_t tail = n - (14u + o.ssid_len + ext);
+        if (n < 14u + o.ssid_len + ext || (tail != 0 && tail != AGG_LEN)) return Status::Corrupt;
+        if (ext) {
+          o.tracker_type = (TrackerType)x[0];
+          o.tracker_google_mfr = (GoogleFmnManufacturer)x[1];
+          o.tracker_samsung_subtype = (SamsungTrackerSubtype)x[2];
+          o.tracker_confidence = x[3];
+          o.glasses_type = (GlassesType)x[4];
+          o.glasses_confidence = x[5];
+          o.flock_type = (FlockType)x[6];
+          o.flock_confidence = x[7];
+        }
+        if (tail) {
+          x += ext;
+          o.count = x[0];
+          o.rssi_min = (int8_t)x[1];
+          o.rssi_max = (int8_t)x[2];
+          if (o.count < 2) return Status::Corrupt;
+        }
+      } break;
+
+      case JournalType::GnssFix:
+        if (n != 13) return Status::Corrupt;
+        e.fix.ts_s = Get32(p);
+        e.fix.valid = p[4] != 0;
+        e.fix.lat_e6 = (int32_t)Get32(p + 5);
+        e.fix.lon_e6 = (int32_t)Get32(p + 9);
+        break;
+
+      default:
+        return Status::Corrupt;
+    }
+    used = 2 + body + 4;
+    return Status::Ok;
+  }
+
+  static uint32_t Crc32(const uint8_t* data, size_t len) {
+    static constexpr uint32_t T[16] = {
+      0x00000000, 0x1DB71064, 0x3B6E20C8, 0x26D930AC, 0x76DC4190, 0x6B6B51F4, 0x4DB26158, 0x5005713C,
+      0xEDB88320, 0xF00F9344, 0xD6D6A3E8, 0xCB61B38C, 0x9B64C2B0, 0x86D3D2D4, 0xA00AE278, 0xBDBDF21C,
+    };
+    uint32_t c = 0xFFFFFFFFu;
+    for (size_t i = 0; i < len; ++i) {
+      c = T[(c ^ data[i]) & 0x0F] ^ (c >> 4);
+      c = T[(c ^ (data[i] >> 4)) & 0x0F] ^ (c >> 4);
+    }
+    return ~c;
+  }
+
+private:
+  static constexpr uint8_t EXT_LEN = 8;
+  static constexpr uint8_t AGG_LEN = 3; // count, rssi_min, rssi_max
+
+  static void Put16(uint8_t* p, uint16_t v) { p[0] = (uint8_t)v; p[1] = (uint8_t)(v >> 8); }
+  static void Put32(uint8_t* p, uint32_t v) { for (int i = 0; i < 4; ++i) p[i] = (uint8_t)(v >> (8 * i)); }
+  static uint16_t Get16(const uint8_t* p) { return (uint16_t)(p[0] | (p[1] << 8)); }
+  static uint32_t Get32(const uint8_t* p) {
+    return (uint32_t)p[0] | ((uint32_t)p[1] << 8) | ((uint32_t)p[2] << 16) | ((uint32_t)p[3] << 24);
+  }
+};
@@ -0,0 +1,78 @@
+#pragma once
+
+#include <atomic>
+#include <cstdint>
+
+#include "MacIndex.h"
+
+// MAC-only membership set with a seqlock, for read-mostly lists such as the
+// ignorelist. Writers must be serialized by the caller (the tracker does this
+// under g_lock). Radio callbacks can probe it with ContainsLockFree() without
+// taking any lock; a probe that overlaps a write simply reports "not present",
+// so the slow path still sees the frame and nothing is dropped by mistake.
+//
+// BUCKETS must be a power of two; the buckets live inline in the filter.
+template <int BUCKETS>
+class MacFilter {
+  static_assert(BUCKETS > 0 && (BUCKETS & (BUCKETS - 1)) == 0, "BUCKETS must be a power of two");
+
+public:
+  MacFilter() {
+    Arena arena(_storage, sizeof(_storage));
+    _set.Init(arena, BUCKETS);
+  }
+
+  void Clear() {
+    BeginWrite();
+    _set.Clear();
+    EndWrite();
+  }
+
+  // Returns false only if the set is full.
+  bool Insert(const uint8_t addr[6]) {
+    BeginWrite();
+    const bool ok = _set.Insert(Key(addr), 0);
+    EndWrite();
+    return ok;
+  }
+
+  void Erase(const uint8_t addr[6]) {
+    BeginWrite();
+    _set.Erase(Key(addr));
+    EndWrite();
+  }
+
+  // Exact lookup; only valid while writers are excluded.
+  bool Contains(const uint8_t addr[6]) const { return _set.Find(Key(addr)) >= 0; }
+
+  // Lock-free lookup for producers. May return false for a present MAC if a
+  // write is in progress; never returns true for an absent one.
+  bool ContainsLockFree(const uint8_t addr[6]) const {
+    const uint32_t s1 = _seq.load(std::memory_order_acquire);
+    if (s1 & 1) return false;
+    if (_set.Count() == 0) return false;
+
+    const bool hit = _set.Find(Key(addr)) >= 0;
+
+    std::atomic_thread_fence(std::memory_order_acquire);
+    const uint32_t s2 = _seq.load(std::memory_order_relaxed);
+    return hit && s1 == s2;
+  }
+
+  int Count() const { return _set.Count(); }
+
+private:
+  // The index wants a non-zero kind byte; ignores match every kind.
+  static uint64_t Key(const uint8_t addr[6]) { return MacIndex::MakeKey(1, addr); }
+
+  void BeginWrite() {
+    _seq.fetch_add(1, std::memory_order_relaxed);
+    std::atomic_thread_fence(std::memory_order_release);
+  }
+
+  void EndWrite() { _seq.fetch_add(1, std::memory_order_release); }
+
+  alignas(uint64_t) uint8_t _storage[BUCKETS * (sizeof(uint64_t) + sizeof(uint16_t))];
+  MacIndex              _set;
+  std::atomic<uint32_t> _seq{0};
+};
@@ -0,0 +1,110 @@
+#pragma once
+
+#include <cstdint>
+
+#include "Arena.h"
+
+// Open-addressing hash index from a (kind, MAC) key to a slot in one of the
+// tracker's tables. Linear probing over a power-of-two bucket array;
+// erase uses backward-shift deletion so there are no tombstones to build up
+// as randomized MACs churn through the table.
+//
+// The bucket arrays come from an Arena at Init(), so the size is a runtime
+// setting. Use BucketsFor(slots) to keep the load factor <= 0.5 so probe
+// chains stay short.
+class MacIndex {
+public:
+  // Key 0 marks an empty bucket; kind is never 0 so real keys never collide with it.
+  static uint64_t MakeKey(uint8_t kind, const uint8_t addr[6]) {
+    return ((uint64_t)kind << 48) |
+           ((uint64_t)addr[0] << 40) | ((uint64_t)addr[1] << 32) |
+           ((uint64_t)addr[2] << 24) | ((uint64_t)addr[3] << 16) |
+           ((uint64_t)addr[4] << 8)  |  (uint64_t)addr[5];
+  }
+
+  // Smallest power of two >= 2x slots.
+  static int BucketsFor(int slots) {
+    int b = 1;
+    while (b < 2 * slots) b <<= 1;
+    return b;
+  }
+
+  // Carves the bucket arrays from arena; buckets must be a power of two.
+  // Returns false while the arena is only sizing or has run out.
+  bool Init(Arena& arena, int buckets) {
+    _buckets = buckets;
+    _mask = (uint32_t)buckets - 1;
+    _keys = arena.Alloc<uint64_t>((size_t)buckets);
+    _slots = arena.Alloc<uint16_t>((size_t)buckets);
+    _count = 0;
+    return _keys && _slots;
+  }
+
+  void Clear() {
+    for (int i = 0; i < _buckets; ++i) _keys[i] = 0;
+    _count = 0;
+  }
+
+  // Returns the slot stored for key, or -1.
+  int Find(uint64_t key) const {
+    for (uint32_t b = Home(key);; b = (b + 1) & _mask) {
+      if (_keys[b] == key) return _slots[b];
+      if (_keys[b] == 0) return -1;
+    }
+  }
+
+  // Inserts or overwrites key -> slot. Returns false only if the index is full.
+  bool Insert(uint64_t key, int slot) {
+    for (uint32_t b = Home(key);; b = (b + 1) & _mask) {
+      if (_keys[b] == key) { _slots[b] = (uint16_t)slot; return true; }
+      if (_keys[b] == 0) {
+        if (_count >= _buckets - 1) return false; // keep one empty bucket so probes terminate
+        _keys[b] = key;
+        _slots[b] = (uint16_t)slot;
+        _count++;
+        return true;
+      }
+    }
+  }
+
+  void Erase(uint64_t key) {
+    uint32_t b = Home(key);
+    for (;; b = (b + 1) & _mask) {
+      if (_keys[b] == 0) return; // not present
+      if (_keys[b] == key) break;
+    }
+
+    // Backward-shift: pull later members of the probe run into the hole when
+    // their home bucket does not lie cyclically in (hole, j].
+    uint32_t hole = b;
+    for (uint32_t j = (hole + 1) & _mask; _keys[j] != 0; j = (j + 1) & _mask) {
+      const uint32_t home = Home(_keys[j]);
+      const bool stays = (hole <= j) ? (hole < home && home <= j)
+                                     : (hole < home || home <= j);
+      if (stays) continue;
+      _keys[hole] = _keys[j];
+      _slots[hole] = _slots[j];
+      hole = j;
+    }
+    _keys[hole] = 0;
+    _count--;
+  }
+
+  int Count() const { return _count; }
+  int Buckets() const { return _buckets; }
+
+private:
+  // splitmix64 finalizer: OUI bytes are highly repetitive, so mix before masking.
+  uint32_t Home(uint64_t key) const {
+    key ^= key >> 30; key *= 0xBF58476D1CE4E5B9ULL;
+    key ^= key >> 27; key *= 0x94D049BB133111EBULL;
+    key ^= key >> 31;
+    return (uint32_t)key & _mask;
+  }
+
+  uint64_t* _keys = nullptr;
+  uint16_t* _slots = nullptr;
+  int       _buckets = 0;
+  uint32_t  _mask = 0;
+  int       _count = 0;
+};
@@ -0,0 +1,136 @@
+#pragma once
+
+#include <cstddef>
+#include <cstdint>
+#include <cstring>
+
+// pcapng encoder for raw captures of 802.11 management frames and BLE
+// adverts, written to SD by the capture task and readable by Wireshark,
+// tshark and the host tools. Plain C++ so the host tools can share it.
+//
+// File: a Section Header Block, two Interface Description Blocks
+//   interface 0   LINKTYPE_IEEE802_11_RADIOTAP        802.11 frame, no FCS
+//   interface 1   LINKTYPE_BLUETOOTH_LE_LL_WITH_PHDR  advertising PDU
+// then one Enhanced Packet Block per frame. Timestamps are microseconds
+// (the default if_tsresol) since boot; the device has no wall clock.
+//
+// The radiotap header carries channel and antenna signal. The BLE pseudo
+// header carries RSSI; the scanner reports neither the advertising channel
+// nor the CRC, so the channel is given as 37 with the "aliased" flag set and
+// the CRC bytes are zero and marked unchecked. With active scanning NimBLE
+// hands over advert and scan response data together; both go into one PDU.
+class Pcapng {
+public:
+  static constexpr uint16_t LINKTYPE_IEEE802_11_RADIOTAP = 127;
+  static constexpr uint16_t LINKTYPE_BLUETOOTH_LE_LL_WITH_PHDR = 256;
+  static constexpr uint32_t IF_WIFI = 0;
+  static constexpr uint32_t IF_BLE = 1;
+
+  static constexpr size_t HEADER_SIZE = 44 + 2 * 20; // SHB + two IDBs
+  static constexpr size_t RADIOTAP_LEN = 13;
+  static constexpr size_t BLE_PHDR_LEN = 10;
+  static constexpr size_t BLE_ADV_DATA_MAX = 249;   // PDU length byte minus AdvA
+
+  // Block sizes, for sizing buffers before encoding.
+  static constexpr size_t WifiBlockSize(size_t frame_len) { return EPB_FIXED + Pad4(RADIOTAP_LEN + frame_len); }
+  static constexpr size_t BleBlockSize(size_t data_len) {
+    return EPB_FIXED + Pad4(BLE_PHDR_LEN + 4 + 2 + 6 + data_len + 3);
+  }
+
+  // SHB and both IDBs; exactly HEADER_SIZE bytes. Snap lengths count frame
+  // or advert data only.
+  static size_t EncodeHeader(uint8_t* out, uint32_t wifi_snaplen, uint32_t ble_snaplen) {
+    uint8_t* p = out;
+    Put32(p, 0x0A0D0D0A); Put32(p + 4, 44); p += 8;
+    Put32(p, 0x1A2B3C4D); p += 4;                     // byte-order magic
+    Put16(p, 1); Put16(p + 2, 0); p += 4;             // version 1.0
+    Put32(p, 0xFFFFFFFFu); Put32(p + 4, 0xFFFFFFFFu); p += 8; // section length unknown
+    Put16(p, 4); Put16(p + 2, 7); p += 4;             // shb_userappl
+    memcpy(p, "Pigtail\0", 8); p += 8;
+    Put32(p, 0); p += 4;                              // opt_endofopt
+    Put32(p, 44); p += 4;
+
+    p += EncodeIdb(p, LINKTYPE_IEEE802_11_RADIOTAP, wifi_snaplen + RADIOTAP_LEN);
+    p += EncodeIdb(p, LINKTYPE_BLUETOOTH_LE_LL_WITH_PHDR, ble_snaplen + BLE_PHDR_LEN + 4 + 2 + 6 + 3);
+    return (size_t)(p - out);
+  }
+
+  // 802.11 frame (without FCS) heard on channel at rssi; len bytes of
+  // orig_len were kept. Writes WifiBlockSize(len) bytes.
+  static size_t EncodeWifi(uint8_t* out, uint64_t ts_us, uint8_t channel, int8_t rssi,
+                           const uint8_t* frame, size_t len, size_t orig_len) {
+    uint8_t* d = out + 28;
+    d[0] = 0; d[1] = 0;                               // version, pad
+    Put16(d + 2, (uint16_t)RADIOTAP_LEN);
+    Put32(d + 4, (1u << 3) | (1u << 5));              // Channel, dBm Antenna Signal
+    Put16(d + 8, ChannelMhz(channel));
+    Put16(d + 10, 0x0080);                            // 2 GHz
+    d[12] = (uint8_t)rssi;
+    memcpy(d + RADIOTAP_LEN, frame, len);
+    return EncodeEpb(out, IF_WIFI, ts_us, RADIOTAP_LEN + len, RADIOTAP_LEN + orig_len);
+  }
+
+  // Advertising PDU from addr (little-endian, as on air). adv_type is the
+  // HCI advertising report event type (0 ADV_IND .. 4 SCAN_RSP).
+  // Writes BleBlockSize(len) bytes, len clamped to BLE_ADV_DATA_MAX.
+  static size_t EncodeBle(uint8_t* out, uint64_t ts_us, int8_t rssi, uint8_t adv_type, bool random_addr,
+                          const uint8_t* addr_le, const uint8_t* data, size_t len) {
+    if (len > BLE_ADV_DATA_MAX) len = BLE_ADV_DATA_MAX;
+    uint8_t* d = out + 28;
+    d[0] = 0;                                          // RF channel 0 = advertising channel 37
+    d[1] = (uint8_t)rssi;
+    d[2] = 0;                                          // noise
+    d[3] = 0;                                          // access address offenses
+    Put32(d + 4, ADV_ACCESS_ADDRESS);
+    Put16(d + 8, 0x0001 | 0x0002 | 0x0010 | 0x0040); // dewhitened, signal valid, ref AA valid, channel aliased
+
+    uint8_t* ll = d + BLE_PHDR_LEN;
+    Put32(ll, ADV_ACCESS_ADDRESS);
+    ll[4] = (uint8_t)(PduType(adv_type) | (random_addr ? 0x40 : 0x00)); // TxAdd
+    ll[5] = (uint8_t)(6 + len);
+    memcpy(ll + 6, addr_le, 6);
+    memcpy(ll + 12, data, len);
+    memset(ll + 12 + len, 0, 3);                       // CRC not available
+    const size_t n = BLE_PHDR_LEN + 4 + 2 + 6 + len + 3;
+    return EncodeEpb(out, IF_BLE, ts_us, n, n);
+  }
+
+private:
+  static constexpr size_t EPB_FIXED = 32;              // 28-byte header + trailing length
+  static constexpr uint32_t ADV_ACCESS_ADDRESS = 0x8E89BED6;
+
+  static constexpr size_t Pad4(size_t n) { return (n + 3) & ~(size_t)3; }
+
+  static uint16_t ChannelMhz(uint8_t ch) { return ch == 14 ? 2484 : (uint16_t)(2407 + 5 * ch); }
+
+  // HCI report event type -> LL advertising PDU type.
+  static uint8_t PduType(uint8_t adv_type) {
+    static constexpr uint8_t MAP[5] = {0x0 /* ADV_IND */, 0x1 /* ADV_DIRECT_IND */, 0x6 /* ADV_SCAN_IND */,
+                                       0x2 /* ADV_NONCONN_IND */, 0x4 /* SCAN_RSP */};
+    return adv_type < 5 ? MAP[adv_type] : 0x0;
+  }
+
+  static size_t EncodeIdb(uint8_t* out, uint16_t linktype, uint32_t snaplen) {
+    Put32(out, 0x00000001); Put32(out + 4, 20);
+    Put16(out + 8, linktype); Put16(out + 10, 0);
+    Put32(out + 12, snaplen);
+    Put32(out + 16, 20);
+    return 20;
+  }
+
+  // Packet data is already at out + 28; pads it and fills in the block.
+  static size_t EncodeEpb(uint8_t* out, uint32_t iface, uint64_t ts_us, size_t cap_len, size_t orig_len) {
+    const size_t padded = Pad4(cap_len);
+    memset(out + 28 + cap_len, 0, padded - cap_len);
+    const uint32_t total = (uint32_t)(EPB_FIXED + padded);
+    Put32(out, 0x00000006); Put32(out + 4, total);
+    Put32(out + 8, iface);
+    Put32(out + 12, (uint32_t)(ts_us >> 32)); Put32(out + 16, (uint32_t)ts_us);
+    Put32(out + 20, (uint32_t)cap_len); Put32(out + 24, (uint32_t)orig_len);
+    Put32(out + 28 + padded, total);
+    return total;
+  }
+
+  static void Put16(uint8_t* p, uint16_t v) { p[0] = (uint8_t)v; p[1] = (uint8_t)(v >> 8); }
+  static void Put32(uint8_t* p, uint32_t v) { for (int i = 0; i < 4; ++i) p[i] = (uint8_t)(v >> (8 * i)); }
+};
@@ -0,0 +1,105 @@
+#pragma once
+
+#include <cstdint>
+
+#include "Arena.h"
+
+// Intrusive recency list over the slots of a table. Every slot is on
+// exactly one of two lists:
+//   - the free list (singly linked through _next), or
+//   - the in-use list, ordered most- to least-recently touched.
+// Claim, Touch, Release and Oldest are all O(1), so neither allocation nor
+// eviction has to scan the table.
+//
+// Link arrays come from an Arena at Init(); slot ids must fit below
+// MAX_SLOTS.
+class RecencyList {
+public:
+  static constexpr int NIL = -1;
+  static constexpr int MAX_SLOTS = 0xFFFF;
+
+  // Carves the link arrays from arena and frees every slot. Returns false
+  // while the arena is only sizing or has run out.
+  bool Init(Arena& arena, int slots) {
+    if (slots <= 0 || slots >= MAX_SLOTS) return false;
+    _prev = arena.Alloc<uint16_t>((size_t)slots);
+    _next = arena.Alloc<uint16_t>((size_t)slots);
+    if (!_prev || !_next) return false;
+    _slots = slots;
+    Reset();
+    return true;
+  }
+
+  // All slots free.
+  void Reset() {
+    for (int i = 0; i < _slots; ++i) {
+      _prev[i] = NONE;
+      _next[i] = (i + 1 < _slots) ? (uint16_t)(i + 1) : NONE;
+    }
+    _free = 0;
+    _head = _tail = NONE;
+    _count = 0;
+  }
+
+  // Pops a free slot and links it as most recent; NIL if the table is full.
+  int Claim() {
+    if (_free == NONE) return NIL;
+    const uint16_t i = _free;
+    _free = _next[i];
+    LinkHead(i);
+    _count++;
+    return i;
+  }
+
+  // Marks an in-use slot as most recently seen.
+  void Touch(int i) {
+    if (_head == (uint16_t)i) return;
+    Unlink((uint16_t)i);
+    LinkHead((uint16_t)i);
+  }
+
+  // Returns an in-use slot to the free list.
+  void Release(int i) {
+    Unlink((uint16_t)i);
+    _prev[i] = NONE;
+    _next[i] = _free;
+    _free = (uint16_t)i;
+    _count--;
+  }
+
+  // Walk from least- to most-recent: for (i = Oldest(); i != NIL; i = Newer(i))
+  int Oldest() const { return Id(_tail); }
+  int Newer(int i) const { return Id(_prev[i]); }
+
+  int Count() const { return _count; }
+  int Slots() const { return _slots; }
+
+private:
+  static constexpr uint16_t NONE = 0xFFFF;
+
+  static int Id(uint16_t v) { return v == NONE ? NIL : (int)v; }
+
+  void LinkHead(uint16_t i) {
+    _prev[i] = NONE;
+    _next[i] = _head;
+    if (_head != NONE) _prev[_head] = i;
+    _head = i;
+    if (_tail == NONE) _tail = i;
+  }
+
+  void Unlink(uint16_t i) {
+    if (_prev[i] != NONE) _next[_prev[i]] = _next[i];
+    else _head = _next[i];
+    if (_next[i] != NONE) _prev[_next[i]] = _prev[i];
+    else _tail = _prev[i];
+  }
+
+  // _prev points toward the head (newer), _next toward the tail (older).
+  uint16_t* _prev = nullptr;
+  uint16_t* _next = nullptr;
+  int      _slots = 0;
+  uint16_t _free = NONE;
+  uint16_t _head = NONE;
+  uint16_t _tail = NONE;
+  int      _count = 0;
+};
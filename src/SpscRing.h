@@ -0,0 +1,66 @@
+#pragma once
+
+#include <atomic>
+#include <cstdint>
+
+// Bounded lock-free single-producer/single-consumer ring of T. Exactly one
+// context may Push and exactly one other may Pop/Clear; neither side ever
+// blocks or takes a lock, so Push is safe from a radio callback.
+//
+// Indices run free and wrap at 2^32; CAPACITY must be a power of two.
+// Enqueued/Dropped are written only by the producer and may be read from
+// anywhere.
+template <typename T, int CAPACITY>
+class SpscRing {
+  static_assert(CAPACITY > 0 && (CAPACITY & (CAPACITY - 1)) == 0,
+                "CAPACITY must be a power of two");
+
+public:
+  // Producer. Returns false and counts a drop if the ring is full. If
+  // was_empty is given, it is set when the consumer may have seen the ring
+  // empty and gone to sleep, i.e. when a wakeup is worth sending.
+  bool Push(const T& item, bool* was_empty = nullptr) {
+    const uint32_t head = _head.load(std::memory_order_relaxed);
+    const uint32_t tail = _tail.load(std::memory_order_acquire);
+    if (head - tail >= (uint32_t)CAPACITY) {
+      _dropped.store(_dropped.load(std::memory_order_relaxed) + 1, std::memory_order_relaxed);
+      return false;
+    }
+
+    _items[head & (CAPACITY - 1)] = item;
+    _head.store(head + 1, std::memory_order_release);
+    _enqueued.store(_enqueued.load(std::memory_order_relaxed) + 1, std::memory_order_relaxed);
+    if (was_empty) *was_empty = (head == tail);
+    return true;
+  }
+
+  // Consumer. Returns false if the ring is empty.
+  bool Pop(T& out) {
+    const uint32_t tail = _tail.load(std::memory_order_relaxed);
+    const uint32_t head = _head.load(std::memory_order_acquire);
+    if (head == tail) return false;
+
+    out = _items[tail & (CAPACITY - 1)];
+    _tail.store(tail + 1, std::memory_order_release);
+    return true;
+  }
+
+  // Consumer. Discards everything published so far.
+  void Clear() {
+    _tail.store(_head.load(std::memory_order_acquire), std::memory_order_release);
+  }
+
+  bool Empty() const {
+    return _head.load(std::memory_order_acquire) == _tail.load(std::memory_order_relaxed);
+  }
+
+  uint32_t Enqueued() const { return _enqueued.load(std::memory_order_relaxed); }
+  uint32_t Dropped() const { return _dropped.load(std::memory_order_relaxed); }
+
+private:
+  T _items[CAPACITY];
+  std::atomic<uint32_t> _head{0};     // next write; producer-owned
+  std::atomic<uint32_t> _tail{0};     // next read; consumer-owned
+  std::atomic<uint32_t> _enqueued{0};
+  std::atomic<uint32_t> _dropped{0};
+};
@@ -0,0 +1,71 @@
+#pragma once
+
+#include <cstdint>
+#include <cstring>
+
+// Small direct-mapped intern table for SSIDs / BLE names, keyed by FNV-1a
+// hash. Producers intern a name and put the 32-bit ref in their queue record
+// instead of the 32 name bytes; the consumer resolves it back when it applies
+// the record. An AP beaconing at 10 Hz hits the same entry every time.
+//
+// A ref is (generation << 8) | entry, with a 24-bit generation. Interning a
+// different name into an occupied entry bumps its generation, so a ref that
+// was overwritten while its record sat in the queue resolves to "no name"
+// rather than the wrong one. Only 2^24 - 1 reuses of one entry while a
+// record waits would bring the generation round again. Ref 0 means no name.
+//
+// Not thread-safe; callers serialize Intern/Resolve themselves.
+template <int ENTRIES>
+class SsidPool {
+  static_assert(ENTRIES > 0 && ENTRIES <= 256 && (ENTRIES & (ENTRIES - 1)) == 0,
+                "ENTRIES must be a power of two <= 256");
+
+public:
+  static constexpr uint32_t NONE = 0;
+
+  uint32_t Intern(const uint8_t* s, uint8_t len) {
+    if (!s || len == 0) return NONE;
+    if (len > 32) len = 32;
+
+    const uint32_t h = Hash(s, len);
+    const int i = (int)(h & (ENTRIES - 1));
+    Entry& e = _entries[i];
+
+    if (e.gen == 0 || e.hash != h || e.len != len || memcmp(e.bytes, s, len) != 0) {
+      e.gen = (e.gen + 1) & GEN_MASK;
+      if (e.gen == 0) e.gen = 1;
+      e.hash = h;
+      e.len = len;
+      memcpy(e.bytes, s, len);
+    }
+    return (e.gen << 8) | (uint32_t)i;
+  }
+
+  // Copies the name for ref into out; returns its length, or 0 if the ref is
+  // empty or its entry has since been reused.
+  uint8_t Resolve(uint32_t ref, uint8_t out[32]) const {
+    if (ref == NONE) return 0;
+    const Entry& e = _entries[ref & 0xFF & (ENTRIES - 1)];
+    if (e.gen != (ref >> 8)) return 0;
+    memcpy(out, e.bytes, e.len);
+    return e.len;
+  }
+
+private:
+  static constexpr uint32_t GEN_MASK = 0xFFFFFF;
+
+  struct Entry {
+    uint32_t hash = 0;
+    uint32_t gen = 0; // 24 bits; 0 = never used
+    uint8_t  len = 0;
+    uint8_t  bytes[32]{};
+  };
+
+  static uint32_t Hash(const uint8_t* s, uint8_t len) {
+    uint32_t h = 2166136261u;
+    for (uint8_t i = 0; i < len; ++i) { h ^= s[i]; h *= 16777619u; }
+    return h;
+  }
+
+  Entry _entries[ENTRIES];
+};
@@ -0,0 +1,174 @@
+#pragma once
+
+#include <cstdint>
+
+#include "Arena.h"
+
+// Two-level hierarchical timer wheel with 1-second ticks, keyed by table
+// slot. Level 0 has 64 one-second buckets; level 1 has 64 buckets of 64 s
+// each, covering deadlines up to ~68 minutes out. Entries further away park
+// in the farthest level-1 bucket and are re-placed when it cascades.
+//
+// Schedule/Cancel are O(1) (intrusive doubly-linked buckets), and Advance
+// only touches buckets for elapsed ticks plus the entries that actually fire.
+// Per-slot arrays come from an Arena at Init(); slot ids must fit below
+// MAX_SLOTS.
+class TimerWheel {
+public:
+  static constexpr int MAX_SLOTS = 0xFFFF;
+
+  TimerWheel() { Reset(); }
+
+  // Carves the per-slot arrays from arena and disarms everything. Returns
+  // false while the arena is only sizing or has run out.
+  bool Init(Arena& arena, int slots) {
+    if (slots <= 0 || slots >= MAX_SLOTS) return false;
+    _prev = arena.Alloc<uint16_t>((size_t)slots);
+    _next = arena.Alloc<uint16_t>((size_t)slots);
+    _deadline = arena.Alloc<uint32_t>((size_t)slots);
+    _bucket = arena.Alloc<uint8_t>((size_t)slots);
+    if (!_prev || !_next || !_deadline || !_bucket) return false;
+    _slots = slots;
+    Reset();
+    return true;
+  }
+
+  void Reset() {
+    for (int b = 0; b < BUCKETS; ++b) _head[b] = NONE;
+    for (int i = 0; i < _slots; ++i) {
+      _prev[i] = _next[i] = NONE;
+      _bucket[i] = UNARMED;
+      _deadline[i] = 0;
+    }
+    _now = 0;
+  }
+
+  // (Re)arms slot to fire once deadline_s has been reached.
+  void Schedule(int slot, uint32_t deadline_s) {
+    if (_bucket[slot] != UNARMED) Unlink((uint16_t)slot);
+    _deadline[slot] = deadline_s;
+    Place((uint16_t)slot, _now + 1); // the current tick's bucket has already run
+  }
+
+  void Cancel(int slot) {
+    if (_bucket[slot] == UNARMED) return;
+    Unlink((uint16_t)slot);
+    _bucket[slot] = UNARMED;
+  }
+
+  bool Armed(int slot) const { return _bucket[slot] != UNARMED; }
+
+  // Moves the wheel forward to now_s, calling on_fire(slot) for every entry
+  // whose deadline has passed. The entry is disarmed before the callback, so
+  // the callback may Schedule() it again.
+  template <typename F>
+  void Advance(uint32_t now_s, F&& on_fire) {
+    if ((int32_t)(now_s - _now) > L0 * L1) {
+      Rebase(now_s, on_fire);
+      return;
+    }
+
+    while ((int32_t)(now_s - _now) > 0) {
+      _now++;
+      if ((_now & L0_MASK) == 0) Cascade();
+
+      const int b = (int)(_now & L0_MASK);
+      while (_head[b] != NONE) {
+        const uint16_t i = _head[b];
+        Unlink(i);
+        _bucket[i] = UNARMED;
+        on_fire((int)i);
+      }
+    }
+  }
+
+private:
+  static constexpr int      L0 = 64;
+  static constexpr int      L1 = 64;
+  static constexpr int      BUCKETS = L0 + L1;
+  static constexpr uint32_t L0_MASK = L0 - 1;
+  static constexpr uint32_t L1_SHIFT = 6; // log2(L0)
+  static constexpr uint16_t NONE = 0xFFFF;
+  static constexpr uint8_t  UNARMED = 0xFF;
+
+  // Overdue entries go into the bucket for tick `earliest`.
+  void Place(uint16_t i, uint32_t earliest) {
+    uint32_t d = _deadline[i];
+    if ((int32_t)(d - earliest) < 0) d = earliest;
+
+    const uint32_t delta = d - _now;
+    int b;
+    if (delta < (uint32_t)L0) {
+      b = (int)(d & L0_MASK);
+    } else if (delta < (uint32_t)(L0 * L1)) {
+      b = L0 + (int)((d >> L1_SHIFT) & (L1 - 1));
+    } else {
+      b = L0 + (int)(((_now >> L1_SHIFT) + L1 - 1) & (L1 - 1));
+    }
+    Link(i, b);
+  }
+
+  // Large clock jump (first call, or a replayed capture with epoch time):
+  // re-place every armed entry against the new time instead of stepping
+  // through thousands of empty ticks.
+  template <typename F>
+  void Rebase(uint32_t now_s, F&& on_fire) {
+    uint16_t pending = NONE;
+    for (int b = 0; b < BUCKETS; ++b) {
+      while (_head[b] != NONE) {
+        const uint16_t i = _head[b];
+        Unlink(i);
+        _next[i] = pending;
+        pending = i;
+      }
+    }
+
+    _now = now_s;
+    while (pending != NONE) {
+      const uint16_t i = pending;
+      pending = _next[i];
+      if ((int32_t)(_deadline[i] - _now) <= 0) {
+        _bucket[i] = UNARMED;
+        on_fire((int)i);
+      } else {
+        Place(i, _now + 1);
+      }
+    }
+  }
+
+  // Re-places everything in the level-1 bucket whose 64 s block just began.
+  // Runs before the current tick's level-0 bucket, so entries due exactly
+  // now still fire this tick.
+  void Cascade() {
+    const int b = L0 + (int)((_now >> L1_SHIFT) & (L1 - 1));
+    uint16_t i = _head[b];
+    _head[b] = NONE;
+    while (i != NONE) {
+      const uint16_t next = _next[i];
+      Place(i, _now);
+      i = next;
+    }
+  }
+
+  void Link(uint16_t i, int b) {
+    _bucket[i] = (uint8_t)b;
+    _prev[i] = NONE;
+    _next[i] = _head[b];
+    if (_head[b] != NONE) _prev[_head[b]] = i;
+    _head[b] = i;
+  }
+
+  void Unlink(uint16_t i) {
+    if (_prev[i] != NONE) _next[_prev[i]] = _next[i];
+    else _head[_bucket[i]] = _next[i];
+    if (_next[i] != NONE) _prev[_next[i]] = _prev[i];
+  }
+
+  uint16_t  _head[BUCKETS];
+  uint16_t* _prev = nullptr;
+  uint16_t* _next = nullptr;
+  uint32_t* _deadline = nullptr;
+  uint8_t*  _bucket = nullptr;
+  int       _slots = 0;
+  uint32_t  _now = 0;
+};
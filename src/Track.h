@@ -1,10 +1,13 @@
 #pragma once
 
 #include "MacPrefixes.h"
+#include "BottomK.h"
+#include <cmath>
 #include <cstdint>
 #include <type_traits>
 
-static constexpr int FP_TOP_N = 8;
+// Upper bound for DeviceTracker::setFingerprintWidth().
+static constexpr int FP_WIDTH_MAX = 64;
 
 enum class TrackerType : uint8_t {
   Unknown = 0,
@@ -121,7 +124,7 @@ constexpr void SetFlag(EntityFlags& v, EntityFlags f, bool on)
 
 struct EntityView {
   EntityKind kind;
-  uint16_t   index;        // entity index
+  uint32_t   handle;       // slot + generation; stable while the entity lives
   uint8_t    addr[6];      // MAC address
   Vendor     vendor;       // OUI vendor
   uint8_t    ssid[33];     // SSID
@@ -153,6 +156,14 @@ struct EntityView {
 
 enum class TrackKind : uint8_t { WifiClient = 1, BleAdv = 2 };
 
+// Geo is stored as fixed-point microdegrees (1e-6 deg, ~0.11 m at the
+// equator): half the size of a double and exact to compare.
+inline int32_t GeoToE6(double deg) { return (int32_t)lround(deg * 1e6); }
+inline double  GeoFromE6(int32_t e6) { return (double)e6 * 1e-6; }
+
+// Tables are split hot/cold. Track and Anchor hold only what lookup,
+// the per-observation update, ranking and eviction touch; the rest lives in
+// TrackInfo/AnchorInfo, in parallel arrays indexed by the same slot.
 struct Track {
   bool      in_use = false;
   TrackKind kind{};
@@ -162,7 +173,7 @@ struct Track {
 
   EntityFlags flags = EntityFlags::None;
 
-  uint16_t  index = 0;
+  uint32_t  handle = 0;
   uint32_t  first_seen_s = 0;
   uint32_t  last_seen_s  = 0;
 
@@ -178,10 +189,16 @@ struct Track {
 
   float     crowd_ema = 0.0f;
 
+  // Cached TrackScore::Base (Q8), recomputed lazily once stale
+  int16_t   score_base = 0;
+  bool      score_stale = true;
+};
+
+struct TrackInfo {
   // Last-seen GPS fix (where YOU were when you last observed this device)
   uint32_t  last_geo_s = 0;
-  double    last_lat = 0.0;
-  double    last_lon = 0.0;
+  int32_t   last_lat_e6 = 0;
+  int32_t   last_lon_e6 = 0;
 
   TrackerType tracker_type = TrackerType::Unknown;
   GoogleFmnManufacturer tracker_google_mfr = GoogleFmnManufacturer::Unknown;
@@ -203,31 +220,37 @@ struct Anchor {
 
   EntityFlags flags = EntityFlags::None;
 
-  uint8_t  ssid[32]{};
-  uint8_t  ssid_len = 0;
-
-  uint16_t index = 0;
+  uint32_t handle = 0;
   int      last_rssi = -100;
   uint32_t last_seen_s = 0;
+};
+
+struct AnchorInfo {
+  uint8_t  ssid[32]{};
+  uint8_t  ssid_len = 0;
 
   // Last-seen GPS fix (where YOU were when you last observed this AP)
   uint32_t last_geo_s = 0;
-  double   last_lat = 0.0;
-  double   last_lon = 0.0;
+  int32_t  last_lat_e6 = 0;
+  int32_t  last_lon_e6 = 0;
 
   // "best pass" (strongest RSSI) location
   int      best_rssi = -127;
-  double   best_lat = 0.0;
-  double   best_lon = 0.0;
-
-  // Optional running weighted average
-  double   w_sum = 0.0;
-  double   w_lat = 0.0;
-  double   w_lon = 0.0;
+  int32_t  best_lat_e6 = 0;
+  int32_t  best_lon_e6 = 0;
+
+  // Optional running RSSI-weighted mean position: w_lat_e6 + w_lat_frac
+  // microdegrees (likewise lon), the fraction in [-0.5, 0.5]
+  float    w_sum = 0.0f;
+  int32_t  w_lat_e6 = 0;
+  int32_t  w_lon_e6 = 0;
+  float    w_lat_frac = 0.0f;
+  float    w_lon_frac = 0.0f;
 };
 
-struct FpItem { uint8_t addr[6]; uint8_t bucket; };
+// MinHash sketches of the fresh anchors: one over BSSIDs, one over
+// (BSSID, RSSI band) pairs.
 struct EnvFingerprint {
-  FpItem items[FP_TOP_N];
-  int count = 0;
+  BottomK<FP_WIDTH_MAX> aps;
+  BottomK<FP_WIDTH_MAX> bands;
 };
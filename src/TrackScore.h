@@ -0,0 +1,131 @@
+#pragma once
+
+#include <cmath>
+#include <cstdint>
+
+// Track suspicion score, 0..100 points, in fixed point (Q8: 256 = 1 point).
+//
+//   score = P + R + C    persistence, RSSI nearness/stability, crowd penalty:
+//                        per-track inputs only, so callers cache Base() and
+//                        refresh it only after the track is observed again
+//         + M            environment coverage (needs the global segment count)
+//         + I            stationary penalty (global)
+//
+// P comes from a lookup table at 15 s steps with linear interpolation; R, C
+// and M are integer math. Over the full input range the result stays within
+// 0.1 point of Reference(), the original float formula (checked by
+// host/bench_track_score.cpp).
+class TrackScore {
+public:
+  static constexpr float T_CAP_MIN    = 30.0f;
+  static constexpr float RSSI_DEV_CAP = 10.0f;
+  static constexpr float CROWD_LO     = 5.0f;
+  static constexpr float CROWD_HI     = 40.0f;
+
+  static constexpr int32_t ONE = 256;
+  static constexpr int32_t MAX = 100 * ONE;
+
+  // P + R + C for one track.
+  static int32_t Base(uint32_t age_s, uint32_t seen_windows, uint32_t near_windows,
+                      float ema_abs_dev, float crowd_ema) {
+    return Persistence(age_s) + Nearness(seen_windows, near_windows, ema_abs_dev) - Crowd(crowd_ema);
+  }
+
+  // M: 35 points once the track has been seen in every movement segment.
+  static int32_t Coverage(uint32_t env_hits, uint32_t move_segments) {
+    if (move_segments == 0) move_segments = 1;
+    if (env_hits >= move_segments) return 35 * ONE;
+    return (int32_t)(((uint64_t)35 * ONE * env_hits + move_segments / 2) / move_segments);
+  }
+
+  // I: up to -20 points while the user appears to be standing still.
+  static int32_t Stationary(float stationary_ratio) {
+    return -(int32_t)lroundf(20.0f * ONE * clamp01(stationary_ratio));
+  }
+
+  static int32_t Combine(int32_t base, int32_t coverage, int32_t stationary) {
+    const int32_t s = base + coverage + stationary;
+    return s < 0 ? 0 : (s > MAX ? MAX : s);
+  }
+
+  static float ToFloat(int32_t q) { return (float)q * (1.0f / ONE); }
+
+  // The original float formula; kept as the reference for the tolerance check.
+  static float Reference(uint32_t age_s, uint32_t seen_windows, uint32_t near_windows, float ema_abs_dev,
+                         float crowd_ema, uint32_t env_hits, uint32_t move_segments, float stationary_ratio) {
+    float T_min = (float)age_s / 60.0f;
+    float P = 30.0f * clamp01(log1pf(T_min) / log1pf(T_CAP_MIN));
+
+    float f_near = (seen_windows > 0) ? ((float)near_windows / (float)seen_windows) : 0.0f;
+    float stability = clamp01(1.0f - (ema_abs_dev / RSSI_DEV_CAP));
+    float R = 25.0f * clamp01(0.7f * f_near + 0.3f * stability);
+
+    float coverage = (float)env_hits / (float)(move_segments > 0 ? move_segments : 1);
+    float M = 35.0f * clamp01(coverage);
+
+    float crowd_norm = clamp01((crowd_ema - CROWD_LO) / (CROWD_HI - CROWD_LO));
+    float C = -25.0f * crowd_norm;
+
+    float I = -20.0f * clamp01(stationary_ratio);
+
+    float S = P + R + M + C + I;
+    if (S < 0) S = 0;
+    if (S > 100) S = 100;
+    return S;
+  }
+
+private:
+  static constexpr uint32_t P_STEP_S = 15;
+  static constexpr uint32_t P_CAP_S  = (uint32_t)(T_CAP_MIN * 60.0f);
+  static constexpr int      P_STEPS  = (int)(P_CAP_S / P_STEP_S);
+
+  struct PersistenceLut {
+    uint16_t q[P_STEPS + 1];
+    PersistenceLut() {
+      for (int i = 0; i <= P_STEPS; ++i) {
+        const float t_min = (float)(i * P_STEP_S) / 60.0f;
+        q[i] = (uint16_t)lroundf(30.0f * ONE * log1pf(t_min) / log1pf(T_CAP_MIN));
+      }
+    }
+  };
+  static inline const PersistenceLut _p_lut{};
+
+  static float clamp01(float x) { return x < 0 ? 0 : (x > 1 ? 1 : x); }
+
+  // P: 30 * log1p(minutes) / log1p(T_CAP_MIN), capped.
+  static int32_t Persistence(uint32_t age_s) {
+    if (age_s >= P_CAP_S) return 30 * ONE;
+    const uint32_t i = age_s / P_STEP_S;
+    const uint32_t frac = age_s % P_STEP_S;
+    const int32_t a = _p_lut.q[i];
+    const int32_t b = _p_lut.q[i + 1];
+    return a + (int32_t)(((b - a) * (int32_t)frac + (int32_t)P_STEP_S / 2) / (int32_t)P_STEP_S);
+  }
+
+  // R: 25 * (0.7 * near fraction + 0.3 * RSSI stability), mixed in Q16.
+  static int32_t Nearness(uint32_t seen_windows, uint32_t near_windows, float ema_abs_dev) {
+    uint32_t f = 0;
+    if (seen_windows > 0) {
+      f = (uint32_t)(((uint64_t)near_windows << 16) / seen_windows);
+      if (f > 65536) f = 65536;
+    }
+
+    int32_t dev = (int32_t)(ema_abs_dev * (65536.0f / RSSI_DEV_CAP));
+    if (dev < 0) dev = 0;
+    if (dev > 65536) dev = 65536;
+    const uint32_t s = (uint32_t)(65536 - dev);
+
+    const uint32_t mix = (uint32_t)(((uint64_t)45875 * f + (uint64_t)19661 * s) >> 16); // 0.7, 0.3
+    return (int32_t)((25u * mix + 128u) >> 8);
+  }
+
+  // C (as a positive penalty): 25 * crowd position between CROWD_LO and CROWD_HI.
+  static int32_t Crowd(float crowd_ema) {
+    const int32_t c = (int32_t)(crowd_ema * ONE);
+    const int32_t lo = (int32_t)(CROWD_LO * ONE);
+    const int32_t span = (int32_t)((CROWD_HI - CROWD_LO) * ONE);
+    if (c <= lo) return 0;
+    if (c - lo >= span) return 25 * ONE;
+    return (25 * ONE * (c - lo) + span / 2) / span;
+  }
+};
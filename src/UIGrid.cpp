@@ -123,8 +123,8 @@ void UIGrid::begin(DeviceTracker* tracker)
   _offset = 0;
   _sel_slot = 0;
   _sel_idx = -1;
-  _sel_index_valid = false;
-  _detail_index_valid = false;
+  _sel_handle_valid = false;
+  _detail_handle_valid = false;
 
   setSelectionSlot(0);
 }
@@ -188,11 +188,14 @@ void UIGrid::pushFrame()
 
 void UIGrid::update(float stationary_ratio)
 {
-  (void)stationary_ratio; // currently not used; keep for future
-
   if (!_tracker) return;
 
-  _count = _tracker->buildSnapshot(_items, 256, stationary_ratio);
+  _tracker->setStationaryRatio(stationary_ratio);
+
+  // Only copy when the tracker has published something new.
+  if (!_snap_valid || _tracker->snapshotGeneration() != _snap_gen) {
+    loadPage();
+  }
 
   // Keep cursor on the same device as list updates
   syncSelectionToId();
@@ -263,29 +266,24 @@ void UIGrid::setSelectionSlot(int slot)
   if (slot >= SLOTS) slot = SLOTS - 1;
   _sel_slot = slot;
 
-  int idx = _offset + _sel_slot;
-  _sel_idx = (idx >= 0 && idx < _count) ? idx : -1;
+  const int idx = _offset + _sel_slot;
+  const EntityView* e = itemAt(idx);
+  _sel_idx = e ? idx : -1;
 
-  if (_sel_idx >= 0) {
-    _sel_index = _items[_sel_idx].index;
-    _sel_kind = _items[_sel_idx].kind;
-    _sel_index_valid = true;
+  if (e) {
+    _sel_handle = e->handle;
+    _sel_kind = e->kind;
+    _sel_handle_valid = true;
   } else {
-    _sel_index_valid = false;
+    _sel_handle_valid = false;
   }
 }
 
 void UIGrid::syncSelectionToId()
 {
-  if (!_sel_index_valid || _count <= 0) return;
+  if (!_sel_handle_valid || _count <= 0) return;
 
-  int found = -1;
-  for (int i = 0; i < _count; ++i) {
-    if (_items[i].index == _sel_index && _items[i].kind == _sel_kind) {
-      found = i;
-      break;
-    }
-  }
+  const int found = _tracker->rankOf(_sel_kind, _sel_handle);
   if (found < 0) return;
 
   // Keep same row/col visual position when possible
@@ -324,16 +322,14 @@ void UIGrid::openDetail()
   if (_sel_idx < 0) return;
 
   lockDetailToSelection();
+  if (!_detail_handle_valid) return;
 
-  _detail_index = _items[_sel_idx].index;
-  _detail_kind = _items[_sel_idx].kind;
-  _detail_index_valid = true;
   _screen = Screen::Detail;
 }
 
 void UIGrid::closeDetail()
 {
-  _detail_index_valid = false;
+  _detail_handle_valid = false;
   _screen = Screen::Grid;
 }
 
@@ -357,8 +353,8 @@ void UIGrid::handleKeyboard(Keyboard_Class& kb)
     if (_tracker) _tracker->reset();
 
     _screen = Screen::Grid;
-    _detail_index_valid = false;
-    _sel_index_valid = false;
+    _detail_handle_valid = false;
+    _sel_handle_valid = false;
 
     _offset = 0;
     setSelectionSlot(0);
@@ -382,6 +378,8 @@ void UIGrid::handleKeyboard(Keyboard_Class& kb)
   const bool wKey  = kb.isKeyPressed('w') || kb.isKeyPressed('W');
   const bool iKey  = kb.isKeyPressed('i') || kb.isKeyPressed('I');
   const bool kKey  = kb.isKeyPressed('k') || kb.isKeyPressed('K');
+  const bool jKey  = kb.isKeyPressed('j') || kb.isKeyPressed('J');
+  const bool pKey  = kb.isKeyPressed('p') || kb.isKeyPressed('P');
   const bool sKey  = kb.isKeyPressed('s') || kb.isKeyPressed('S');
 
   if (sKey) {
@@ -442,6 +440,22 @@ void UIGrid::handleKeyboard(Keyboard_Class& kb)
             _tracker->writeWatchlistKml();
             playSound(1000, 100);
         }
+        else if (jKey) {
+            if (_tracker->journalActive()) {
+              _tracker->stopJournal();
+              playSound(600, 100);
+            } else if (_tracker->startJournal()) {
+              playSound(1000, 100);
+            }
+        }
+        else if (pKey) {
+            if (_tracker->captureActive()) {
+              _tracker->stopCapture();
+              playSound(600, 100);
+            } else if (_tracker->startCapture()) {
+              playSound(1000, 100);
+            }
+        }
         
       } break;
 
@@ -543,37 +557,56 @@ void UIGrid::pollLongPress(Keyboard_Class& kb)
 
 void UIGrid::lockDetailToSelection()
 {
-  if (_sel_idx >= 0 && _sel_idx < _count) {
-    _detail_index = _items[_sel_idx].index;
-    _detail_kind = _items[_sel_idx].kind;
-    _detail_index_valid = true;
+  const EntityView* e = getGridEntity();
+  if (e) {
+    _detail_handle = e->handle;
+    _detail_kind = e->kind;
+    _detail_handle_valid = true;
   } else {
-    _detail_index_valid = false;
+    _detail_handle_valid = false;
   }
 }
 
 EntityView* UIGrid::getDetailEntity()
 {
   // Find locked detail device in live snapshot
-  EntityView* pe = nullptr;
-  if (_detail_index_valid) {
-    for (int i = 0; i < _count; ++i) {
-      if (_items[i].index == _detail_index && _items[i].kind == _detail_kind) {
-        pe = &_items[i];
-        break;
-      }
-    }
-  }
+  if (!_detail_handle_valid) return nullptr;
+
+  const int rank = _tracker->rankOf(_detail_kind, _detail_handle);
+  if (rank < 0) return nullptr;
+
+  EntityView* pe = itemAt(rank);
+  if (pe && pe->handle == _detail_handle && pe->kind == _detail_kind) return pe;
+
+  // Off the visible page (or the page is from an older generation)
+  if (_tracker->topK(&_detail_item, rank, 1) == 1 &&
+      _detail_item.handle == _detail_handle && _detail_item.kind == _detail_kind)
+    return &_detail_item;
 
-  return pe;
+  return nullptr;
 }
 
-EntityView* UIGrid::getGridEntity()
+// Copies the visible page [_offset, _offset + SLOTS) from the tracker.
+void UIGrid::loadPage()
 {
-  if (_sel_idx < 0 || _sel_idx >= _count)
-    return nullptr;
+  _page_count = _tracker ? _tracker->topK(_page, _offset, SLOTS, &_count, &_snap_gen) : 0;
+  _page_offset = _offset;
+  _snap_valid = (_tracker != nullptr);
+}
 
-  return &_items[_sel_idx];
+// Entity at rank idx, or nullptr. Pages in on demand when scrolling.
+EntityView* UIGrid::itemAt(int idx)
+{
+  if (idx < 0 || idx >= _count) return nullptr;
+  if (!_snap_valid || _page_offset != _offset) loadPage();
+
+  const int i = idx - _page_offset;
+  return (i >= 0 && i < _page_count) ? &_page[i] : nullptr;
+}
+
+EntityView* UIGrid::getGridEntity()
+{
+  return itemAt(_sel_idx);
 }
 
 EntityView* UIGrid::getSelectedEntity()
@@ -748,12 +781,10 @@ void UIGrid::drawLoadingIndicatorIfNeeded(int start_x, int start_y, int gridW)
 
 void UIGrid::drawTile(int slot, int x, int y)
 {
-  const int idx = _offset + slot;
-  if (idx < 0 || idx >= _count) return;
-
-  const auto& e = _items[idx];
+  const EntityView* e = itemAt(_offset + slot);
+  if (!e) return;
 
-  renderGridIconToSprite(x, y, e);
+  renderGridIconToSprite(x, y, *e);
 }
 
 void UIGrid::playSound(int frequency, int duration)
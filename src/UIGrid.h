@@ -67,6 +67,8 @@ private:
   void setSelectionSlot(int slot);
   void syncSelectionToId();
   void lockDetailToSelection();
+  void loadPage();
+  EntityView* itemAt(int idx);
   EntityView* getGridEntity();
   EntityView* getDetailEntity();
   EntityView* getSelectedEntity();
@@ -89,8 +91,14 @@ private:
 
   DeviceTracker* _tracker = nullptr;
 
-  EntityView _items[256]{};
-  int        _count = 0;
+  // Only the visible page is copied out of the tracker's ranked snapshot.
+  EntityView _page[SLOTS]{};
+  int        _page_offset = 0;    // rank of _page[0]
+  int        _page_count = 0;
+  int        _count = 0;          // total ranked entities
+  uint32_t   _snap_gen = 0;       // tracker snapshot generation held in _page
+  bool       _snap_valid = false;
+  EntityView _detail_item{};      // detail entity when it is off the page
 
   Screen       _screen = Screen::Grid;
   GridIconMode _gridMode = GridIconMode::LargeIconWithMac;
@@ -100,13 +108,13 @@ private:
   int _sel_idx = -1;
 
   // Lock cursor to the same device across list updates
-  bool       _sel_index_valid = false;
-  uint32_t   _sel_index = 0;
+  bool       _sel_handle_valid = false;
+  uint32_t   _sel_handle = 0;
   EntityKind _sel_kind = EntityKind::WifiClient;
 
   // Detail locks to a device id too
-  bool       _detail_index_valid = false;
-  uint32_t   _detail_index = 0;
+  bool       _detail_handle_valid = false;
+  uint32_t   _detail_handle = 0;
   EntityKind _detail_kind = EntityKind::WifiClient;
 
   // Sprite